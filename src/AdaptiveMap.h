@@ -0,0 +1,349 @@
+#ifndef AISDI_MAPS_ADAPTIVEMAP_H
+#define AISDI_MAPS_ADAPTIVEMAP_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "HashMap.h"
+
+namespace aisdi {
+
+    /**
+     * Map changing its representation with its size and workload.
+     *
+     * Up to INLINE_CAPACITY entries live in two inline arrays searched linearly; a larger map moves
+     * into a HashMap, and shrinks back once it falls to half that capacity.
+     *
+     * Range queries are counted per window of operations. Once enough of them arrive, entries are
+     * gathered into a sorted index, INDEX_STEP per subsequent operation; the operation gathering the
+     * last ones sorts them, as does a removal arriving mid-way. Until the index is ready, range
+     * queries scan and sort. A window with no range query drops the index, so write-heavy phases
+     * stop paying for keeping it sorted.
+     *
+     * References returned by operator[] and valueOf are valid until the next modification.
+     */
+    template<typename KeyType, typename ValueType>
+    class AdaptiveMap {
+    public:
+        static const std::size_t INLINE_CAPACITY = 8;
+        static const std::size_t INDEX_STEP = 64;
+        static const std::size_t STATISTICS_WINDOW = 1024;
+        static const std::size_t RANGE_QUERIES_TO_INDEX = 4;
+
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+        enum class Representation {
+            Inline, Hashed
+        };
+
+        enum class IndexState {
+            Absent, Building, Ready
+        };
+
+        AdaptiveMap() : representation(Representation::Inline), inlineCount(0), indexState(IndexState::Absent),
+                        buildCursor(hash.cend()), operationsInWindow(0), rangeQueriesInWindow(0) {}
+
+        AdaptiveMap(std::initializer_list<value_type> list) : AdaptiveMap() {
+            std::for_each(list.begin(), list.end(), [this](const value_type &v) { (*this)[v.first] = v.second; });
+        }
+
+        AdaptiveMap(const AdaptiveMap &other) : AdaptiveMap() {
+            other.forEach([this](const key_type &key, const mapped_type &value) { (*this)[key] = value; });
+        }
+
+        AdaptiveMap &operator=(const AdaptiveMap &other) {
+            if (this != &other) {
+                AdaptiveMap copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        size_type getSize() const {
+            return representation == Representation::Inline ? inlineCount : hash.getSize();
+        }
+
+        Representation getRepresentation() const {
+            return representation;
+        }
+
+        IndexState getIndexState() const {
+            return indexState;
+        }
+
+        mapped_type &operator[](const key_type &key) {
+            step();
+            if (representation == Representation::Inline) {
+                const auto position = inlineFind(key);
+                if (position < inlineCount) {
+                    return inlineValues[position];
+                }
+                if (inlineCount < INLINE_CAPACITY) {
+                    inlineKeys[inlineCount] = key;
+                    inlineValues[inlineCount] = mapped_type{};
+                    return inlineValues[inlineCount++];
+                }
+                promote();
+            }
+
+            const auto sizeBefore = hash.getSize();
+            auto &value = hash[key];
+            if (hash.getSize() != sizeBefore && indexState != IndexState::Absent) {
+                indexInserted(&*hash.find(key));
+            }
+            return value;
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            if (representation == Representation::Inline) {
+                const auto position = inlineFind(key);
+                if (position == inlineCount) {
+                    throw std::out_of_range("Map does not contain key");
+                }
+                return inlineValues[position];
+            }
+            return hash.valueOf(key);
+        }
+
+        mapped_type &valueOf(const key_type &key) {
+            step();
+            return const_cast<mapped_type &>(static_cast<const AdaptiveMap &>(*this).valueOf(key));
+        }
+
+        bool contains(const key_type &key) const {
+            if (representation == Representation::Inline) {
+                return inlineFind(key) < inlineCount;
+            }
+            return hash.find(key) != hash.end();
+        }
+
+        void remove(const key_type &key) {
+            step();
+            if (representation == Representation::Inline) {
+                const auto position = inlineFind(key);
+                if (position == inlineCount) {
+                    throw std::out_of_range("Map does not contain key");
+                }
+                --inlineCount;
+                inlineKeys[position] = std::move(inlineKeys[inlineCount]);
+                inlineValues[position] = std::move(inlineValues[inlineCount]);
+                return;
+            }
+
+            auto found = hash.find(key);
+            if (found == hash.end()) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            indexRemoved(key);
+            hash.remove(found);
+            if (hash.getSize() <= INLINE_CAPACITY / 2) {
+                demote();
+            }
+        }
+
+        /**
+         * Visits all entries in no particular order.
+         */
+        template<typename Visitor>
+        void forEach(Visitor visitor) const {
+            if (representation == Representation::Inline) {
+                for (size_type i = 0; i < inlineCount; ++i) {
+                    visitor(inlineKeys[i], inlineValues[i]);
+                }
+            } else {
+                for (const auto &entry : hash) {
+                    visitor(entry.first, entry.second);
+                }
+            }
+        }
+
+        /**
+         * Visits entries with keys in [from, to) in ascending key order.
+         */
+        template<typename Visitor>
+        void forEachInRange(const key_type &from, const key_type &to, Visitor visitor) {
+            step();
+            ++rangeQueriesInWindow;
+            if (indexState == IndexState::Absent && representation == Representation::Hashed &&
+                rangeQueriesInWindow >= RANGE_QUERIES_TO_INDEX) {
+                startIndexing();
+            }
+
+            if (indexState == IndexState::Ready) {
+                auto entry = std::lower_bound(orderedEntries.begin(), orderedEntries.end(), from, KeyLess());
+                for (; entry != orderedEntries.end() && (*entry)->first < to; ++entry) {
+                    visitor((*entry)->first, (*entry)->second);
+                }
+                return;
+            }
+
+            std::vector<std::pair<const key_type *, const mapped_type *>> matching;
+            forEach([&](const key_type &key, const mapped_type &value) {
+                if (!(key < from) && key < to) {
+                    matching.push_back(std::make_pair(&key, &value));
+                }
+            });
+            std::sort(matching.begin(), matching.end(),
+                      [](const std::pair<const key_type *, const mapped_type *> &a,
+                         const std::pair<const key_type *, const mapped_type *> &b) {
+                          return *a.first < *b.first;
+                      });
+            for (const auto &entry : matching) {
+                visitor(*entry.first, *entry.second);
+            }
+        }
+
+    private:
+        Representation representation;
+        std::array<key_type, INLINE_CAPACITY> inlineKeys;
+        std::array<mapped_type, INLINE_CAPACITY> inlineValues;
+        size_type inlineCount;
+        HashMap<key_type, mapped_type> hash;
+
+        // hashed entries stay in place until removed, so the index can point at them
+        IndexState indexState;
+        std::vector<const value_type *> orderedEntries;
+        // while building: entries the cursor may or may not reach, deduplicated when gathering ends
+        std::vector<const value_type *> insertedWhileBuilding;
+        typename HashMap<key_type, mapped_type>::const_iterator buildCursor;
+
+        size_type operationsInWindow;
+        size_type rangeQueriesInWindow;
+
+        struct KeyLess {
+            bool operator()(const value_type *a, const value_type *b) const {
+                return a->first < b->first;
+            }
+
+            bool operator()(const value_type *a, const key_type &b) const {
+                return a->first < b;
+            }
+        };
+
+        void swap(AdaptiveMap &other) {
+            std::swap(representation, other.representation);
+            std::swap(inlineKeys, other.inlineKeys);
+            std::swap(inlineValues, other.inlineValues);
+            std::swap(inlineCount, other.inlineCount);
+            std::swap(hash, other.hash);
+            dropIndex();
+            other.dropIndex();
+        }
+
+        size_type inlineFind(const key_type &key) const {
+            size_type position = 0;
+            while (position < inlineCount && inlineKeys[position] != key) {
+                ++position;
+            }
+            return position;
+        }
+
+        void promote() {
+            for (size_type i = 0; i < inlineCount; ++i) {
+                hash[inlineKeys[i]] = std::move(inlineValues[i]);
+            }
+            inlineCount = 0;
+            representation = Representation::Hashed;
+        }
+
+        void demote() {
+            dropIndex();
+            inlineCount = 0;
+            for (auto &entry : hash) {
+                inlineKeys[inlineCount] = entry.first;
+                inlineValues[inlineCount] = std::move(entry.second);
+                ++inlineCount;
+            }
+            hash = HashMap<key_type, mapped_type>();
+            representation = Representation::Inline;
+        }
+
+        /**
+         * Bookkeeping run by every operation: closes statistics windows and advances index building.
+         */
+        void step() {
+            if (++operationsInWindow == STATISTICS_WINDOW) {
+                if (rangeQueriesInWindow == 0) {
+                    dropIndex();
+                }
+                operationsInWindow = 0;
+                rangeQueriesInWindow = 0;
+            }
+            if (indexState == IndexState::Building) {
+                continueIndexing();
+            }
+        }
+
+        void startIndexing() {
+            indexState = IndexState::Building;
+            orderedEntries.clear();
+            orderedEntries.reserve(hash.getSize());
+            insertedWhileBuilding.clear();
+            buildCursor = hash.cbegin();
+        }
+
+        void continueIndexing(size_type steps = INDEX_STEP) {
+            const auto end = hash.cend();
+            for (size_type i = 0; i < steps && buildCursor != end; ++i, ++buildCursor) {
+                orderedEntries.push_back(&*buildCursor);
+            }
+            if (buildCursor != end) {
+                return;
+            }
+
+            orderedEntries.insert(orderedEntries.end(), insertedWhileBuilding.begin(), insertedWhileBuilding.end());
+            insertedWhileBuilding = std::vector<const value_type *>();
+            std::sort(orderedEntries.begin(), orderedEntries.end());
+            orderedEntries.erase(std::unique(orderedEntries.begin(), orderedEntries.end()), orderedEntries.end());
+            std::sort(orderedEntries.begin(), orderedEntries.end(), KeyLess());
+            indexState = IndexState::Ready;
+        }
+
+        void dropIndex() {
+            indexState = IndexState::Absent;
+            orderedEntries = std::vector<const value_type *>();
+            insertedWhileBuilding = std::vector<const value_type *>();
+            buildCursor = hash.cend();
+        }
+
+        void indexInserted(const value_type *entry) {
+            if (indexState == IndexState::Building) {
+                insertedWhileBuilding.push_back(entry);
+            } else {
+                orderedEntries.insert(std::upper_bound(orderedEntries.begin(), orderedEntries.end(), entry, KeyLess()),
+                                      entry);
+            }
+        }
+
+        /**
+         * Must run before the entry leaves the hash map. Gathering cannot tell whether the entry was
+         * already collected, so a pending index is completed first.
+         */
+        void indexRemoved(const key_type &key) {
+            if (indexState == IndexState::Absent) {
+                return;
+            }
+            if (indexState == IndexState::Building) {
+                continueIndexing(hash.getSize());
+            }
+            auto position = std::lower_bound(orderedEntries.begin(), orderedEntries.end(), key, KeyLess());
+            orderedEntries.erase(position);
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_ADAPTIVEMAP_H */
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AdaptiveMap.h"
+#include "HashMap.h"
+#include "TreeMap.h"
+#include "Benchmark.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t SMALL_MAPS = 20000;
+            const std::size_t SMALL_MAP_SIZE = 6;
+            const std::size_t ELEMENTS = 5000;
+            const std::size_t RANGE_QUERIES = 2000;
+            const int RANGE_WIDTH = 1 << 20;
+
+            template<typename Map>
+            void smallMaps(const std::string &name) {
+                report(measure("adaptive", "small maps " + name, SMALL_MAPS * SMALL_MAP_SIZE, [&]() {
+                    std::size_t sum = 0;
+                    for (std::size_t i = 0; i < SMALL_MAPS; ++i) {
+                        Map map;
+                        for (std::size_t key = 0; key < SMALL_MAP_SIZE; ++key) {
+                            map[static_cast<int>(key * 7)] = static_cast<int>(i);
+                        }
+                        sum += static_cast<std::size_t>(map.valueOf(7));
+                    }
+                    consume(sum);
+                }));
+            }
+
+            void rangeQueries(const std::vector<int> &keys, const std::vector<int> &starts) {
+                AdaptiveMap<int, int> adaptive;
+                TreeMap<int, int> tree;
+                for (auto key : keys) {
+                    adaptive[key] = key;
+                    tree[key] = key;
+                }
+
+                auto queryAdaptive = [&]() {
+                    std::size_t sum = 0;
+                    for (auto start : starts) {
+                        adaptive.forEachInRange(start, start + RANGE_WIDTH, [&sum](int, int value) {
+                            sum += static_cast<std::size_t>(value);
+                        });
+                    }
+                    consume(sum);
+                };
+                // the first run includes scans issued while the index is still being gathered
+                report(measure("adaptive", "range queries adaptive cold", starts.size(), queryAdaptive));
+                report(measure("adaptive", "range queries adaptive indexed", starts.size(), queryAdaptive));
+
+                report(measure("adaptive", "range queries tree", starts.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (auto start : starts) {
+                        for (auto it = tree.find(start); it != tree.end() && it->first < start + RANGE_WIDTH; ++it) {
+                            sum += static_cast<std::size_t>(it->second);
+                        }
+                    }
+                    consume(sum);
+                }));
+            }
+
+        }
+
+        void adaptiveMapSuite() {
+            smallMaps<AdaptiveMap<int, int>>("adaptive");
+            smallMaps<HashMap<int, int>>("hash");
+            smallMaps<TreeMap<int, int>>("tree");
+
+            std::mt19937 generator(42);
+            std::uniform_int_distribution<int> values(0, 1 << 30);
+            std::vector<int> keys(ELEMENTS);
+            std::generate(keys.begin(), keys.end(), [&]() { return values(generator); });
+            std::vector<int> starts(RANGE_QUERIES);
+            std::uniform_int_distribution<std::size_t> pick(0, ELEMENTS - 1);
+            std::generate(starts.begin(), starts.end(), [&]() { return keys[pick(generator)]; });
+            rangeQueries(keys, starts);
+        }
+
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef AISDI_MAPS_ALLOCATIONCOUNTER_H
+#define AISDI_MAPS_ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace aisdi {
+    namespace benchmark {
+
+        /**
+         * Heap allocations counted since the program started. Counters are relaxed atomics, cheap
+         * enough to stay on while timing.
+         */
+        struct AllocationCounts {
+            std::atomic<std::uint64_t> allocations;
+            std::atomic<std::uint64_t> deallocations;
+            std::atomic<std::uint64_t> bytes;
+
+            void allocated(std::size_t size) {
+                allocations.fetch_add(1, std::memory_order_relaxed);
+                bytes.fetch_add(size, std::memory_order_relaxed);
+            }
+
+            void deallocated() {
+                deallocations.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * Counts of the global operator new and delete. They only move in programs linking
+         * AllocationTracking.cpp, which replaces those operators; isAllocationTrackingInstalled()
+         * tells.
+         */
+        inline AllocationCounts &globalAllocations() {
+            // zero-initialized before any dynamic initialization, so usable from operator new
+            static AllocationCounts counts;
+            return counts;
+        }
+
+        inline std::atomic<bool> &allocationTrackingFlag() {
+            static std::atomic<bool> installed;
+            return installed;
+        }
+
+        inline bool isAllocationTrackingInstalled() {
+            return allocationTrackingFlag().load(std::memory_order_relaxed);
+        }
+
+        struct AllocationSnapshot {
+            std::uint64_t allocations;
+            std::uint64_t bytes;
+
+            static AllocationSnapshot of(const AllocationCounts &counts) {
+                return AllocationSnapshot{counts.allocations.load(std::memory_order_relaxed),
+                                          counts.bytes.load(std::memory_order_relaxed)};
+            }
+
+            static AllocationSnapshot now() {
+                return of(globalAllocations());
+            }
+
+            AllocationSnapshot operator-(const AllocationSnapshot &earlier) const {
+                return AllocationSnapshot{allocations - earlier.allocations, bytes - earlier.bytes};
+            }
+        };
+
+        /**
+         * Allocator counting into its own AllocationCounts, for attributing allocations to one
+         * container when the global counts mix in everything else the program does.
+         */
+        template<typename T>
+        class CountingAllocator {
+        public:
+            using value_type = T;
+
+            explicit CountingAllocator(AllocationCounts &counts) : counts(&counts) {}
+
+            template<typename U>
+            CountingAllocator(const CountingAllocator<U> &other) : counts(other.getCounts()) {}
+
+            T *allocate(std::size_t n) {
+                counts->allocated(n * sizeof(T));
+                return std::allocator<T>().allocate(n);
+            }
+
+            void deallocate(T *pointer, std::size_t n) {
+                counts->deallocated();
+                std::allocator<T>().deallocate(pointer, n);
+            }
+
+            AllocationCounts *getCounts() const {
+                return counts;
+            }
+
+            template<typename U>
+            bool operator==(const CountingAllocator<U> &other) const {
+                return counts == other.getCounts();
+            }
+
+            template<typename U>
+            bool operator!=(const CountingAllocator<U> &other) const {
+                return counts != other.getCounts();
+            }
+
+        private:
+            AllocationCounts *counts;
+        };
+
+    }
+}
+
+#endif /* AISDI_MAPS_ALLOCATIONCOUNTER_H */
@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+/*
+ * Replaceable global allocation functions counting into aisdi::benchmark::globalAllocations().
+ * Linked into the benchmark executable only; the maps themselves never depend on it.
+ */
+
+namespace {
+
+    void *allocate(std::size_t size) {
+        aisdi::benchmark::globalAllocations().allocated(size);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *allocateOrThrow(std::size_t size) {
+        for (;;) {
+            if (auto pointer = allocate(size)) {
+                return pointer;
+            }
+            auto handler = std::get_new_handler();
+            if (handler == nullptr) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void deallocate(void *pointer) {
+        if (pointer != nullptr) {
+            aisdi::benchmark::globalAllocations().deallocated();
+            std::free(pointer);
+        }
+    }
+
+    struct Installed {
+        Installed() {
+            aisdi::benchmark::allocationTrackingFlag().store(true);
+        }
+    } installed;
+
+}
+
+void *operator new(std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    deallocate(pointer);
+}
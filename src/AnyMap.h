@@ -0,0 +1,190 @@
+#ifndef AISDI_MAPS_ANYMAP_H
+#define AISDI_MAPS_ANYMAP_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MapConcept.h"
+#include "TreeMap.h"
+#include "HashMap.h"
+#include "FlatTreeMap.h"
+#include "BeTreeMap.h"
+
+namespace aisdi {
+
+    /**
+     * Map whose engine is chosen at run time, e.g. from configuration.
+     *
+     * Every call is one virtual dispatch, so the batch operations are the ones to use in hot
+     * loops: the per-element loop runs inside the engine, fully inlined. Pointers returned by
+     * lookup() are valid until the next modification.
+     */
+    template<typename KeyType, typename ValueType>
+    class AnyMap {
+    public:
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+        using size_type = std::size_t;
+        using entry_type = std::pair<key_type, mapped_type>;
+
+        template<typename Map>
+        static AnyMap of(const std::string &engineName) {
+            static_assert(IsMap<Map>::value, "AnyMap engines must provide the common map interface");
+            return AnyMap(std::unique_ptr<Engine>(new Model<Map>(engineName)));
+        }
+
+        /**
+         * Engines: "tree", "hash", "flat" and "betree".
+         */
+        static AnyMap create(const std::string &engineName) {
+            if (engineName == "tree") {
+                return of<TreeMap<key_type, mapped_type>>(engineName);
+            }
+            if (engineName == "hash") {
+                return of<HashMap<key_type, mapped_type>>(engineName);
+            }
+            if (engineName == "flat") {
+                return of<FlatTreeMap<key_type, mapped_type>>(engineName);
+            }
+            if (engineName == "betree") {
+                return of<BeTreeMap<key_type, mapped_type>>(engineName);
+            }
+            throw std::invalid_argument("Unknown map engine: " + engineName);
+        }
+
+        const std::string &getEngineName() const {
+            return engine->name;
+        }
+
+        bool isEmpty() const {
+            return engine->getSize() == 0;
+        }
+
+        size_type getSize() const {
+            return engine->getSize();
+        }
+
+        void assign(const key_type &key, const mapped_type &value) {
+            engine->assign(&key, &value, 1);
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            const mapped_type *value = nullptr;
+            engine->lookup(&key, &value, 1);
+            if (value == nullptr) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            return *value;
+        }
+
+        void remove(const key_type &key) {
+            if (engine->remove(&key, 1) == 0) {
+                throw std::out_of_range("Map does not contain key");
+            }
+        }
+
+        void assign(const std::vector<key_type> &keys, const std::vector<mapped_type> &values) {
+            if (keys.size() != values.size()) {
+                throw std::invalid_argument("Keys and values differ in length");
+            }
+            engine->assign(keys.data(), values.data(), keys.size());
+        }
+
+        /**
+         * Fills found with a pointer to the value of each key, or nullptr. Returns the number of hits.
+         */
+        size_type lookup(const std::vector<key_type> &keys, std::vector<const mapped_type *> &found) const {
+            found.assign(keys.size(), nullptr);
+            return engine->lookup(keys.data(), found.data(), keys.size());
+        }
+
+        /**
+         * Removes the keys that are present, returns how many were.
+         */
+        size_type remove(const std::vector<key_type> &keys) {
+            return engine->remove(keys.data(), keys.size());
+        }
+
+        void forEach(const std::function<void(const key_type &, const mapped_type &)> &visitor) const {
+            engine->forEach(visitor);
+        }
+
+    private:
+        struct Engine {
+            explicit Engine(const std::string &name) : name(name) {}
+
+            virtual ~Engine() = default;
+
+            virtual size_type getSize() const = 0;
+
+            virtual void assign(const key_type *keys, const mapped_type *values, size_type count) = 0;
+
+            virtual size_type lookup(const key_type *keys, const mapped_type **found, size_type count) const = 0;
+
+            virtual size_type remove(const key_type *keys, size_type count) = 0;
+
+            virtual void forEach(const std::function<void(const key_type &, const mapped_type &)> &visitor) const = 0;
+
+            const std::string name;
+        };
+
+        template<typename Map>
+        struct Model : Engine {
+            explicit Model(const std::string &name) : Engine(name) {}
+
+            size_type getSize() const override {
+                return map.getSize();
+            }
+
+            void assign(const key_type *keys, const mapped_type *values, size_type count) override {
+                for (size_type i = 0; i < count; ++i) {
+                    map[keys[i]] = values[i];
+                }
+            }
+
+            size_type lookup(const key_type *keys, const mapped_type **found, size_type count) const override {
+                size_type hits = 0;
+                for (size_type i = 0; i < count; ++i) {
+                    auto it = map.find(keys[i]);
+                    if (it != map.end()) {
+                        found[i] = &it->second;
+                        ++hits;
+                    }
+                }
+                return hits;
+            }
+
+            size_type remove(const key_type *keys, size_type count) override {
+                size_type removed = 0;
+                for (size_type i = 0; i < count; ++i) {
+                    auto it = map.find(keys[i]);
+                    if (it != map.end()) {
+                        map.remove(it);
+                        ++removed;
+                    }
+                }
+                return removed;
+            }
+
+            void forEach(const std::function<void(const key_type &, const mapped_type &)> &visitor) const override {
+                for (auto it = map.begin(); it != map.end(); ++it) {
+                    visitor(it->first, it->second);
+                }
+            }
+
+            Map map;
+        };
+
+        explicit AnyMap(std::unique_ptr<Engine> engine) : engine(std::move(engine)) {}
+
+        std::unique_ptr<Engine> engine;
+    };
+
+}
+
+#endif /* AISDI_MAPS_ANYMAP_H */
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AnyMap.h"
+#include "Benchmark.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ELEMENTS = 10000;
+            const std::size_t LOOKUPS = 200000;
+
+            template<typename Map>
+            void direct(const std::string &name, const std::vector<int> &keys, const std::vector<int> &probes) {
+                Map map;
+                for (auto key : keys) {
+                    map[key] = key;
+                }
+                report(measure("anymap", "direct " + name, probes.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (auto key : probes) {
+                        auto it = map.find(key);
+                        sum += it == map.end() ? 0 : static_cast<std::size_t>(it->second);
+                    }
+                    consume(sum);
+                }));
+            }
+
+            void facade(const std::string &engine, const std::vector<int> &keys, const std::vector<int> &probes) {
+                auto map = AnyMap<int, int>::create(engine);
+                map.assign(keys, keys);
+
+                report(measure("anymap", "facade per element " + engine, probes.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (auto key : probes) {
+                        sum += static_cast<std::size_t>(map.valueOf(key));
+                    }
+                    consume(sum);
+                }));
+
+                std::vector<const int *> found;
+                report(measure("anymap", "facade batch " + engine, probes.size(), [&]() {
+                    map.lookup(probes, found);
+                    std::size_t sum = 0;
+                    for (auto value : found) {
+                        sum += value == nullptr ? 0 : static_cast<std::size_t>(*value);
+                    }
+                    consume(sum);
+                }));
+            }
+
+        }
+
+        void anyMapSuite() {
+            std::mt19937 generator(42);
+            std::vector<int> keys(ELEMENTS);
+            std::generate(keys.begin(), keys.end(), [&generator]() { return static_cast<int>(generator()); });
+            std::vector<int> probes(LOOKUPS);
+            std::uniform_int_distribution<std::size_t> pick(0, ELEMENTS - 1);
+            std::generate(probes.begin(), probes.end(), [&]() { return keys[pick(generator)]; });
+
+            direct<TreeMap<int, int>>("tree", keys, probes);
+            facade("tree", keys, probes);
+            direct<HashMap<int, int>>("hash", keys, probes);
+            facade("hash", keys, probes);
+            direct<FlatTreeMap<int, int>>("flat", keys, probes);
+            facade("flat", keys, probes);
+        }
+
+    }
+}
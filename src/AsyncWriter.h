@@ -0,0 +1,763 @@
+#ifndef AISDI_MAPS_ASYNCWRITER_H
+#define AISDI_MAPS_ASYNCWRITER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef AISDI_MAPS_HAVE_IO_URING
+
+#include <csignal>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#endif
+
+#include "ThreadPool.h"
+
+namespace aisdi {
+
+    /**
+     * Heap buffer aligned, and sized in multiples of, ALIGNMENT bytes, so it can be handed to
+     * files opened with O_DIRECT. Move-only.
+     */
+    class AlignedBuffer {
+    public:
+        using size_type = std::size_t;
+
+        static const size_type ALIGNMENT = 4096;
+
+        AlignedBuffer() : data(nullptr), size(0), capacity(0) {}
+
+        explicit AlignedBuffer(size_type minimalCapacity) : data(nullptr), size(0),
+                                                            capacity(roundUp(minimalCapacity)) {
+            void *allocated = nullptr;
+            if (capacity > 0 && posix_memalign(&allocated, ALIGNMENT, capacity) != 0) {
+                throw std::bad_alloc();
+            }
+            data = static_cast<char *>(allocated);
+        }
+
+        AlignedBuffer(const AlignedBuffer &) = delete;
+
+        AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+        AlignedBuffer(AlignedBuffer &&other) : data(other.data), size(other.size), capacity(other.capacity) {
+            other.data = nullptr;
+            other.size = 0;
+            other.capacity = 0;
+        }
+
+        AlignedBuffer &operator=(AlignedBuffer &&other) {
+            if (this != &other) {
+                std::free(data);
+                data = other.data;
+                size = other.size;
+                capacity = other.capacity;
+                other.data = nullptr;
+                other.size = 0;
+                other.capacity = 0;
+            }
+            return *this;
+        }
+
+        ~AlignedBuffer() {
+            std::free(data);
+        }
+
+        char *getData() {
+            return data;
+        }
+
+        const char *getData() const {
+            return data;
+        }
+
+        size_type getSize() const {
+            return size;
+        }
+
+        size_type getCapacity() const {
+            return capacity;
+        }
+
+        size_type getFree() const {
+            return capacity - size;
+        }
+
+        void append(const char *bytes, size_type count) {
+            if (count > getFree()) {
+                throw std::length_error("Buffer capacity exceeded");
+            }
+            std::memcpy(data + size, bytes, count);
+            size += count;
+        }
+
+        /**
+         * Sets how many leading bytes are in use, e.g. after filling getData() directly.
+         */
+        void resize(size_type newSize) {
+            if (newSize > capacity) {
+                throw std::length_error("Buffer capacity exceeded");
+            }
+            size = newSize;
+        }
+
+        void clear() {
+            size = 0;
+        }
+
+    private:
+        char *data;
+        size_type size;
+        size_type capacity;
+
+        static size_type roundUp(size_type bytes) {
+            return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+    };
+
+    enum class AsyncBackend {
+        Automatic, IoUring, Threads
+    };
+
+    /**
+     * Queue of positioned file writes and fsyncs completing in the background.
+     *
+     * Requests are batched until submit(). Writes may complete in any order, an fsync starts only
+     * after every earlier request completed and delays the later ones. Completion callbacks get 0
+     * or an errno value and run on the thread calling poll() or drain(); they may queue further
+     * requests. A writer is meant to be used from a single thread.
+     */
+    class AsyncWriter {
+    public:
+        using Completion = std::function<void(int error)>;
+
+        virtual ~AsyncWriter() {}
+
+        /**
+         * io_uring when requested or, for Automatic, when the kernel supports it; worker threads
+         * doing pwrite and fsync otherwise.
+         */
+        static std::unique_ptr<AsyncWriter> create(AsyncBackend backend = AsyncBackend::Automatic);
+
+        /**
+         * Writes the whole buffer at the given offset, retrying short writes.
+         */
+        virtual void write(int fd, AlignedBuffer buffer, std::uint64_t offset, Completion done) = 0;
+
+        virtual void fsync(int fd, Completion done) = 0;
+
+        virtual void submit() = 0;
+
+        /**
+         * Runs callbacks of completed requests without waiting, returns how many ran.
+         */
+        virtual std::size_t poll() = 0;
+
+        /**
+         * Submits queued requests and waits until all of them, including ones queued by callbacks,
+         * completed.
+         */
+        virtual void drain() = 0;
+
+        virtual std::size_t getPendingCount() const = 0;
+
+        virtual const char *getBackendName() const = 0;
+    };
+
+    /**
+     * Fallback backend: each submitted request becomes a ThreadPool task.
+     */
+    class ThreadedWriter : public AsyncWriter {
+    public:
+        explicit ThreadedWriter(std::size_t threads = DEFAULT_THREADS) : pending(0), pool(threads) {
+            barrier = readyFuture();
+        }
+
+        ~ThreadedWriter() {
+            drain();
+        }
+
+        void write(int fd, AlignedBuffer buffer, std::uint64_t offset, Completion done) override {
+            queued.push_back(Request{fd, std::make_shared<AlignedBuffer>(std::move(buffer)), offset,
+                                     std::move(done), false});
+            ++pending;
+        }
+
+        void fsync(int fd, Completion done) override {
+            queued.push_back(Request{fd, nullptr, 0, std::move(done), true});
+            ++pending;
+        }
+
+        void submit() override {
+            inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(), [](const std::shared_future<void> &f) {
+                return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }), inFlight.end());
+
+            for (auto &request : queued) {
+                const auto shared = std::make_shared<Request>(std::move(request));
+                if (shared->sync) {
+                    auto earlier = inFlight;
+                    earlier.push_back(barrier);
+                    barrier = pool.submit([this, shared, earlier]() {
+                        for (const auto &future : earlier) {
+                            future.wait();
+                        }
+                        complete(shared->done, ::fsync(shared->fd) == 0 ? 0 : errno);
+                    }).share();
+                    inFlight.clear();
+                } else {
+                    const auto after = barrier;
+                    inFlight.push_back(pool.submit([this, shared, after]() {
+                        after.wait();
+                        complete(shared->done, writeFully(shared->fd, *shared->buffer, shared->offset));
+                    }).share());
+                }
+            }
+            queued.clear();
+        }
+
+        std::size_t poll() override {
+            std::vector<std::pair<Completion, int>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.swap(completed);
+            }
+            return runCallbacks(ready);
+        }
+
+        void drain() override {
+            while (pending > 0) {
+                submit();
+                std::vector<std::pair<Completion, int>> ready;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    completedChanged.wait(lock, [this]() { return !completed.empty(); });
+                    ready.swap(completed);
+                }
+                runCallbacks(ready);
+            }
+        }
+
+        std::size_t getPendingCount() const override {
+            return pending;
+        }
+
+        const char *getBackendName() const override {
+            return "threads";
+        }
+
+    private:
+        static const std::size_t DEFAULT_THREADS = 2;
+
+        struct Request {
+            int fd;
+            std::shared_ptr<AlignedBuffer> buffer;
+            std::uint64_t offset;
+            Completion done;
+            bool sync;
+        };
+
+        std::vector<Request> queued;
+        std::size_t pending;
+        // writes submitted since the last fsync, and the last fsync itself
+        std::vector<std::shared_future<void>> inFlight;
+        std::shared_future<void> barrier;
+        std::mutex mutex;
+        std::condition_variable completedChanged;
+        std::vector<std::pair<Completion, int>> completed;
+        // declared last, so its workers are joined before the members they use are destroyed
+        ThreadPool pool;
+
+        static std::shared_future<void> readyFuture() {
+            std::promise<void> promise;
+            promise.set_value();
+            return promise.get_future().share();
+        }
+
+        static int writeFully(int fd, const AlignedBuffer &buffer, std::uint64_t offset) {
+            std::size_t written = 0;
+            while (written < buffer.getSize()) {
+                const auto result = ::pwrite(fd, buffer.getData() + written, buffer.getSize() - written,
+                                             static_cast<off_t>(offset + written));
+                if (result < 0 && errno != EINTR) {
+                    return errno;
+                }
+                if (result == 0) {
+                    return EIO;
+                }
+                written += result < 0 ? 0 : static_cast<std::size_t>(result);
+            }
+            return 0;
+        }
+
+        void complete(Completion &done, int error) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(std::make_pair(std::move(done), error));
+            }
+            completedChanged.notify_one();
+        }
+
+        std::size_t runCallbacks(std::vector<std::pair<Completion, int>> &ready) {
+            pending -= ready.size();
+            for (auto &callback : ready) {
+                if (callback.first) {
+                    callback.first(callback.second);
+                }
+            }
+            return ready.size();
+        }
+    };
+
+#ifdef AISDI_MAPS_HAVE_IO_URING
+
+    /**
+     * Backend on a single io_uring instance, driven through raw system calls. At most QUEUE_DEPTH
+     * requests are in the kernel at once, so the completion queue cannot overflow.
+     *
+     * An fsync is held back until every earlier request completed, and later requests until the
+     * fsync completed. The kernel's IOSQE_IO_DRAIN would not do: the rest of a short write is
+     * only queued on its completion, after an fsync drained by it may already have started.
+     */
+    class IoUringWriter : public AsyncWriter {
+    public:
+        static const unsigned QUEUE_DEPTH = 64;
+
+        IoUringWriter() : ringFd(-1), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(MAP_FAILED), unsubmitted(0),
+                          inKernel(0), syncInKernel(false) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            ringFd = static_cast<int>(syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+            if (ringFd < 0) {
+                throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+            }
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMapping) {
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            }
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                          IORING_OFF_SQ_RING);
+            cqRing = singleMapping ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+                const auto error = errno;
+                release();
+                throw std::system_error(error, std::generic_category(), "io_uring mmap");
+            }
+
+            auto sqBase = static_cast<char *>(sqRing);
+            sqHead = reinterpret_cast<unsigned *>(sqBase + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned *>(sqBase + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned *>(sqBase + params.sq_off.ring_mask);
+            sqEntries = params.sq_entries;
+            sqArray = reinterpret_cast<unsigned *>(sqBase + params.sq_off.array);
+            auto cqBase = static_cast<char *>(cqRing);
+            cqHead = reinterpret_cast<unsigned *>(cqBase + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned *>(cqBase + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned *>(cqBase + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe *>(cqBase + params.cq_off.cqes);
+
+            slots.resize(sqEntries);
+            for (unsigned i = 0; i < sqEntries; ++i) {
+                freeSlots.push_back(sqEntries - 1 - i);
+            }
+        }
+
+        IoUringWriter(const IoUringWriter &) = delete;
+
+        IoUringWriter &operator=(const IoUringWriter &) = delete;
+
+        ~IoUringWriter() {
+            drain();
+            release();
+        }
+
+        void write(int fd, AlignedBuffer buffer, std::uint64_t offset, Completion done) override {
+            auto slot = acquireSlot();
+            slots[slot] = Request{fd, std::move(buffer), offset, 0, std::move(done), false};
+            schedule(slot);
+        }
+
+        void fsync(int fd, Completion done) override {
+            auto slot = acquireSlot();
+            slots[slot] = Request{fd, AlignedBuffer(), 0, 0, std::move(done), true};
+            schedule(slot);
+        }
+
+        void submit() override {
+            while (unsubmitted > 0) {
+                const auto result = syscall(__NR_io_uring_enter, ringFd, unsubmitted, 0, 0, nullptr, _NSIG / 8);
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+                }
+                unsubmitted -= static_cast<unsigned>(result);
+            }
+        }
+
+        std::size_t poll() override {
+            std::vector<std::pair<Completion, int>> ready;
+            reap(ready);
+            return runCallbacks(ready);
+        }
+
+        void drain() override {
+            while (getPendingCount() > 0) {
+                submit();
+                waitForCompletion();
+                poll();
+            }
+        }
+
+        std::size_t getPendingCount() const override {
+            return sqEntries - freeSlots.size();
+        }
+
+        const char *getBackendName() const override {
+            return "io_uring";
+        }
+
+    private:
+        struct Request {
+            int fd;
+            AlignedBuffer buffer;
+            std::uint64_t offset;
+            std::size_t written;
+            Completion done;
+            bool sync;
+        };
+
+        int ringFd;
+        void *sqRing;
+        void *cqRing;
+        void *sqes;
+        std::size_t sqRingSize;
+        std::size_t cqRingSize;
+        std::size_t sqesSize;
+        unsigned *sqHead;
+        unsigned *sqTail;
+        unsigned sqMask;
+        unsigned sqEntries;
+        unsigned *sqArray;
+        unsigned *cqHead;
+        unsigned *cqTail;
+        unsigned cqMask;
+        io_uring_cqe *cqes;
+        unsigned unsubmitted;
+        unsigned inKernel;
+        bool syncInKernel;
+        std::vector<Request> slots;
+        std::vector<unsigned> freeSlots;
+        // requests waiting for an fsync ahead of them, or fsyncs waiting for earlier requests
+        std::deque<unsigned> deferred;
+
+        void release() {
+            if (sqes != MAP_FAILED) {
+                munmap(sqes, sqesSize);
+            }
+            if (cqRing != MAP_FAILED && cqRing != sqRing) {
+                munmap(cqRing, cqRingSize);
+            }
+            if (sqRing != MAP_FAILED) {
+                munmap(sqRing, sqRingSize);
+            }
+            if (ringFd >= 0) {
+                close(ringFd);
+            }
+        }
+
+        unsigned acquireSlot() {
+            while (freeSlots.empty()) {
+                // every slot is taken, so completions are bound to arrive
+                submit();
+                waitForCompletion();
+                poll();
+            }
+            const auto slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+
+        void schedule(unsigned slot) {
+            if (!deferred.empty() || syncInKernel || (slots[slot].sync && inKernel > 0)) {
+                deferred.push_back(slot);
+            } else {
+                enqueue(slot);
+            }
+        }
+
+        /**
+         * Moves deferred requests to the kernel up to, and including, the next fsync that can start.
+         */
+        void releaseDeferred() {
+            while (!deferred.empty() && !syncInKernel) {
+                const auto slot = deferred.front();
+                if (slots[slot].sync && inKernel > 0) {
+                    return;
+                }
+                deferred.pop_front();
+                enqueue(slot);
+            }
+        }
+
+        void enqueue(unsigned slot) {
+            const auto &request = slots[slot];
+            const auto tail = *sqTail;
+            const auto index = tail & sqMask;
+            auto &entry = static_cast<io_uring_sqe *>(sqes)[index];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.fd = request.fd;
+            entry.user_data = slot;
+            if (request.sync) {
+                entry.opcode = IORING_OP_FSYNC;
+                syncInKernel = true;
+            } else {
+                entry.opcode = IORING_OP_WRITE;
+                entry.addr = reinterpret_cast<std::uint64_t>(request.buffer.getData() + request.written);
+                entry.len = static_cast<std::uint32_t>(request.buffer.getSize() - request.written);
+                entry.off = request.offset + request.written;
+            }
+            sqArray[index] = index;
+            __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+            ++unsubmitted;
+            ++inKernel;
+        }
+
+        void waitForCompletion() {
+            if (inKernel == 0 || __atomic_load_n(cqTail, __ATOMIC_ACQUIRE) != *cqHead) {
+                return;
+            }
+            while (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, _NSIG / 8) < 0) {
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+                }
+            }
+        }
+
+        void reap(std::vector<std::pair<Completion, int>> &ready) {
+            auto head = *cqHead;
+            const auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const auto &entry = cqes[head & cqMask];
+                const auto slot = static_cast<unsigned>(entry.user_data);
+                const auto result = entry.res;
+                --inKernel;
+                auto &request = slots[slot];
+                if (request.sync) {
+                    syncInKernel = false;
+                } else if (result > 0 &&
+                           request.written + static_cast<std::size_t>(result) < request.buffer.getSize()) {
+                    // short write, the rest goes out with the next submit, still ahead of any fsync
+                    request.written += static_cast<std::size_t>(result);
+                    enqueue(slot);
+                    continue;
+                }
+                const int error = result < 0 ? -result : (!request.sync && result == 0 ? EIO : 0);
+                ready.push_back(std::make_pair(std::move(request.done), error));
+                request.buffer = AlignedBuffer();
+                freeSlots.push_back(slot);
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            releaseDeferred();
+        }
+
+        std::size_t runCallbacks(std::vector<std::pair<Completion, int>> &ready) {
+            for (auto &callback : ready) {
+                if (callback.first) {
+                    callback.first(callback.second);
+                }
+            }
+            return ready.size();
+        }
+    };
+
+#endif
+
+    inline std::unique_ptr<AsyncWriter> AsyncWriter::create(AsyncBackend backend) {
+#ifdef AISDI_MAPS_HAVE_IO_URING
+        if (backend != AsyncBackend::Threads) {
+            try {
+                return std::unique_ptr<AsyncWriter>(new IoUringWriter());
+            } catch (const std::system_error &) {
+                if (backend == AsyncBackend::IoUring) {
+                    throw;
+                }
+            }
+        }
+#else
+        if (backend == AsyncBackend::IoUring) {
+            throw std::system_error(ENOSYS, std::generic_category(), "io_uring support not compiled in");
+        }
+#endif
+        return std::unique_ptr<AsyncWriter>(new ThreadedWriter());
+    }
+
+    /**
+     * Stream buffer cutting everything written to it into CHUNK_SIZE aligned buffers written
+     * through an AsyncWriter at consecutive file offsets. Lets maps write snapshots with their
+     * usual writeSnapshot(std::ostream &) without waiting for the disk.
+     */
+    class AsyncFileOutput : public std::streambuf {
+    public:
+        static const std::size_t CHUNK_SIZE = 1 << 20;
+
+        AsyncFileOutput(AsyncWriter &writer, int fd, std::uint64_t offset = 0, std::size_t chunkSize = CHUNK_SIZE)
+                : writer(writer), fd(fd), offset(offset), chunkSize(chunkSize), state(std::make_shared<State>()) {
+            startChunk();
+        }
+
+        AsyncFileOutput(const AsyncFileOutput &) = delete;
+
+        AsyncFileOutput &operator=(const AsyncFileOutput &) = delete;
+
+        /**
+         * Writes out the buffered part and queues an fsync. done gets the first error of any write
+         * since construction or the previous finish, or the error of the fsync.
+         */
+        void finish(AsyncWriter::Completion done) {
+            dispatch();
+            auto finished = state;
+            state = std::make_shared<State>();
+            writer.fsync(fd, [finished, done](int error) {
+                if (done) {
+                    done(finished->error != 0 ? finished->error : error);
+                }
+            });
+            writer.submit();
+        }
+
+        /**
+         * File offset after the last byte written so far.
+         */
+        std::uint64_t getOffset() const {
+            return offset + static_cast<std::uint64_t>(pptr() - pbase());
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            dispatch();
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *bytes, std::streamsize count) override {
+            std::streamsize written = 0;
+            while (written < count) {
+                if (pptr() == epptr()) {
+                    dispatch();
+                }
+                const auto part = std::min<std::streamsize>(count - written, epptr() - pptr());
+                std::memcpy(pptr(), bytes + written, static_cast<std::size_t>(part));
+                pbump(static_cast<int>(part));
+                written += part;
+            }
+            return written;
+        }
+
+        int sync() override {
+            dispatch();
+            writer.submit();
+            return 0;
+        }
+
+    private:
+        struct State {
+            State() : error(0) {}
+
+            int error;
+        };
+
+        AsyncWriter &writer;
+        int fd;
+        std::uint64_t offset;
+        std::size_t chunkSize;
+        AlignedBuffer chunk;
+        std::shared_ptr<State> state;
+
+        void startChunk() {
+            chunk = AlignedBuffer(chunkSize);
+            setp(chunk.getData(), chunk.getData() + chunk.getCapacity());
+        }
+
+        void dispatch() {
+            const auto used = static_cast<std::size_t>(pptr() - pbase());
+            if (used == 0) {
+                return;
+            }
+            chunk.resize(used);
+            auto current = state;
+            writer.write(fd, std::move(chunk), offset, [current](int error) {
+                if (error != 0 && current->error == 0) {
+                    current->error = error;
+                }
+            });
+            offset += used;
+            startChunk();
+        }
+    };
+
+    /**
+     * Writes a full snapshot of the map to fd from the given offset. Serialization happens on the
+     * calling thread, done is called from the writer once the file is synced.
+     */
+    template<typename Map>
+    std::uint64_t writeSnapshotAsync(Map &map, AsyncWriter &writer, int fd, AsyncWriter::Completion done,
+                                     std::uint64_t offset = 0) {
+        AsyncFileOutput output(writer, fd, offset);
+        std::ostream stream(&output);
+        map.writeSnapshot(stream);
+        const auto end = output.getOffset();
+        output.finish(std::move(done));
+        return end;
+    }
+
+    /**
+     * As writeSnapshotAsync, for a delta against the map's last checkpoint.
+     */
+    template<typename Map>
+    std::uint64_t writeDeltaAsync(Map &map, AsyncWriter &writer, int fd, AsyncWriter::Completion done,
+                                  std::uint64_t offset = 0) {
+        AsyncFileOutput output(writer, fd, offset);
+        std::ostream stream(&output);
+        map.writeDelta(stream);
+        const auto end = output.getOffset();
+        output.finish(std::move(done));
+        return end;
+    }
+
+}
+
+#endif /* AISDI_MAPS_ASYNCWRITER_H */
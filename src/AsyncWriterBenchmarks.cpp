@@ -0,0 +1,183 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "AsyncWriter.h"
+#include "Benchmark.h"
+#include "MutationLog.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ELEMENTS = 200000;
+            const std::size_t COMMITS = 500;
+            const std::size_t RECORDS_PER_COMMIT = 16;
+
+            class TemporaryFile {
+            public:
+                TemporaryFile() {
+                    const char *directory = std::getenv("TMPDIR");
+                    path = std::string(directory != nullptr ? directory : "/tmp") + "/aisdiMapsXXXXXX";
+                    fd = mkstemp(&path[0]);
+                }
+
+                ~TemporaryFile() {
+                    if (fd >= 0) {
+                        close(fd);
+                        unlink(path.c_str());
+                    }
+                }
+
+                int getFd() const {
+                    return fd;
+                }
+
+            private:
+                std::string path;
+                int fd;
+            };
+
+            /**
+             * Baseline doing each write and fsync on the calling thread as it is queued, so the
+             * sync rows go through the same AsyncFileOutput framing and fsync as the async ones.
+             */
+            class BlockingWriter : public AsyncWriter {
+            public:
+                void write(int fd, AlignedBuffer buffer, std::uint64_t offset, Completion done) override {
+                    std::size_t written = 0;
+                    int error = 0;
+                    while (error == 0 && written < buffer.getSize()) {
+                        const auto result = ::pwrite(fd, buffer.getData() + written, buffer.getSize() - written,
+                                                     static_cast<off_t>(offset + written));
+                        if (result > 0) {
+                            written += static_cast<std::size_t>(result);
+                        } else if (result == 0 || errno != EINTR) {
+                            error = result == 0 ? EIO : errno;
+                        }
+                    }
+                    completed.push_back(std::make_pair(std::move(done), error));
+                }
+
+                void fsync(int fd, Completion done) override {
+                    completed.push_back(std::make_pair(std::move(done), ::fsync(fd) == 0 ? 0 : errno));
+                }
+
+                void submit() override {}
+
+                std::size_t poll() override {
+                    std::vector<std::pair<Completion, int>> ready;
+                    ready.swap(completed);
+                    for (auto &callback : ready) {
+                        if (callback.first) {
+                            callback.first(callback.second);
+                        }
+                    }
+                    return ready.size();
+                }
+
+                void drain() override {
+                    while (poll() > 0) {}
+                }
+
+                std::size_t getPendingCount() const override {
+                    return completed.size();
+                }
+
+                const char *getBackendName() const override {
+                    return "sync";
+                }
+
+            private:
+                std::vector<std::pair<Completion, int>> completed;
+            };
+
+            void snapshots(const TreeMap<int, int> &source) {
+                {
+                    TreeMap<int, int> map(source);
+                    TemporaryFile file;
+                    BlockingWriter writer;
+                    report(measure("io", "snapshot sync pwrite+fsync", map.getSize(), [&]() {
+                        writeSnapshotAsync(map, writer, file.getFd(), nullptr);
+                        writer.drain();
+                    }));
+                }
+
+                for (auto backend : {AsyncBackend::IoUring, AsyncBackend::Threads}) {
+                    std::unique_ptr<AsyncWriter> writer;
+                    try {
+                        writer = AsyncWriter::create(backend);
+                    } catch (const std::system_error &) {
+                        continue;
+                    }
+                    const std::string name = writer->getBackendName();
+                    TreeMap<int, int> map(source);
+                    TemporaryFile file;
+                    report(measure("io", "snapshot " + name + " caller", map.getSize(), [&]() {
+                        writeSnapshotAsync(map, *writer, file.getFd(), nullptr);
+                    }));
+                    report(measure("io", "snapshot " + name + " until synced", map.getSize(), [&]() {
+                        writer->drain();
+                    }));
+                }
+            }
+
+            void logCommits() {
+                std::vector<std::unique_ptr<AsyncWriter>> writers;
+                writers.emplace_back(new BlockingWriter());
+                for (auto backend : {AsyncBackend::IoUring, AsyncBackend::Threads}) {
+                    try {
+                        writers.push_back(AsyncWriter::create(backend));
+                    } catch (const std::system_error &) {
+                    }
+                }
+                for (auto &writer : writers) {
+                    TemporaryFile file;
+                    MutationLog<int, int> log(*writer, file.getFd());
+                    double latencies = 0;
+                    report(measure("io", std::string("log commit ") + writer->getBackendName() + " throughput",
+                                   COMMITS, [&]() {
+                                for (std::size_t commit = 0; commit < COMMITS; ++commit) {
+                                    for (std::size_t i = 0; i < RECORDS_PER_COMMIT; ++i) {
+                                        const int key = static_cast<int>(commit * RECORDS_PER_COMMIT + i);
+                                        log.recordAssign(key, key);
+                                    }
+                                    const auto started = std::make_shared<Stopwatch>();
+                                    log.commit([&latencies, started](int) {
+                                        latencies += started->elapsedNanoseconds();
+                                    });
+                                    writer->poll();
+                                }
+                                writer->drain();
+                            }));
+                    report(Result{"io", std::string("log commit ") + writer->getBackendName() + " latency",
+                                  COMMITS, latencies});
+                }
+            }
+
+        }
+
+        void asyncWriterSuite() {
+            TreeMap<int, int> map;
+            std::mt19937 generator(42);
+            for (std::size_t i = 0; i < ELEMENTS; ++i) {
+                map[static_cast<int>(generator())] = static_cast<int>(i);
+            }
+            snapshots(map);
+            logCommits();
+        }
+
+    }
+}
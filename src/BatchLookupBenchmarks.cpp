@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ELEMENTS = 65536;
+
+            int makeKey(std::mt19937 &generator, int) {
+                return static_cast<int>(generator());
+            }
+
+            // long shared prefixes make every comparison expensive
+            std::string makeKey(std::mt19937 &generator, const std::string &) {
+                return "customer/" + std::string(32, 'x') + std::to_string(generator());
+            }
+
+            template<typename Key>
+            void compareAt(const std::string &type, std::size_t stride) {
+                std::mt19937 generator(11);
+                TreeMap<Key, int> tree;
+                std::vector<Key> keys;
+                for (std::size_t i = 0; i < ELEMENTS; ++i) {
+                    keys.push_back(makeKey(generator, Key()));
+                    tree[keys.back()] = static_cast<int>(i);
+                }
+                std::sort(keys.begin(), keys.end());
+                std::vector<Key> probes;
+                for (std::size_t i = 0; i < keys.size(); i += stride) {
+                    probes.push_back(keys[i]);
+                }
+                const auto suffix = " " + type + " k=n/" + std::to_string(stride);
+                // warm-up, so the first measurement does not pay for a cold tree alone
+                for (const auto &key : probes) {
+                    consume(static_cast<std::size_t>(tree.find(key)->second));
+                }
+
+                report(measure("batch", "find per key" + suffix, probes.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (const auto &key : probes) {
+                        sum += static_cast<std::size_t>(tree.find(key)->second);
+                    }
+                    consume(sum);
+                }));
+
+                std::vector<typename TreeMap<Key, int>::const_iterator> found;
+                found.reserve(probes.size());
+                report(measure("batch", "findSorted sorted" + suffix, probes.size(), [&]() {
+                    tree.findSorted(probes.begin(), probes.end(), std::back_inserter(found));
+                    consume(found.size());
+                }));
+
+                std::shuffle(probes.begin(), probes.end(), generator);
+                found.clear();
+                report(measure("batch", "findSorted shuffled" + suffix, probes.size(), [&]() {
+                    tree.findSorted(probes.begin(), probes.end(), std::back_inserter(found));
+                    consume(found.size());
+                }));
+            }
+
+        }
+
+        void batchLookupSuite() {
+            for (std::size_t stride = 1; stride <= 256; stride *= 16) {
+                compareAt<int>("int", stride);
+                compareAt<std::string>("string", stride);
+            }
+        }
+
+    }
+}
@@ -0,0 +1,652 @@
+#ifndef AISDI_MAPS_BETREEMAP_H
+#define AISDI_MAPS_BETREEMAP_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace aisdi {
+
+    /**
+     * Write-optimized ordered map (B-epsilon tree).
+     *
+     * Leaves hold sorted key and value arrays; internal nodes hold pivots, children and a buffer of
+     * pending updates. insert() and remove() only add a message to the root buffer. A full buffer
+     * moves the messages of its busiest child one level down in a single batch, so a message is
+     * copied O(log n) times but each root-to-leaf descent is shared by many updates.
+     *
+     * Point lookups check the buffers on their way down. Iteration, getSize() and find() need
+     * every update applied, so they first flush all buffers to the leaves. That flush happens
+     * in const methods too, which makes concurrent const use unsafe.
+     *
+     * Deletions leave leaves underfull rather than merging them.
+     */
+    template<typename KeyType, typename ValueType>
+    class BeTreeMap {
+        static const std::size_t LEAF_CAPACITY = 128;
+        static const std::size_t FANOUT = 16;
+        static const std::size_t BUFFER_CAPACITY = 256;
+
+    public:
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+        using reference = std::pair<const key_type &, mapped_type &>;
+        using const_reference = std::pair<const key_type &, const mapped_type &>;
+
+        class ConstIterator;
+
+        class Iterator;
+
+        using iterator = Iterator;
+        using const_iterator = ConstIterator;
+
+        BeTreeMap() : root(new Node(true)), size(0), flushed(true) {}
+
+        BeTreeMap(std::initializer_list<value_type> list) : BeTreeMap() {
+            std::for_each(list.begin(), list.end(), [this](const value_type &v) { insert(v.first, v.second); });
+        }
+
+        BeTreeMap(const BeTreeMap &other) : BeTreeMap() {
+            std::for_each(other.begin(), other.end(), [this](const_reference v) { insert(v.first, v.second); });
+        }
+
+        BeTreeMap(BeTreeMap &&other) : root(other.root), size(other.size), flushed(other.flushed) {
+            other.root = new Node(true);
+            other.size = 0;
+            other.flushed = true;
+        }
+
+        ~BeTreeMap() {
+            destroy(root);
+        }
+
+        BeTreeMap &operator=(const BeTreeMap &other) {
+            if (this == &other) {
+                return *this;
+            }
+            BeTreeMap copy(other);
+            std::swap(root, copy.root);
+            std::swap(size, copy.size);
+            std::swap(flushed, copy.flushed);
+            return *this;
+        }
+
+        BeTreeMap &operator=(BeTreeMap &&other) {
+            if (this == &other) {
+                return *this;
+            }
+            std::swap(root, other.root);
+            std::swap(size, other.size);
+            std::swap(flushed, other.flushed);
+            return *this;
+        }
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        /**
+         * Buffered upsert - the cheap way of writing.
+         */
+        void insert(const key_type &key, const mapped_type &value) {
+            send(key, Message{false, value});
+        }
+
+        /**
+         * Unlike insert(), has to look the key up first to return a reference. The reference
+         * is valid until the next modification.
+         */
+        mapped_type &operator[](const key_type &key) {
+            auto current = findValue(key);
+            if (current == nullptr) {
+                insert(key, mapped_type{});
+            } else if (!root->leaf) {
+                // promote to the root buffer, the returned reference points there
+                insert(key, mapped_type(*current));
+            } else {
+                return *current;
+            }
+            return *findValue(key);
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            auto value = findValue(key);
+            if (value == nullptr) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            return *value;
+        }
+
+        mapped_type &valueOf(const key_type &key) {
+            return const_cast<mapped_type &>(static_cast<const BeTreeMap &>(*this).valueOf(key));
+        }
+
+        const_iterator find(const key_type &key) const {
+            flushAll();
+            auto leaf = root;
+            while (!leaf->leaf) {
+                leaf = leaf->children[childIndex(*leaf, key)];
+            }
+            const auto position = lowerBound(leaf->keys, key);
+            if (position == leaf->keys.size() || leaf->keys[position] != key) {
+                return cend();
+            }
+            return const_iterator(*this, leaf, position);
+        }
+
+        iterator find(const key_type &key) {
+            return iterator(static_cast<const BeTreeMap &>(*this).find(key));
+        }
+
+        void remove(const key_type &key) {
+            if (findValue(key) == nullptr) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            send(key, Message{true, mapped_type{}});
+        }
+
+        void remove(const const_iterator &it) {
+            if (it == end()) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            remove(it->first);
+        }
+
+        size_type getSize() const {
+            flushAll();
+            return size;
+        }
+
+        bool operator==(const BeTreeMap &other) const {
+            if (getSize() != other.getSize()) {
+                return false;
+            }
+            return std::equal(begin(), end(), other.begin(), [](const_reference a, const_reference b) {
+                return a.first == b.first && a.second == b.second;
+            });
+        }
+
+        bool operator!=(const BeTreeMap &other) const {
+            return !(*this == other);
+        }
+
+        iterator begin() {
+            return iterator(cbegin());
+        }
+
+        iterator end() {
+            return iterator(cend());
+        }
+
+        const_iterator cbegin() const {
+            flushAll();
+            auto leaf = root;
+            while (!leaf->leaf) {
+                leaf = leaf->children.front();
+            }
+            return const_iterator(*this, leaf, 0).skipEmptyLeaves();
+        }
+
+        // flushed too, as decrementing end() starts from the last leaf
+        const_iterator cend() const {
+            flushAll();
+            return const_iterator(*this, nullptr, 0);
+        }
+
+        const_iterator begin() const {
+            return cbegin();
+        }
+
+        const_iterator end() const {
+            return cend();
+        }
+
+    private:
+        struct Message {
+            bool erase;
+            mapped_type value;
+        };
+
+        struct Node {
+            explicit Node(bool leaf) : leaf(leaf), previousLeaf(nullptr), nextLeaf(nullptr) {}
+
+            bool leaf;
+
+            // leaf nodes
+            std::vector<key_type> keys;
+            std::vector<mapped_type> values;
+            Node *previousLeaf;
+            Node *nextLeaf;
+
+            // internal nodes: children[i] holds keys in [pivots[i - 1], pivots[i])
+            std::vector<key_type> pivots;
+            std::vector<Node *> children;
+            // sorted by key, at most one message per key
+            std::vector<std::pair<key_type, Message>> buffer;
+
+            bool overflows() const {
+                return leaf ? keys.size() > LEAF_CAPACITY : children.size() > FANOUT;
+            }
+        };
+
+        using node_pointer = Node *;
+        using buffer_type = std::vector<std::pair<key_type, Message>>;
+        using buffer_iterator = typename buffer_type::iterator;
+
+        mutable node_pointer root;
+        mutable size_type size;
+        // no message waits in any buffer
+        mutable bool flushed;
+
+        static void destroy(node_pointer node) {
+            for (auto child : node->children) {
+                destroy(child);
+            }
+            delete node;
+        }
+
+        static size_type lowerBound(const std::vector<key_type> &keys, const key_type &key) {
+            return static_cast<size_type>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+        }
+
+        static buffer_iterator bufferLowerBound(buffer_type &buffer, const key_type &key) {
+            return std::lower_bound(buffer.begin(), buffer.end(), key,
+                                    [](const std::pair<key_type, Message> &message, const key_type &k) {
+                                        return message.first < k;
+                                    });
+        }
+
+        static size_type childIndex(const Node &node, const key_type &key) {
+            return static_cast<size_type>(std::upper_bound(node.pivots.begin(), node.pivots.end(), key) -
+                                          node.pivots.begin());
+        }
+
+        /**
+         * Newest state of the key: buffers closer to the root hold newer messages.
+         */
+        mapped_type *findValue(const key_type &key) const {
+            node_pointer node = root;
+            while (!node->leaf) {
+                auto message = bufferLowerBound(node->buffer, key);
+                if (message != node->buffer.end() && !(key < message->first)) {
+                    return message->second.erase ? nullptr : &message->second.value;
+                }
+                node = node->children[childIndex(*node, key)];
+            }
+            const auto position = lowerBound(node->keys, key);
+            if (position == node->keys.size() || node->keys[position] != key) {
+                return nullptr;
+            }
+            return &node->values[position];
+        }
+
+        void send(const key_type &key, const Message &message) {
+            if (root->leaf) {
+                std::vector<std::pair<key_type, Message>> batch{std::make_pair(key, message)};
+                applyToLeaf(*root, batch.begin(), batch.end());
+            } else {
+                flushed = false;
+                auto position = bufferLowerBound(root->buffer, key);
+                if (position != root->buffer.end() && !(key < position->first)) {
+                    position->second = message;
+                } else {
+                    root->buffer.insert(position, std::make_pair(key, message));
+                }
+                if (root->buffer.size() > BUFFER_CAPACITY) {
+                    flushLargestGroup(*root);
+                }
+            }
+            growIfRootOverflows();
+        }
+
+        void growIfRootOverflows() const {
+            while (root->overflows()) {
+                auto newRoot = new Node(false);
+                newRoot->children.push_back(root);
+                root = newRoot;
+                splitChild(*root, 0);
+            }
+        }
+
+        /**
+         * Merges sorted messages into the leaf in one pass, keeping size up to date.
+         */
+        template<typename MessageIterator>
+        void applyToLeaf(Node &leaf, MessageIterator first, MessageIterator last) const {
+            std::vector<key_type> keys;
+            std::vector<mapped_type> values;
+            keys.reserve(leaf.keys.size() + static_cast<size_type>(std::distance(first, last)));
+            values.reserve(keys.capacity());
+
+            size_type stored = 0;
+            for (; first != last; ++first) {
+                while (stored < leaf.keys.size() && leaf.keys[stored] < first->first) {
+                    keys.push_back(std::move(leaf.keys[stored]));
+                    values.push_back(std::move(leaf.values[stored]));
+                    ++stored;
+                }
+                const bool present = stored < leaf.keys.size() && !(first->first < leaf.keys[stored]);
+                if (present) {
+                    ++stored;
+                }
+                if (first->second.erase) {
+                    size -= present ? 1 : 0;
+                } else {
+                    size += present ? 0 : 1;
+                    keys.push_back(first->first);
+                    values.push_back(first->second.value);
+                }
+            }
+            std::move(leaf.keys.begin() + stored, leaf.keys.end(), std::back_inserter(keys));
+            std::move(leaf.values.begin() + stored, leaf.values.end(), std::back_inserter(values));
+            leaf.keys.swap(keys);
+            leaf.values.swap(values);
+        }
+
+        /**
+         * Messages coming from above are newer, they replace pending ones for the same key.
+         */
+        static void mergeIntoBuffer(buffer_type &buffer, buffer_iterator first, buffer_iterator last) {
+            buffer_type merged;
+            merged.reserve(buffer.size() + static_cast<size_type>(last - first));
+            auto pending = buffer.begin();
+            for (; first != last; ++first) {
+                while (pending != buffer.end() && pending->first < first->first) {
+                    merged.push_back(std::move(*pending++));
+                }
+                if (pending != buffer.end() && !(first->first < pending->first)) {
+                    ++pending;
+                }
+                merged.push_back(std::move(*first));
+            }
+            std::move(pending, buffer.end(), std::back_inserter(merged));
+            buffer.swap(merged);
+        }
+
+        /**
+         * Moves the messages bound for the child that has the most of them.
+         */
+        void flushLargestGroup(Node &node) const {
+            size_type best = 0;
+            size_type bestCount = 0;
+            auto message = node.buffer.begin();
+            for (size_type child = 0; child < node.children.size() && message != node.buffer.end(); ++child) {
+                size_type count = 0;
+                while (message != node.buffer.end() &&
+                       (child == node.pivots.size() || message->first < node.pivots[child])) {
+                    ++message;
+                    ++count;
+                }
+                if (count > bestCount) {
+                    best = child;
+                    bestCount = count;
+                }
+            }
+            flushChild(node, best);
+        }
+
+        void flushChild(Node &node, size_type index) const {
+            auto first = index == 0 ? node.buffer.begin() : bufferLowerBound(node.buffer, node.pivots[index - 1]);
+            auto last = index == node.pivots.size() ? node.buffer.end()
+                                                    : bufferLowerBound(node.buffer, node.pivots[index]);
+            if (first == last) {
+                return;
+            }
+
+            auto &child = *node.children[index];
+            if (child.leaf) {
+                applyToLeaf(child, first, last);
+            } else {
+                mergeIntoBuffer(child.buffer, first, last);
+                while (child.buffer.size() > BUFFER_CAPACITY) {
+                    flushLargestGroup(child);
+                }
+            }
+            node.buffer.erase(first, last);
+            splitChild(node, index);
+        }
+
+        /**
+         * Splits an overflowing child into as many evenly filled siblings as needed.
+         */
+        void splitChild(Node &node, size_type index) const {
+            auto &child = *node.children[index];
+            if (!child.overflows()) {
+                return;
+            }
+            const auto length = child.leaf ? child.keys.size() : child.children.size();
+            const auto capacity = child.leaf ? LEAF_CAPACITY : FANOUT;
+            const auto pieces = (length + capacity - 1) / capacity;
+
+            std::vector<node_pointer> siblings;
+            std::vector<key_type> separators;
+            for (size_type piece = pieces - 1; piece > 0; --piece) {
+                const auto from = length * piece / pieces;
+                const auto to = length * (piece + 1) / pieces;
+                auto sibling = new Node(child.leaf);
+                if (child.leaf) {
+                    separators.push_back(child.keys[from]);
+                    sibling->keys.assign(std::make_move_iterator(child.keys.begin() + from),
+                                         std::make_move_iterator(child.keys.begin() + to));
+                    sibling->values.assign(std::make_move_iterator(child.values.begin() + from),
+                                           std::make_move_iterator(child.values.begin() + to));
+                } else {
+                    separators.push_back(child.pivots[from - 1]);
+                    sibling->children.assign(child.children.begin() + from, child.children.begin() + to);
+                    sibling->pivots.assign(child.pivots.begin() + from, child.pivots.begin() + (to - 1));
+                    auto messages = bufferLowerBound(child.buffer, separators.back());
+                    auto messagesEnd = to == length ? child.buffer.end()
+                                                    : bufferLowerBound(child.buffer, child.pivots[to - 1]);
+                    sibling->buffer.assign(std::make_move_iterator(messages), std::make_move_iterator(messagesEnd));
+                    child.buffer.erase(messages, messagesEnd);
+                }
+                siblings.push_back(sibling);
+            }
+
+            const auto kept = length / pieces;
+            if (child.leaf) {
+                child.keys.resize(kept);
+                child.values.resize(kept);
+                // link leaves left to right: child, siblings in reverse order of creation
+                auto previous = &child;
+                auto following = child.nextLeaf;
+                for (auto sibling = siblings.rbegin(); sibling != siblings.rend(); ++sibling) {
+                    (*sibling)->previousLeaf = previous;
+                    previous->nextLeaf = *sibling;
+                    previous = *sibling;
+                }
+                previous->nextLeaf = following;
+                if (following != nullptr) {
+                    following->previousLeaf = previous;
+                }
+            } else {
+                child.children.resize(kept);
+                child.pivots.resize(kept - 1);
+            }
+
+            node.children.insert(node.children.begin() + index + 1, siblings.rbegin(), siblings.rend());
+            node.pivots.insert(node.pivots.begin() + index, separators.rbegin(), separators.rend());
+        }
+
+        node_pointer lastLeaf() const {
+            auto leaf = root;
+            while (!leaf->leaf) {
+                leaf = leaf->children.back();
+            }
+            return leaf;
+        }
+
+        /**
+         * Applies every pending message, leaving all buffers empty.
+         */
+        void flushAll() const {
+            if (flushed) {
+                return;
+            }
+            flushSubtree(*root);
+            growIfRootOverflows();
+            flushed = true;
+        }
+
+        void flushSubtree(Node &node) const {
+            if (node.leaf) {
+                return;
+            }
+            for (size_type index = 0; index < node.children.size(); ++index) {
+                flushChild(node, index);
+            }
+            // splits only add siblings to the right, the ones already visited stay flushed
+            for (size_type index = 0; index < node.children.size(); ++index) {
+                flushSubtree(*node.children[index]);
+                splitChild(node, index);
+            }
+        }
+    };
+
+    template<typename KeyType, typename ValueType>
+    class BeTreeMap<KeyType, ValueType>::ConstIterator {
+    public:
+        using reference = typename BeTreeMap::const_reference;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename BeTreeMap::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        template<typename Pair>
+        struct ArrowProxy {
+            Pair pair;
+
+            const Pair *operator->() const {
+                return &pair;
+            }
+        };
+
+        using pointer = ArrowProxy<reference>;
+
+        friend class BeTreeMap;
+
+        ConstIterator &operator++() {
+            if (leaf == nullptr) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            ++index;
+            return skipEmptyLeaves();
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        ConstIterator &operator--() {
+            auto previousLeaf = leaf;
+            auto previousIndex = index;
+            if (previousLeaf == nullptr) {
+                previousLeaf = parent->lastLeaf();
+                previousIndex = previousLeaf->keys.size();
+            }
+            while (previousIndex == 0) {
+                previousLeaf = previousLeaf->previousLeaf;
+                if (previousLeaf == nullptr) {
+                    throw std::out_of_range("Iterator out of range");
+                }
+                previousIndex = previousLeaf->keys.size();
+            }
+            leaf = previousLeaf;
+            index = previousIndex - 1;
+            return *this;
+        }
+
+        ConstIterator operator--(int) {
+            ConstIterator ret = *this;
+            --*this;
+            return ret;
+        }
+
+        reference operator*() const {
+            if (leaf == nullptr) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            return reference(leaf->keys[index], leaf->values[index]);
+        }
+
+        pointer operator->() const {
+            return pointer{this->operator*()};
+        }
+
+        bool operator==(const ConstIterator &other) const {
+            return leaf == other.leaf && index == other.index;
+        }
+
+        bool operator!=(const ConstIterator &other) const {
+            return !(*this == other);
+        }
+
+    protected:
+        ConstIterator(const BeTreeMap &parent, node_pointer leaf, size_type index) : parent(&parent), leaf(leaf),
+                                                                                     index(index) {}
+
+        ConstIterator &skipEmptyLeaves() {
+            while (leaf != nullptr && index == leaf->keys.size()) {
+                leaf = leaf->nextLeaf;
+                index = 0;
+            }
+            return *this;
+        }
+
+        const BeTreeMap *parent;
+        node_pointer leaf;
+        size_type index;
+    };
+
+    template<typename KeyType, typename ValueType>
+    class BeTreeMap<KeyType, ValueType>::Iterator : public BeTreeMap<KeyType, ValueType>::ConstIterator {
+    public:
+        using reference = typename BeTreeMap::reference;
+        using pointer = typename ConstIterator::template ArrowProxy<reference>;
+
+        Iterator(const ConstIterator &other)
+                : ConstIterator(other) {}
+
+        Iterator &operator++() {
+            ConstIterator::operator++();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto result = *this;
+            ConstIterator::operator++();
+            return result;
+        }
+
+        Iterator &operator--() {
+            ConstIterator::operator--();
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            auto result = *this;
+            ConstIterator::operator--();
+            return result;
+        }
+
+        pointer operator->() const {
+            return pointer{this->operator*()};
+        }
+
+        reference operator*() const {
+            const auto entry = ConstIterator::operator*();
+            // ugly cast, yet reduces code duplication.
+            return reference(entry.first, const_cast<mapped_type &>(entry.second));
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_BETREEMAP_H */
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BeTreeMap.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            template<typename Map, typename Insert>
+            void ingest(const std::string &name, const std::vector<int> &keys, Insert insert) {
+                Map map;
+                report(measure("betree", "insert " + name, keys.size(), [&]() {
+                    for (auto key : keys) {
+                        insert(map, key);
+                    }
+                    // pending BeTreeMap messages count as part of the ingest
+                    consume(map.getSize());
+                }));
+
+                report(measure("betree", "lookup " + name, keys.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (auto key : keys) {
+                        sum += static_cast<std::size_t>(map.valueOf(key));
+                    }
+                    consume(sum);
+                }));
+            }
+
+        }
+
+        void beTreeMapSuite() {
+            for (std::size_t elements : {100000u, 1000000u}) {
+                std::mt19937 generator(static_cast<unsigned>(elements));
+                std::vector<int> keys(elements);
+                std::generate(keys.begin(), keys.end(), [&generator]() { return static_cast<int>(generator()); });
+                const auto suffix = " n=" + std::to_string(elements);
+
+                ingest<TreeMap<int, int>>("TreeMap operator[]" + suffix, keys,
+                                          [](TreeMap<int, int> &map, int key) { map[key] = key; });
+                ingest<BeTreeMap<int, int>>("BeTreeMap insert" + suffix, keys,
+                                            [](BeTreeMap<int, int> &map, int key) { map.insert(key, key); });
+                ingest<BeTreeMap<int, int>>("BeTreeMap operator[]" + suffix, keys,
+                                            [](BeTreeMap<int, int> &map, int key) { map[key] = key; });
+            }
+        }
+
+    }
+}
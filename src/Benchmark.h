@@ -0,0 +1,148 @@
+#ifndef AISDI_MAPS_BENCHMARK_H
+#define AISDI_MAPS_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "AllocationCounter.h"
+#include "Timeline.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        /**
+         * Entries in HashMap workloads. HashMap has a fixed number of buckets, so its lookups walk
+         * chains growing with its size, and larger maps would measure little but those walks.
+         */
+        const std::size_t HASH_MAP_ELEMENTS = 20000;
+
+        struct Result {
+            std::string suite;
+            std::string name;
+            std::size_t operations;
+            double nanoseconds;
+            // heap allocations while measuring, known when allocation tracking is linked in
+            bool allocationsCounted;
+            std::uint64_t allocations;
+            std::uint64_t allocatedBytes;
+
+            Result(const std::string &suite, const std::string &name, std::size_t operations, double nanoseconds)
+                    : suite(suite), name(name), operations(operations), nanoseconds(nanoseconds),
+                      allocationsCounted(false), allocations(0), allocatedBytes(0) {}
+
+            double nanosecondsPerOperation() const {
+                return operations == 0 ? 0.0 : nanoseconds / operations;
+            }
+
+            double allocationsPerOperation() const {
+                return operations == 0 ? 0.0 : static_cast<double>(allocations) / operations;
+            }
+
+            double bytesPerOperation() const {
+                return operations == 0 ? 0.0 : static_cast<double>(allocatedBytes) / operations;
+            }
+        };
+
+        class Stopwatch {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            Stopwatch() : start(clock::now()) {}
+
+            double elapsedNanoseconds() const {
+                return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            }
+
+        private:
+            clock::time_point start;
+        };
+
+        /**
+         * Keeps the optimizer from discarding results of measured code.
+         */
+        inline void consume(std::size_t value) {
+            static volatile std::size_t sink = 0;
+            sink = sink ^ value;
+        }
+
+        template<typename Operation>
+        Result measure(const std::string &suite, const std::string &name, std::size_t operations,
+                       Operation operation) {
+            // opened first, so its name is not counted as allocated by the operation
+            TimelineSpan span("measure", suite + " " + name);
+            const auto allocationsBefore = AllocationSnapshot::now();
+            Stopwatch stopwatch;
+            operation();
+            Result result{suite, name, operations, stopwatch.elapsedNanoseconds()};
+            if (isAllocationTrackingInstalled()) {
+                const auto allocated = AllocationSnapshot::now() - allocationsBefore;
+                result.allocationsCounted = true;
+                result.allocations = allocated.allocations;
+                result.allocatedBytes = allocated.bytes;
+            }
+            return result;
+        }
+
+        inline void report(const Result &result) {
+            std::cout << std::left << std::setw(12) << result.suite
+                      << std::setw(48) << result.name
+                      << std::right << std::setw(12) << result.operations << " ops"
+                      << std::fixed << std::setprecision(2) << std::setw(12)
+                      << result.nanosecondsPerOperation() << " ns/op";
+            if (result.allocationsCounted) {
+                std::cout << std::setw(10) << result.allocationsPerOperation() << " allocs/op"
+                          << std::setw(12) << result.bytesPerOperation() << " B/op";
+            }
+            std::cout << std::endl;
+        }
+
+        void samplingSuite();
+
+        void cloneSuite();
+
+        void reclamationSuite();
+
+        void flatTreeMapSuite();
+
+        void beTreeMapSuite();
+
+        void anyMapSuite();
+
+        void adaptiveMapSuite();
+
+        void snapshotSuite();
+
+        void asyncWriterSuite();
+
+        void memorySuite();
+
+        void batchLookupSuite();
+
+        void joinSuite();
+
+        void traceSuite();
+
+        void comparisonSuite();
+
+        void contentionSuite();
+
+        /**
+         * Sweeps map sizes across the detected cache levels and writes ns/op and misses/op as CSV
+         * to the file, or to standard output for an empty path. Returns the process exit code.
+         */
+        int sweep(const std::string &path);
+
+        /**
+         * Replays a trace written by TraceWriter against one engine and reports per-operation
+         * timing. Returns the process exit code.
+         */
+        int replay(const std::string &engine, const std::string &path);
+
+    }
+}
+
+#endif /* AISDI_MAPS_BENCHMARK_H */
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "HashMap.h"
+#include "PerformanceCounter.h"
+#include "Timeline.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t OPERATIONS = 200000;
+            const std::size_t MIN_WORKING_SET = 4 * 1024;
+            const std::size_t MAX_WORKING_SET = std::size_t(512) * 1024 * 1024;
+            // past this, HashMap lookups are dominated by chain walks rather than cache misses
+            const std::size_t MAX_HASH_ELEMENTS = 32768;
+            const std::size_t ENTRY_SAMPLE = 4096;
+
+            struct CacheLevel {
+                unsigned level;
+                std::size_t bytes;
+            };
+
+            bool readFirstLine(const std::string &path, std::string &line) {
+                std::ifstream in(path);
+                return static_cast<bool>(std::getline(in, line));
+            }
+
+            /**
+             * Parses sysfs cache sizes such as "48K" or "2048K".
+             */
+            std::size_t parseSize(const std::string &text) {
+                std::istringstream in(text);
+                std::size_t value = 0;
+                char unit = 0;
+                in >> value >> unit;
+                switch (unit) {
+                    case 'K':
+                        return value * 1024;
+                    case 'M':
+                        return value * 1024 * 1024;
+                    case 'G':
+                        return value * 1024 * 1024 * 1024;
+                    default:
+                        return value;
+                }
+            }
+
+            /**
+             * Data and unified caches of the first CPU, smallest level first. Falls back to
+             * sysconf where sysfs does not describe them.
+             */
+            std::vector<CacheLevel> detectCaches() {
+                std::vector<CacheLevel> caches;
+                for (unsigned index = 0;; ++index) {
+                    const auto directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+                    std::string level, type, size;
+                    if (!readFirstLine(directory + "level", level) || !readFirstLine(directory + "type", type) ||
+                        !readFirstLine(directory + "size", size)) {
+                        break;
+                    }
+                    if (type != "Instruction") {
+                        caches.push_back(CacheLevel{static_cast<unsigned>(std::stoul(level)), parseSize(size)});
+                    }
+                }
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+                if (caches.empty()) {
+                    const long sizes[] = {sysconf(_SC_LEVEL1_DCACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE),
+                                          sysconf(_SC_LEVEL3_CACHE_SIZE)};
+                    for (unsigned level = 1; level <= 3; ++level) {
+                        if (sizes[level - 1] > 0) {
+                            caches.push_back(CacheLevel{level, static_cast<std::size_t>(sizes[level - 1])});
+                        }
+                    }
+                }
+#endif
+                std::sort(caches.begin(), caches.end(), [](const CacheLevel &a, const CacheLevel &b) {
+                    return a.level < b.level;
+                });
+                return caches;
+            }
+
+            std::string residence(const std::vector<CacheLevel> &caches, std::size_t bytes) {
+                for (const auto &cache : caches) {
+                    if (bytes <= cache.bytes) {
+                        return "L" + std::to_string(cache.level);
+                    }
+                }
+                return "DRAM";
+            }
+
+            /**
+             * Working set sizes around every cache boundary, plus one well beyond the last level.
+             */
+            std::vector<std::size_t> workingSets(const std::vector<CacheLevel> &caches) {
+                std::vector<std::size_t> sizes;
+                for (const auto &cache : caches) {
+                    sizes.push_back(cache.bytes / 2);
+                    sizes.push_back(cache.bytes * 3 / 4);
+                    sizes.push_back(cache.bytes);
+                    sizes.push_back(cache.bytes * 3 / 2);
+                    sizes.push_back(cache.bytes * 2);
+                }
+                if (!caches.empty()) {
+                    sizes.push_back(caches.back().bytes * 4);
+                }
+                sizes.erase(std::remove_if(sizes.begin(), sizes.end(), [](std::size_t size) {
+                    return size < MIN_WORKING_SET || size > MAX_WORKING_SET;
+                }), sizes.end());
+                std::sort(sizes.begin(), sizes.end());
+                sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+                return sizes;
+            }
+
+            class Probe {
+            public:
+                Probe() : l1Misses(EventCounter::Event::L1DataMisses),
+                          lastLevelMisses(EventCounter::Event::LastLevelMisses) {}
+
+                /**
+                 * Runs the operation once and writes time and misses per operation as CSV
+                 * fields; miss fields stay empty where perf events are unavailable.
+                 */
+                template<typename Operation>
+                std::string run(const std::string &name, std::size_t operations, Operation operation) {
+                    TimelineSpan span("measure", name);
+                    l1Misses.start();
+                    lastLevelMisses.start();
+                    Stopwatch stopwatch;
+                    operation();
+                    const auto nanoseconds = stopwatch.elapsedNanoseconds();
+                    const auto l1 = l1Misses.stop();
+                    const auto lastLevel = lastLevelMisses.stop();
+
+                    std::ostringstream fields;
+                    fields << nanoseconds / operations << ',';
+                    if (l1Misses.isAvailable()) {
+                        fields << static_cast<double>(l1) / operations;
+                    }
+                    fields << ',';
+                    if (lastLevelMisses.isAvailable()) {
+                        fields << static_cast<double>(lastLevel) / operations;
+                    }
+                    return fields.str();
+                }
+
+                bool isAvailable() const {
+                    return l1Misses.isAvailable() || lastLevelMisses.isAvailable();
+                }
+
+            private:
+                EventCounter l1Misses;
+                EventCounter lastLevelMisses;
+            };
+
+            template<typename Map>
+            std::size_t heapBytesPerEntry() {
+                const auto before = AllocationSnapshot::now();
+                Map map;
+                for (std::size_t i = 0; i < ENTRY_SAMPLE; ++i) {
+                    map[static_cast<int>(i)] = 0;
+                }
+                const auto allocated = (AllocationSnapshot::now() - before).bytes / ENTRY_SAMPLE;
+                // without allocation tracking, guess the entry plus three pointers
+                return allocated > 0 ? allocated : sizeof(typename Map::value_type) + 3 * sizeof(void *);
+            }
+
+            template<typename Map>
+            void sweepMap(const std::string &structure, std::size_t maxElements, const std::vector<CacheLevel> &caches,
+                          std::ostream &csv) {
+                const auto entryBytes = heapBytesPerEntry<Map>();
+                std::mt19937 generator(42);
+                Probe probe;
+                for (auto target : workingSets(caches)) {
+                    const auto elements = target / entryBytes;
+                    if (elements > maxElements) {
+                        std::cerr << structure << " stops at " << maxElements << " elements" << std::endl;
+                        break;
+                    }
+
+                    // even keys are stored, odd keys miss
+                    std::vector<int> keys(elements);
+                    for (std::size_t i = 0; i < elements; ++i) {
+                        keys[i] = static_cast<int>(i * 2);
+                    }
+                    std::shuffle(keys.begin(), keys.end(), generator);
+                    std::vector<int> probes(OPERATIONS);
+                    for (auto &key : probes) {
+                        key = keys[generator() % elements];
+                    }
+
+                    // small maps are built several times for a measurable run
+                    const auto builds = std::max<std::size_t>(1, OPERATIONS / elements);
+                    std::vector<Map> built(builds);
+                    const auto before = AllocationSnapshot::now();
+                    const auto prefix = structure + ',';
+                    const auto suffix = ',' + std::to_string(elements) + ',';
+                    const auto insert = probe.run(prefix + "insert" + suffix, builds * elements, [&]() {
+                        for (auto &map : built) {
+                            for (auto key : keys) {
+                                map[key] = key;
+                            }
+                        }
+                    });
+                    const auto workingSet = (AllocationSnapshot::now() - before).bytes / builds;
+                    built.resize(1);
+                    const auto &map = built.front();
+
+                    const auto hit = probe.run(prefix + "lookup hit" + suffix, OPERATIONS, [&]() {
+                        std::size_t sum = 0;
+                        for (auto key : probes) {
+                            sum += static_cast<std::size_t>(map.find(key)->second);
+                        }
+                        consume(sum);
+                    });
+                    const auto miss = probe.run(prefix + "lookup miss" + suffix, OPERATIONS, [&]() {
+                        std::size_t found = 0;
+                        for (auto key : probes) {
+                            found += map.find(key + 1) != map.end();
+                        }
+                        consume(found);
+                    });
+                    const auto passes = std::max<std::size_t>(1, OPERATIONS / elements);
+                    const auto iterate = probe.run(prefix + "iterate" + suffix, passes * elements, [&]() {
+                        std::size_t sum = 0;
+                        for (std::size_t pass = 0; pass < passes; ++pass) {
+                            for (const auto &entry : map) {
+                                sum += static_cast<std::size_t>(entry.second);
+                            }
+                        }
+                        consume(sum);
+                    });
+
+                    const auto columns = suffix + std::to_string(workingSet) + ',' + residence(caches, workingSet) + ',';
+                    csv << prefix << "insert" << columns << insert << std::endl
+                        << prefix << "lookup hit" << columns << hit << std::endl
+                        << prefix << "lookup miss" << columns << miss << std::endl
+                        << prefix << "iterate" << columns << iterate << std::endl;
+
+                    TimelineSpan teardown("phase", "teardown");
+                    built.clear();
+                }
+            }
+
+        }
+
+        int sweep(const std::string &path) {
+            std::ofstream file;
+            if (!path.empty()) {
+                file.open(path);
+                if (!file) {
+                    std::cerr << "cannot write " << path << std::endl;
+                    return 1;
+                }
+            }
+            std::ostream &csv = path.empty() ? std::cout : file;
+
+            const auto caches = detectCaches();
+            for (const auto &cache : caches) {
+                std::cerr << "L" << cache.level << " cache " << cache.bytes / 1024 << " KiB" << std::endl;
+            }
+            if (caches.empty()) {
+                std::cerr << "cache sizes unknown, nothing to sweep" << std::endl;
+                return 1;
+            }
+            if (!Probe().isAvailable()) {
+                std::cerr << "perf events unavailable, miss columns stay empty" << std::endl;
+            }
+
+            csv << "structure,operation,elements,working_set_bytes,fits_in,ns_per_op,l1d_misses_per_op,"
+                   "llc_misses_per_op" << std::endl;
+            sweepMap<TreeMap<int, int>>("TreeMap", std::numeric_limits<std::size_t>::max(), caches, csv);
+            sweepMap<HashMap<int, int>>("HashMap", MAX_HASH_ELEMENTS, caches, csv);
+            return csv ? 0 : 1;
+        }
+
+    }
+}
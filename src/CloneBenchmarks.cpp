@@ -0,0 +1,86 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "Benchmark.h"
+#include "ThreadPool.h"
+#include "Timeline.h"
+#include "TreeMap.h"
+#include "HashMap.h"
+#include "MapConversion.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ELEMENTS = 200000;
+
+            template<typename Map>
+            void cloneMap(const std::string &mapName) {
+                Map map;
+                {
+                    TimelineSpan span("phase", "build");
+                    std::mt19937 generator(42);
+                    for (std::size_t i = 0; i < ELEMENTS; ++i) {
+                        map[static_cast<int>(generator())] = static_cast<int>(i);
+                    }
+                }
+
+                report(measure("clone", "copy constructor " + mapName, map.getSize(), [&]() {
+                    Map copy{map};
+                    consume(copy.getSize());
+                }));
+
+                for (std::size_t threads : {1u, 2u, 4u, 8u}) {
+                    ThreadPool pool(threads);
+                    report(measure("clone", "clone " + mapName + " threads=" + std::to_string(threads),
+                                   map.getSize(), [&]() {
+                                Map copy = map.clone(pool);
+                                consume(copy.getSize());
+                            }));
+                }
+            }
+
+            void convertMaps() {
+                HashMap<int, std::string> hashMap;
+                std::mt19937 generator(42);
+                while (hashMap.getSize() < HASH_MAP_ELEMENTS) {
+                    hashMap[static_cast<int>(generator())] = std::string(64, 'x');
+                }
+
+                TreeMap<int, std::string> treeCopy;
+                report(measure("clone", "HashMap to TreeMap per entry", hashMap.getSize(), [&]() {
+                    for (const auto &entry : hashMap) {
+                        treeCopy[entry.first] = entry.second;
+                    }
+                }));
+                TreeMap<int, std::string> treeMap;
+                report(measure("clone", "HashMap to TreeMap moving", hashMap.getSize(), [&]() {
+                    treeMap = toTreeMap(std::move(hashMap));
+                }));
+
+                HashMap<int, std::string> hashCopy;
+                report(measure("clone", "TreeMap to HashMap per entry", treeMap.getSize(), [&]() {
+                    for (const auto &entry : treeMap) {
+                        hashCopy[entry.first] = entry.second;
+                    }
+                }));
+                report(measure("clone", "TreeMap to HashMap moving", treeMap.getSize(), [&]() {
+                    hashMap = toHashMap(std::move(treeMap));
+                }));
+                consume(hashMap.getSize() + treeCopy.getSize() + hashCopy.getSize());
+            }
+
+        }
+
+        void cloneSuite() {
+            // first, while the heap is not yet fragmented by the pools' clones
+            convertMaps();
+            cloneMap<TreeMap<int, int>>("TreeMap");
+            cloneMap<HashMap<int, int>>("HashMap");
+        }
+
+    }
+}
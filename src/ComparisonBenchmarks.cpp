@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "HashMap.h"
+#include "ThreadPool.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t TREE_ELEMENTS = 100000;
+            const std::size_t COPIES = 5;
+
+            template<typename Map>
+            std::size_t sizeOf(const Map &map) {
+                return map.getSize();
+            }
+
+            template<typename K, typename V>
+            std::size_t sizeOf(const std::map<K, V> &map) {
+                return map.size();
+            }
+
+            template<typename K, typename V>
+            std::size_t sizeOf(const std::unordered_map<K, V> &map) {
+                return map.size();
+            }
+
+            template<typename K, typename V>
+            void removeKey(TreeMap<K, V> &map, const K &key) {
+                map.remove(key);
+            }
+
+            template<typename K, typename V>
+            void removeKey(HashMap<K, V> &map, const K &key) {
+                map.remove(key);
+            }
+
+            template<typename K, typename V>
+            void removeKey(std::map<K, V> &map, const K &key) {
+                map.erase(key);
+            }
+
+            template<typename K, typename V>
+            void removeKey(std::unordered_map<K, V> &map, const K &key) {
+                map.erase(key);
+            }
+
+            /**
+             * Runs every workload on one map type; keys hit, misses never do.
+             */
+            template<typename Map>
+            std::vector<Result> workloads(const std::string &name, const std::vector<int> &keys,
+                                          const std::vector<int> &misses) {
+                std::vector<Result> results;
+                Map map;
+                results.push_back(measure("compare", name + " insert", keys.size(), [&]() {
+                    for (auto key : keys) {
+                        map[key] = key;
+                    }
+                }));
+                results.push_back(measure("compare", name + " lookup hit", keys.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (auto key : keys) {
+                        sum += static_cast<std::size_t>(map.find(key)->second);
+                    }
+                    consume(sum);
+                }));
+                results.push_back(measure("compare", name + " lookup miss", misses.size(), [&]() {
+                    std::size_t found = 0;
+                    for (auto key : misses) {
+                        found += map.find(key) != map.end();
+                    }
+                    consume(found);
+                }));
+                results.push_back(measure("compare", name + " iterate", keys.size(), [&]() {
+                    std::size_t sum = 0;
+                    for (const auto &entry : map) {
+                        sum += static_cast<std::size_t>(entry.second);
+                    }
+                    consume(sum);
+                }));
+                results.push_back(measure("compare", name + " copy", keys.size() * COPIES, [&]() {
+                    for (std::size_t i = 0; i < COPIES; ++i) {
+                        const Map copy(map);
+                        consume(sizeOf(copy));
+                    }
+                }));
+                // in another order than inserted, or HashMap would find each key at the front of its bucket
+                auto removals = keys;
+                std::mt19937 generator(7);
+                std::shuffle(removals.begin(), removals.end(), generator);
+                results.push_back(measure("compare", name + " remove", removals.size(), [&]() {
+                    for (auto key : removals) {
+                        removeKey(map, key);
+                    }
+                }));
+                for (const auto &result : results) {
+                    report(result);
+                }
+                return results;
+            }
+
+            void printTable(const std::string &ours, const std::string &standard,
+                            const std::vector<Result> &ourResults, const std::vector<Result> &standardResults) {
+                std::cout << std::endl << std::left << std::setw(16) << "workload"
+                          << std::right << std::setw(16) << ours + " ns" << std::setw(20) << standard + " ns"
+                          << std::setw(12) << "relative" << std::setw(14) << ours + " B"
+                          << std::setw(18) << standard + " B" << std::endl;
+                for (std::size_t i = 0; i < ourResults.size(); ++i) {
+                    const auto &our = ourResults[i];
+                    const auto &their = standardResults[i];
+                    std::cout << std::left << std::setw(16) << our.name.substr(our.name.find(' ') + 1)
+                              << std::right << std::fixed << std::setprecision(2)
+                              << std::setw(16) << our.nanosecondsPerOperation()
+                              << std::setw(20) << their.nanosecondsPerOperation()
+                              << std::setw(11) << our.nanosecondsPerOperation() / their.nanosecondsPerOperation() << 'x';
+                    if (our.allocationsCounted) {
+                        std::cout << std::setw(14) << our.bytesPerOperation()
+                                  << std::setw(18) << their.bytesPerOperation();
+                    }
+                    std::cout << std::endl;
+                }
+                std::cout << "relative: " << ours << " time over " << standard
+                          << " time, below 1 is faster; B: heap bytes allocated per operation" << std::endl
+                          << std::endl;
+            }
+
+            /**
+             * HashMap contents in key order: copied into a vector and std::sorted, as before
+             * sortedView, against the radix sorted views.
+             */
+            void sortedExport(const std::vector<int> &keys) {
+                HashMap<int, int> map;
+                for (auto key : keys) {
+                    map[key] = key;
+                }
+                report(measure("compare", "HashMap sorted copy", keys.size(), [&]() {
+                    std::vector<std::pair<int, int>> copy(map.begin(), map.end());
+                    std::sort(copy.begin(), copy.end());
+                    consume(static_cast<std::size_t>(copy.front().first));
+                }));
+                report(measure("compare", "HashMap sortedView", keys.size(), [&]() {
+                    const auto view = map.sortedView();
+                    consume(static_cast<std::size_t>(view[0].first));
+                }));
+                ThreadPool pool;
+                report(measure("compare", "HashMap sortedView threads=" + std::to_string(pool.getSize()),
+                               keys.size(), [&]() {
+                            const auto view = map.sortedView(pool);
+                            consume(static_cast<std::size_t>(view[0].first));
+                        }));
+            }
+
+            std::vector<int> shuffled(std::size_t count, int offset, std::mt19937 &generator) {
+                std::vector<int> keys(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    keys[i] = static_cast<int>(i) * 2 + offset;
+                }
+                std::shuffle(keys.begin(), keys.end(), generator);
+                return keys;
+            }
+
+        }
+
+        void comparisonSuite() {
+            std::mt19937 generator(42);
+
+            // even keys are stored, odd keys miss
+            auto keys = shuffled(TREE_ELEMENTS, 0, generator);
+            auto misses = shuffled(TREE_ELEMENTS, 1, generator);
+            const auto tree = workloads<TreeMap<int, int>>("TreeMap", keys, misses);
+            const auto map = workloads<std::map<int, int>>("std::map", keys, misses);
+            printTable("TreeMap", "std::map", tree, map);
+
+            keys = shuffled(HASH_MAP_ELEMENTS, 0, generator);
+            misses = shuffled(HASH_MAP_ELEMENTS, 1, generator);
+            const auto hash = workloads<HashMap<int, int>>("HashMap", keys, misses);
+            const auto unordered = workloads<std::unordered_map<int, int>>("std::unordered_map", keys, misses);
+            printTable("HashMap", "unordered_map", hash, unordered);
+
+            sortedExport(shuffled(TREE_ELEMENTS, 0, generator));
+        }
+
+    }
+}
@@ -0,0 +1,228 @@
+#ifndef AISDI_MAPS_CONCURRENTHASHMAP_H
+#define AISDI_MAPS_CONCURRENTHASHMAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace aisdi {
+
+    /**
+     * Thread-safe hash map with a lock per bucket.
+     *
+     * The table doubles once the load factor is exceeded, but no thread migrates the whole table:
+     * every operation touching a table that is being resized first claims and migrates one chunk
+     * of buckets. Migrated buckets are marked as forwarded, so operations reaching them continue
+     * in the new table and never wait for the migration to finish.
+     *
+     * Replaced tables are kept until the map is destroyed, since readers may still be traversing
+     * them. Their total size is bounded by the size of the current table.
+     */
+    template<typename KeyType, typename ValueType>
+    class ConcurrentHashMap {
+        static const std::size_t INITIAL_BUCKETS = 16;
+        static const std::size_t MAX_LOAD_FACTOR = 2;
+        static const std::size_t MIGRATION_CHUNK = 16;
+
+    public:
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+        ConcurrentHashMap() : size(0) {
+            tables.emplace_back(new Table(INITIAL_BUCKETS));
+            current.store(tables.back().get());
+        }
+
+        ConcurrentHashMap(std::initializer_list<value_type> list) : ConcurrentHashMap() {
+            std::for_each(list.begin(), list.end(),
+                          [this](const value_type &v) { insertOrAssign(v.first, v.second); });
+        }
+
+        ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+
+        ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        size_type getSize() const {
+            return size.load();
+        }
+
+        size_type getBucketCount() const {
+            return current.load()->bucketCount;
+        }
+
+        bool isResizing() const {
+            return current.load()->next.load() != nullptr;
+        }
+
+        /**
+         * Returns true when the key was not present before.
+         */
+        bool insertOrAssign(const key_type &key, const mapped_type &value) {
+            bool inserted = false;
+            {
+                auto locked = lockBucket(key);
+                auto found = findInBucket(*locked.bucket, key);
+                if (found == locked.bucket->entries.end()) {
+                    locked.bucket->entries.emplace_back(key, value);
+                    inserted = true;
+                } else {
+                    found->second = value;
+                }
+            }
+            if (inserted) {
+                ++size;
+                startResizeIfNeeded();
+            }
+            return inserted;
+        }
+
+        mapped_type valueOf(const key_type &key) const {
+            auto locked = lockBucket(key);
+            auto found = findInBucket(*locked.bucket, key);
+            if (found == locked.bucket->entries.end()) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            return found->second;
+        }
+
+        bool contains(const key_type &key) const {
+            auto locked = lockBucket(key);
+            return findInBucket(*locked.bucket, key) != locked.bucket->entries.end();
+        }
+
+        void remove(const key_type &key) {
+            {
+                auto locked = lockBucket(key);
+                auto found = findInBucket(*locked.bucket, key);
+                if (found == locked.bucket->entries.end()) {
+                    throw std::out_of_range("Map does not contain key");
+                }
+                locked.bucket->entries.erase(found);
+            }
+            --size;
+        }
+
+    private:
+        struct Bucket {
+            std::mutex lock;
+            std::list<value_type> entries;
+            bool forwarded = false;
+        };
+
+        struct Table {
+            explicit Table(size_type bucketCount) : buckets(new Bucket[bucketCount]), bucketCount(bucketCount),
+                                                    chunkCount((bucketCount + MIGRATION_CHUNK - 1) / MIGRATION_CHUNK),
+                                                    claimedChunks(0), migratedChunks(0), next(nullptr) {}
+
+            Bucket &bucketFor(std::size_t hash) {
+                return buckets[hash & (bucketCount - 1)];
+            }
+
+            std::unique_ptr<Bucket[]> buckets;
+            const size_type bucketCount;
+            const size_type chunkCount;
+            std::atomic<size_type> claimedChunks;
+            std::atomic<size_type> migratedChunks;
+            std::atomic<Table *> next;
+        };
+
+        struct LockedBucket {
+            std::unique_lock<std::mutex> lock;
+            Bucket *bucket;
+        };
+
+        using entryIterator = typename std::list<value_type>::iterator;
+
+        mutable std::atomic<Table *> current;
+        std::atomic<size_type> size;
+        std::vector<std::unique_ptr<Table>> tables;
+        std::mutex tablesLock;
+
+        static std::size_t hashOf(const key_type &key) {
+            return std::hash<key_type>{}(key);
+        }
+
+        static entryIterator findInBucket(Bucket &bucket, const key_type &key) {
+            return std::find_if(bucket.entries.begin(), bucket.entries.end(),
+                                [&key](const value_type &v) { return v.first == key; });
+        }
+
+        LockedBucket lockBucket(const key_type &key) const {
+            const auto hash = hashOf(key);
+            auto table = current.load();
+            helpResize(table);
+            while (true) {
+                auto &bucket = table->bucketFor(hash);
+                std::unique_lock<std::mutex> lock(bucket.lock);
+                if (!bucket.forwarded) {
+                    return LockedBucket{std::move(lock), &bucket};
+                }
+                table = table->next.load();
+            }
+        }
+
+        void startResizeIfNeeded() {
+            auto table = current.load();
+            if (table->next.load() != nullptr || size.load() <= table->bucketCount * MAX_LOAD_FACTOR) {
+                return;
+            }
+            std::unique_ptr<Table> bigger(new Table(table->bucketCount * 2));
+            Table *expected = nullptr;
+            if (table->next.compare_exchange_strong(expected, bigger.get())) {
+                std::lock_guard<std::mutex> lock(tablesLock);
+                tables.push_back(std::move(bigger));
+            }
+        }
+
+        /**
+         * Migrates at most one chunk, so an operation never pays for more than MIGRATION_CHUNK buckets.
+         */
+        void helpResize(Table *table) const {
+            auto next = table->next.load();
+            if (next == nullptr) {
+                return;
+            }
+            const auto chunk = table->claimedChunks.fetch_add(1);
+            if (chunk >= table->chunkCount) {
+                return;
+            }
+            migrateChunk(*table, *next, chunk);
+            if (table->migratedChunks.fetch_add(1) + 1 == table->chunkCount) {
+                current.store(next);
+            }
+        }
+
+        static void migrateChunk(Table &from, Table &to, size_type chunk) {
+            const auto first = chunk * MIGRATION_CHUNK;
+            const auto last = std::min(first + MIGRATION_CHUNK, from.bucketCount);
+            for (auto i = first; i < last; ++i) {
+                auto &source = from.buckets[i];
+                std::lock_guard<std::mutex> sourceLock(source.lock);
+                while (!source.entries.empty()) {
+                    auto entry = source.entries.begin();
+                    auto &target = to.bucketFor(hashOf(entry->first));
+                    // lock order is always old table before new one, operations hold one lock at a time
+                    std::lock_guard<std::mutex> targetLock(target.lock);
+                    target.entries.splice(target.entries.end(), source.entries, entry);
+                }
+                source.forwarded = true;
+            }
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_CONCURRENTHASHMAP_H */
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "ConcurrentHashMap.h"
+#include "FrontCachedMap.h"
+#include "HashMap.h"
+#include "SynchronizedMap.h"
+#include "Timeline.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const int KEYS = 4096;
+            const int HOT_KEYS = 16;
+            const std::chrono::milliseconds DURATION(100);
+            // every operation is timed, a uniform sample of this many latencies is kept per thread
+            const std::size_t LATENCY_SAMPLES = 1 << 18;
+
+            struct Workload {
+                const char *name;
+                // out of 100 operations
+                int writes;
+                bool hotKeys;
+            };
+
+            const Workload workloads[] = {
+                    {"read-only", 0, false},
+                    {"read-mostly", 5, false},
+                    {"write-heavy", 50, false},
+                    {"hot-key", 50, true},
+                    {"hot-key read-mostly", 5, true},
+            };
+
+            struct ThreadResult {
+                std::size_t operations;
+                // reservoir sample of the latencies of all operations
+                std::vector<std::uint32_t> latencies;
+                std::uint32_t maxLatency;
+            };
+
+            /**
+             * Thread counts from AISDI_MAPS_THREADS, e.g. "1,2,4,8", or those by default.
+             */
+            std::vector<unsigned> threadCounts() {
+                std::vector<unsigned> counts;
+                if (const auto configured = std::getenv("AISDI_MAPS_THREADS")) {
+                    std::istringstream in(configured);
+                    std::string count;
+                    while (std::getline(in, count, ',')) {
+                        const auto threads = std::strtoul(count.c_str(), nullptr, 10);
+                        if (threads > 0) {
+                            counts.push_back(static_cast<unsigned>(threads));
+                        }
+                    }
+                }
+                if (counts.empty()) {
+                    counts = {1, 2, 4, 8};
+                }
+                return counts;
+            }
+
+            /**
+             * What a worker thread operates on: the shared map itself, or the thread's own reader.
+             */
+            template<typename Map>
+            Map &threadView(Map &map) {
+                return map;
+            }
+
+            template<typename Map, std::size_t SLOTS, typename Mutex>
+            typename FrontCachedMap<Map, SLOTS, Mutex>::Reader threadView(FrontCachedMap<Map, SLOTS, Mutex> &map) {
+                return map.reader();
+            }
+
+            template<typename Map>
+            ThreadResult runThread(Map &shared, const Workload &workload, unsigned seed, const std::atomic<bool> &stop) {
+                auto &&map = threadView(shared);
+                std::mt19937 generator(seed);
+                std::uniform_int_distribution<int> keys(0, (workload.hotKeys ? HOT_KEYS : KEYS) - 1);
+                std::uniform_int_distribution<int> kinds(0, 99);
+                ThreadResult result{0, {}, 0};
+                result.latencies.reserve(LATENCY_SAMPLES);
+                std::size_t found = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const auto key = keys(generator);
+                    const auto write = kinds(generator) < workload.writes;
+                    const auto started = std::chrono::steady_clock::now();
+                    if (write) {
+                        map.insertOrAssign(key, key);
+                    } else {
+                        found += map.contains(key);
+                    }
+                    const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - started).count();
+                    const auto sample = static_cast<std::uint32_t>(latency);
+                    result.maxLatency = std::max(result.maxLatency, sample);
+                    if (result.latencies.size() < LATENCY_SAMPLES) {
+                        result.latencies.push_back(sample);
+                    } else {
+                        // replaces a kept one with probability LATENCY_SAMPLES / (operations + 1)
+                        const auto slot = std::uniform_int_distribution<std::size_t>(0, result.operations)(generator);
+                        if (slot < LATENCY_SAMPLES) {
+                            result.latencies[slot] = sample;
+                        }
+                    }
+                    ++result.operations;
+                }
+                consume(found);
+                return result;
+            }
+
+            /**
+             * Jain's fairness index of the per-thread operation counts: 1 when all threads got
+             * the same share, 1/n when one thread did everything.
+             */
+            double fairness(const std::vector<ThreadResult> &results) {
+                double sum = 0;
+                double squares = 0;
+                for (const auto &result : results) {
+                    sum += result.operations;
+                    squares += static_cast<double>(result.operations) * result.operations;
+                }
+                return squares == 0 ? 1.0 : sum * sum / (results.size() * squares);
+            }
+
+            template<typename Map>
+            void contend(const std::string &name, const Workload &workload, unsigned threads) {
+                Map map;
+                {
+                    TimelineSpan span("phase", "build");
+                    for (int key = 0; key < KEYS; ++key) {
+                        map.insertOrAssign(key, key);
+                    }
+                }
+
+                std::atomic<bool> stop(false);
+                std::vector<ThreadResult> results(threads);
+                std::vector<std::thread> workers;
+                Stopwatch stopwatch;
+                for (unsigned t = 0; t < threads; ++t) {
+                    workers.emplace_back([&, t]() {
+                        TimelineSpan span("measure", name + " " + workload.name);
+                        results[t] = runThread(map, workload, t + 1, stop);
+                    });
+                }
+                std::this_thread::sleep_for(DURATION);
+                stop.store(true);
+                for (auto &worker : workers) {
+                    worker.join();
+                }
+                const auto elapsed = stopwatch.elapsedNanoseconds();
+
+                // each kept latency stands for operations / kept of its thread's operations
+                std::size_t operations = 0;
+                std::uint32_t maxLatency = 0;
+                std::vector<std::pair<std::uint32_t, double>> latencies;
+                for (const auto &result : results) {
+                    operations += result.operations;
+                    maxLatency = std::max(maxLatency, result.maxLatency);
+                    for (auto latency : result.latencies) {
+                        latencies.emplace_back(latency, static_cast<double>(result.operations) /
+                                                        result.latencies.size());
+                    }
+                }
+                std::sort(latencies.begin(), latencies.end());
+                const auto percentile = [&latencies, operations](double fraction) -> std::uint32_t {
+                    double covered = 0;
+                    for (const auto &latency : latencies) {
+                        covered += latency.second;
+                        if (covered > fraction * operations) {
+                            return latency.first;
+                        }
+                    }
+                    return latencies.empty() ? 0 : latencies.back().first;
+                };
+
+                // ns/op of the whole run is the inverse of aggregate throughput
+                report(Result{"contention", name + " " + workload.name + " threads=" + std::to_string(threads),
+                              operations, elapsed});
+                std::cout << std::setw(60) << "Mops/s, fairness, p50/p99/p99.9/max" << std::fixed
+                          << std::setprecision(2) << std::setw(12) << operations / elapsed * 1000 << ", "
+                          << std::setprecision(3) << fairness(results) << ", " << percentile(0.5) << " / "
+                          << percentile(0.99) << " / " << percentile(0.999) << " / "
+                          << maxLatency << " ns" << std::endl;
+            }
+
+            template<typename Map>
+            void contendAll(const std::string &name, const std::vector<unsigned> &counts) {
+                for (const auto &workload : workloads) {
+                    for (auto threads : counts) {
+                        contend<Map>(name, workload, threads);
+                    }
+                }
+            }
+
+        }
+
+        void contentionSuite() {
+            const auto counts = threadCounts();
+            contendAll<SynchronizedMap<TreeMap<int, int>>>("TreeMap mutex", counts);
+            contendAll<SynchronizedMap<TreeMap<int, int>, SharedMutex>>("TreeMap rwlock", counts);
+            contendAll<StripedMap<TreeMap<int, int>>>("TreeMap striped", counts);
+            contendAll<SynchronizedMap<HashMap<int, int>>>("HashMap mutex", counts);
+            contendAll<StripedMap<HashMap<int, int>>>("HashMap striped", counts);
+            contendAll<FrontCachedMap<HashMap<int, int>, 64, SharedMutex>>("HashMap front-cached", counts);
+            contendAll<ConcurrentHashMap<int, int>>("ConcurrentHashMap", counts);
+        }
+
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef AISDI_MAPS_ERRORPOLICY_H
+#define AISDI_MAPS_ERRORPOLICY_H
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace aisdi {
+
+    /**
+     * Throws the exception, or where exceptions are disabled (-fno-exceptions) prints its message
+     * and aborts, so headers stay compilable either way.
+     */
+    template<typename Exception>
+    [[noreturn]] void raiseError(const Exception &exception) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+        throw exception;
+#else
+        std::fprintf(stderr, "%s\n", exception.what());
+        std::abort();
+#endif
+    }
+
+    enum class MapError {
+        None,
+        MissingKey,
+        IteratorOutOfRange
+    };
+
+    inline const char *describe(MapError error) {
+        switch (error) {
+            case MapError::None:
+                return "No error";
+            case MapError::MissingKey:
+                return "Map does not contain key";
+            case MapError::IteratorOutOfRange:
+                return "Iterator out of range";
+        }
+        return "Unknown map error";
+    }
+
+    /**
+     * Error of the last failed map operation on this thread under ReportError, None if there was
+     * none since the last clear.
+     */
+    inline MapError &lastMapError() {
+        static thread_local MapError error = MapError::None;
+        return error;
+    }
+
+    /*
+     * Error policies of TreeMap and HashMap: fail() is called when valueOf or remove miss a key,
+     * or an iterator moves or is dereferenced out of range.
+     */
+
+    /**
+     * Throws std::out_of_range, the default.
+     */
+    struct ThrowOnError {
+        [[noreturn]] static void fail(MapError error) {
+            raiseError(std::out_of_range(describe(error)));
+        }
+    };
+
+    /**
+     * Treats errors as bugs: asserts in debug builds and aborts in release ones.
+     */
+    struct AbortOnError {
+        [[noreturn]] static void fail(MapError error) {
+            assert(error == MapError::None && "map error");
+            std::fprintf(stderr, "%s\n", describe(error));
+            std::abort();
+        }
+    };
+
+    /**
+     * Sets lastMapError() and lets the operation return: a failed remove does nothing, an
+     * iterator stays where it was, and valueOf or dereferencing the end returns a reference to a
+     * default-constructed value owned by the thread.
+     */
+    struct ReportError {
+        static void fail(MapError error) {
+            lastMapError() = error;
+        }
+    };
+
+    template<typename T>
+    void resetErrorValue(T &value) {
+        value = T();
+    }
+
+    // a map entry's key is const, so it can be neither assigned nor changed through the reference
+    template<typename K, typename V>
+    void resetErrorValue(std::pair<const K, V> &value) {
+        value.second = V();
+    }
+
+    /**
+     * Default-constructed value returned by failed lookups under ReportError, reset on every call.
+     */
+    template<typename T>
+    T &errorValue() {
+        static thread_local T value;
+        resetErrorValue(value);
+        return value;
+    }
+
+}
+
+#endif /* AISDI_MAPS_ERRORPOLICY_H */
@@ -0,0 +1,339 @@
+#ifndef AISDI_MAPS_FLATTREEMAP_H
+#define AISDI_MAPS_FLATTREEMAP_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace aisdi {
+
+    /**
+     * Ordered map with the TreeMap interface, kept as two sorted contiguous arrays: keys and values.
+     * Lookups binary search the key array only, so for small or read-mostly maps they touch a few
+     * cache lines instead of one node per tree level. Single inserts and removals shift the tail
+     * of both arrays, prefer the range constructor or insert(first, last) for bulk loading.
+     *
+     * Iterators dereference to a pair of references rather than a reference to a stored pair.
+     */
+    template<typename KeyType, typename ValueType>
+    class FlatTreeMap {
+    public:
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+        using reference = std::pair<const key_type &, mapped_type &>;
+        using const_reference = std::pair<const key_type &, const mapped_type &>;
+
+        class ConstIterator;
+
+        class Iterator;
+
+        using iterator = Iterator;
+        using const_iterator = ConstIterator;
+
+        FlatTreeMap() = default;
+
+        FlatTreeMap(std::initializer_list<value_type> list) : FlatTreeMap(list.begin(), list.end()) {}
+
+        /**
+         * Sorts the range once instead of inserting entries one by one. For repeated keys
+         * the last value wins, as with consecutive operator[] assignments.
+         */
+        template<typename InputIterator>
+        FlatTreeMap(InputIterator first, InputIterator last) {
+            insert(first, last);
+        }
+
+        bool isEmpty() const {
+            return keys.empty();
+        }
+
+        mapped_type &operator[](const key_type &key) {
+            const auto position = lowerBound(key);
+            if (position == keys.size() || keys[position] != key) {
+                keys.insert(keys.begin() + position, key);
+                values.insert(values.begin() + position, mapped_type{});
+            }
+            return values[position];
+        }
+
+        /**
+         * Batched insert: sorts the new entries and merges them with the stored ones in a single
+         * pass, O(n + k log k) instead of O(n * k) element moves. Assigns values of present keys.
+         */
+        template<typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            std::vector<std::pair<key_type, mapped_type>> batch(first, last);
+            std::stable_sort(batch.begin(), batch.end(), [](const std::pair<key_type, mapped_type> &a,
+                                                            const std::pair<key_type, mapped_type> &b) {
+                return a.first < b.first;
+            });
+
+            std::vector<key_type> mergedKeys;
+            std::vector<mapped_type> mergedValues;
+            mergedKeys.reserve(keys.size() + batch.size());
+            mergedValues.reserve(keys.size() + batch.size());
+
+            size_type stored = 0;
+            auto incoming = batch.begin();
+            while (incoming != batch.end()) {
+                // the last of equal keys in a stable sorted batch is the latest one
+                auto latest = incoming;
+                while (latest + 1 != batch.end() && !(incoming->first < (latest + 1)->first)) {
+                    ++latest;
+                }
+                while (stored < keys.size() && keys[stored] < incoming->first) {
+                    mergedKeys.push_back(std::move(keys[stored]));
+                    mergedValues.push_back(std::move(values[stored]));
+                    ++stored;
+                }
+                if (stored < keys.size() && !(incoming->first < keys[stored])) {
+                    ++stored;
+                }
+                mergedKeys.push_back(std::move(latest->first));
+                mergedValues.push_back(std::move(latest->second));
+                incoming = latest + 1;
+            }
+            std::move(keys.begin() + stored, keys.end(), std::back_inserter(mergedKeys));
+            std::move(values.begin() + stored, values.end(), std::back_inserter(mergedValues));
+
+            keys.swap(mergedKeys);
+            values.swap(mergedValues);
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            return values[findOrThrow(key)];
+        }
+
+        mapped_type &valueOf(const key_type &key) {
+            return values[findOrThrow(key)];
+        }
+
+        const_iterator find(const key_type &key) const {
+            return const_iterator(*this, findIndex(key));
+        }
+
+        iterator find(const key_type &key) {
+            return iterator(*this, findIndex(key));
+        }
+
+        void remove(const key_type &key) {
+            removeAt(findOrThrow(key));
+        }
+
+        void remove(const const_iterator &it) {
+            if (it == end()) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            removeAt(it.index);
+        }
+
+        size_type getSize() const {
+            return keys.size();
+        }
+
+        bool operator==(const FlatTreeMap &other) const {
+            // both sides are sorted and unique, so equal maps have equal arrays
+            return keys == other.keys && values == other.values;
+        }
+
+        bool operator!=(const FlatTreeMap &other) const {
+            return !(*this == other);
+        }
+
+        iterator begin() {
+            return iterator(*this, 0);
+        }
+
+        iterator end() {
+            return iterator(*this, getSize());
+        }
+
+        const_iterator cbegin() const {
+            return const_iterator(*this, 0);
+        }
+
+        const_iterator cend() const {
+            return const_iterator(*this, getSize());
+        }
+
+        const_iterator begin() const {
+            return cbegin();
+        }
+
+        const_iterator end() const {
+            return cend();
+        }
+
+    private:
+        std::vector<key_type> keys;
+        std::vector<mapped_type> values;
+
+        /**
+         * Branchless lower bound: the loop runs exactly ceil(log2(n)) times and has no
+         * data-dependent branch, so random probes cause no mispredictions.
+         */
+        size_type lowerBound(const key_type &key) const {
+            size_type length = keys.size();
+            if (length == 0) {
+                return 0;
+            }
+            const key_type *base = keys.data();
+            while (length > 1) {
+                const size_type half = length / 2;
+                // arithmetic instead of ?: - compilers tend to turn the latter back into a branch
+                base += half * static_cast<size_type>(base[half - 1] < key);
+                length -= half;
+            }
+            return static_cast<size_type>(base - keys.data()) + (*base < key ? 1 : 0);
+        }
+
+        size_type findIndex(const key_type &key) const {
+            const auto position = lowerBound(key);
+            return (position < keys.size() && keys[position] == key) ? position : keys.size();
+        }
+
+        size_type findOrThrow(const key_type &key) const {
+            const auto position = findIndex(key);
+            if (position == keys.size()) {
+                throw std::out_of_range("Map does not contain key");
+            }
+            return position;
+        }
+
+        void removeAt(size_type position) {
+            keys.erase(keys.begin() + position);
+            values.erase(values.begin() + position);
+        }
+    };
+
+    template<typename KeyType, typename ValueType>
+    class FlatTreeMap<KeyType, ValueType>::ConstIterator {
+    public:
+        using reference = typename FlatTreeMap::const_reference;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename FlatTreeMap::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        /**
+         * operator-> has to return something holding the pair of references it points to.
+         */
+        template<typename Pair>
+        struct ArrowProxy {
+            Pair pair;
+
+            const Pair *operator->() const {
+                return &pair;
+            }
+        };
+
+        using pointer = ArrowProxy<reference>;
+
+        friend class FlatTreeMap;
+
+        explicit ConstIterator(const FlatTreeMap &parent, size_type index) : parent(&parent), index(index) {}
+
+        ConstIterator &operator++() {
+            if (index == parent->getSize()) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            ++index;
+            return *this;
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        ConstIterator &operator--() {
+            if (index == 0) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            --index;
+            return *this;
+        }
+
+        ConstIterator operator--(int) {
+            ConstIterator ret = *this;
+            --*this;
+            return ret;
+        }
+
+        reference operator*() const {
+            if (index == parent->getSize()) {
+                throw std::out_of_range("Iterator out of range");
+            }
+            return reference(parent->keys[index], parent->values[index]);
+        }
+
+        pointer operator->() const {
+            return pointer{this->operator*()};
+        }
+
+        bool operator==(const ConstIterator &other) const {
+            return parent == other.parent && index == other.index;
+        }
+
+        bool operator!=(const ConstIterator &other) const {
+            return !(*this == other);
+        }
+
+    protected:
+        const FlatTreeMap *parent;
+        size_type index;
+    };
+
+    template<typename KeyType, typename ValueType>
+    class FlatTreeMap<KeyType, ValueType>::Iterator : public FlatTreeMap<KeyType, ValueType>::ConstIterator {
+    public:
+        using reference = typename FlatTreeMap::reference;
+        using pointer = typename ConstIterator::template ArrowProxy<reference>;
+
+        explicit Iterator(const FlatTreeMap &parent, size_type index) : ConstIterator(parent, index) {}
+
+        Iterator(const ConstIterator &other)
+                : ConstIterator(other) {}
+
+        Iterator &operator++() {
+            ConstIterator::operator++();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto result = *this;
+            ConstIterator::operator++();
+            return result;
+        }
+
+        Iterator &operator--() {
+            ConstIterator::operator--();
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            auto result = *this;
+            ConstIterator::operator--();
+            return result;
+        }
+
+        pointer operator->() const {
+            return pointer{this->operator*()};
+        }
+
+        reference operator*() const {
+            const auto entry = ConstIterator::operator*();
+            // ugly cast, yet reduces code duplication.
+            return reference(entry.first, const_cast<mapped_type &>(entry.second));
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_FLATTREEMAP_H */
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "FlatTreeMap.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t LOOKUPS = 200000;
+
+            std::vector<int> randomKeys(std::size_t count, std::mt19937 &generator) {
+                std::vector<int> keys(count);
+                std::generate(keys.begin(), keys.end(), [&generator]() { return static_cast<int>(generator()); });
+                return keys;
+            }
+
+            template<typename Map>
+            void lookups(const std::string &name, const Map &map, const std::vector<int> &keys,
+                         std::mt19937 &generator) {
+                std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+                std::vector<int> probes(LOOKUPS);
+                std::generate(probes.begin(), probes.end(), [&]() { return keys[pick(generator)]; });
+                report(measure("flat", name, LOOKUPS, [&]() {
+                    std::size_t sum = 0;
+                    for (auto key : probes) {
+                        sum += static_cast<std::size_t>(map.valueOf(key));
+                    }
+                    consume(sum);
+                }));
+            }
+
+            /**
+             * Finds the size below which FlatTreeMap wins: both lookups and building are compared
+             * for growing sizes, the crossover is where the ns/op columns swap.
+             */
+            void compareAt(std::size_t elements) {
+                std::mt19937 generator(static_cast<unsigned>(elements));
+                const auto keys = randomKeys(elements, generator);
+                const auto suffix = " n=" + std::to_string(elements);
+
+                TreeMap<int, int> tree;
+                report(measure("flat", "build TreeMap operator[]" + suffix, elements, [&]() {
+                    for (auto key : keys) {
+                        tree[key] = key;
+                    }
+                }));
+
+                FlatTreeMap<int, int> incremental;
+                report(measure("flat", "build FlatTreeMap operator[]" + suffix, elements, [&]() {
+                    for (auto key : keys) {
+                        incremental[key] = key;
+                    }
+                }));
+
+                std::vector<std::pair<int, int>> pairs;
+                for (auto key : keys) {
+                    pairs.emplace_back(key, key);
+                }
+                report(measure("flat", "build FlatTreeMap bulk" + suffix, elements, [&]() {
+                    FlatTreeMap<int, int> bulk(pairs.begin(), pairs.end());
+                    consume(bulk.getSize());
+                }));
+
+                lookups("lookup TreeMap" + suffix, tree, keys, generator);
+                lookups("lookup FlatTreeMap" + suffix, incremental, keys, generator);
+            }
+
+        }
+
+        void flatTreeMapSuite() {
+            for (std::size_t elements = 16; elements <= 65536; elements *= 4) {
+                compareAt(elements);
+            }
+        }
+
+    }
+}
@@ -0,0 +1,220 @@
+#ifndef AISDI_MAPS_FRONTCACHEDMAP_H
+#define AISDI_MAPS_FRONTCACHEDMAP_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+
+#include "SynchronizedMap.h"
+
+namespace aisdi {
+
+    /**
+     * Thread-safe wrapper with the interface of SynchronizedMap, whose readers keep recently found
+     * entries in a Reader of their own: a direct-mapped cache of SLOTS entries indexed by key hash.
+     * A cached entry is used while the version of its key's group is unchanged; every write bumps
+     * the version of the written key's group, out of VERSIONS, so a cache hit takes no lock and
+     * touches no shared memory but the version counter.
+     *
+     * Keys and values must be default constructible and copyable, they are copied into the slots.
+     */
+    template<typename Map, std::size_t SLOTS = 64, typename Mutex = std::mutex>
+    class FrontCachedMap {
+    public:
+        using key_type = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+        using value_type = typename Map::value_type;
+        using size_type = typename Map::size_type;
+
+        static const std::size_t VERSIONS = 64;
+
+        static_assert(SLOTS > 0 && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two");
+
+        /**
+         * One thread's view of the map. Not thread-safe itself: every thread takes its own with
+         * reader() and may keep it for as long as the map lives.
+         */
+        class Reader {
+        public:
+            explicit Reader(FrontCachedMap &owner) : owner(&owner), slots(), hits(0), misses(0) {}
+
+            bool insertOrAssign(const key_type &key, const mapped_type &value) {
+                return owner->insertOrAssign(key, value);
+            }
+
+            void remove(const key_type &key) {
+                owner->remove(key);
+            }
+
+            mapped_type valueOf(const key_type &key) {
+                const auto hash = mix(key);
+                auto &slot = slotOf(hash);
+                if (isCached(slot, hash, key)) {
+                    ++hits;
+                    return slot.value;
+                }
+                ++misses;
+                ReadLock<Mutex> lock(owner->mutex);
+                // the const overload, as the other would mark the entry changed for snapshots
+                const auto &value = static_cast<const Map &>(owner->map).valueOf(key);
+                fill(slot, hash, key, value);
+                return value;
+            }
+
+            bool contains(const key_type &key) {
+                const auto hash = mix(key);
+                auto &slot = slotOf(hash);
+                if (isCached(slot, hash, key)) {
+                    ++hits;
+                    return true;
+                }
+                ++misses;
+                ReadLock<Mutex> lock(owner->mutex);
+                const auto &map = static_cast<const Map &>(owner->map);
+                const auto it = map.find(key);
+                if (it == map.end()) {
+                    return false;
+                }
+                fill(slot, hash, key, (*it).second);
+                return true;
+            }
+
+            size_type getSize() const {
+                return owner->getSize();
+            }
+
+            bool isEmpty() const {
+                return owner->isEmpty();
+            }
+
+            /**
+             * Lookups served from the cache, and those that went to the map.
+             */
+            std::uint64_t getHits() const {
+                return hits;
+            }
+
+            std::uint64_t getMisses() const {
+                return misses;
+            }
+
+        private:
+            struct Slot {
+                // version of the key's group when the entry was read, 0 while the slot is empty
+                std::uint64_t version = 0;
+                std::uint64_t hash = 0;
+                key_type key;
+                mapped_type value;
+            };
+
+            FrontCachedMap *owner;
+            std::array<Slot, SLOTS> slots;
+            std::uint64_t hits;
+            std::uint64_t misses;
+
+            Slot &slotOf(std::uint64_t hash) {
+                return slots[(hash >> 32) & (SLOTS - 1)];
+            }
+
+            bool isCached(const Slot &slot, std::uint64_t hash, const key_type &key) const {
+                return slot.version != 0 && slot.hash == hash && slot.key == key &&
+                       owner->versionOf(hash).load(std::memory_order_acquire) == slot.version;
+            }
+
+            /**
+             * Called under the read lock, so no writer changes the entry or its version meanwhile.
+             */
+            void fill(Slot &slot, std::uint64_t hash, const key_type &key, const mapped_type &value) {
+                slot.version = owner->versionOf(hash).load(std::memory_order_relaxed);
+                slot.hash = hash;
+                slot.key = key;
+                slot.value = value;
+            }
+        };
+
+        FrontCachedMap() {
+            for (auto &version : versions) {
+                version.store(1, std::memory_order_relaxed);
+            }
+        }
+
+        FrontCachedMap(std::initializer_list<value_type> list) : FrontCachedMap() {
+            for (const auto &entry : list) {
+                insertOrAssign(entry.first, entry.second);
+            }
+        }
+
+        FrontCachedMap(const FrontCachedMap &) = delete;
+
+        FrontCachedMap &operator=(const FrontCachedMap &) = delete;
+
+        Reader reader() {
+            return Reader(*this);
+        }
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        size_type getSize() const {
+            ReadLock<Mutex> lock(mutex);
+            return map.getSize();
+        }
+
+        bool insertOrAssign(const key_type &key, const mapped_type &value) {
+            std::lock_guard<Mutex> lock(mutex);
+            const auto sizeBefore = map.getSize();
+            map[key] = value;
+            invalidate(key);
+            return map.getSize() != sizeBefore;
+        }
+
+        /**
+         * Uncached, as are all lookups not made through a Reader.
+         */
+        mapped_type valueOf(const key_type &key) const {
+            ReadLock<Mutex> lock(mutex);
+            return map.valueOf(key);
+        }
+
+        bool contains(const key_type &key) const {
+            ReadLock<Mutex> lock(mutex);
+            return map.find(key) != map.end();
+        }
+
+        void remove(const key_type &key) {
+            std::lock_guard<Mutex> lock(mutex);
+            map.remove(key);
+            invalidate(key);
+        }
+
+    private:
+        mutable Mutex mutex;
+        Map map;
+        std::array<std::atomic<std::uint64_t>, VERSIONS> versions;
+
+        // HashMap buckets by the same hash, so mix it, as StripedMap does
+        static std::uint64_t mix(const key_type &key) {
+            return static_cast<std::uint64_t>(std::hash<key_type>{}(key)) * 0x9E3779B97F4A7C15ull;
+        }
+
+        std::atomic<std::uint64_t> &versionOf(std::uint64_t hash) {
+            return versions[(hash >> 16) % VERSIONS];
+        }
+
+        /**
+         * Called under the lock, after the map was changed: a reader seeing the new version
+         * refills its slot from the changed map.
+         */
+        void invalidate(const key_type &key) {
+            versionOf(mix(key)).fetch_add(1, std::memory_order_release);
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_FRONTCACHEDMAP_H */
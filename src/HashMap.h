@@ -9,10 +9,28 @@
 #include <array>
 #include <algorithm>
 #include <stdexcept>
+#include <iterator>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include <future>
+#include <bitset>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "ErrorPolicy.h"
+#include "Snapshot.h"
+#include "SortedView.h"
+#include "ThreadPool.h"
+#include "Timeline.h"
 
 namespace aisdi {
 
-    template<typename KeyType, typename ValueType>
+    /**
+     * ErrorPolicy decides what a missing key or an out-of-range iterator does; see ErrorPolicy.h.
+     */
+    template<typename KeyType, typename ValueType, typename ErrorPolicy = ThrowOnError>
     class HashMap {
         static const int MAP_SIZE = 11;
 
@@ -33,20 +51,22 @@ namespace aisdi {
         using iterator = Iterator;
         using const_iterator = ConstIterator;
 
-        HashMap() : size(0) {}
+        HashMap() : size(0), trackingChanges(false), checkpoint(0) {}
 
         HashMap(std::initializer_list<value_type> list) : HashMap() {
             std::for_each(list.begin(), list.end(),
                           [this](const value_type &v) { (*this)[v.first] = v.second; });
         }
 
-        HashMap(const HashMap &other) : HashMap() {
-            fill(other.begin(), other.end());
-        }
+        HashMap(const HashMap &other) : buckets(other.buckets), size(other.size), trackingChanges(false),
+                                        checkpoint(0) {}
 
         HashMap(HashMap &&other) {
             this->buckets = std::move(other.buckets);
             this->size = other.size;
+            this->dirtyBuckets = other.dirtyBuckets;
+            this->trackingChanges = other.trackingChanges;
+            this->checkpoint = other.checkpoint;
         }
 
 
@@ -54,8 +74,11 @@ namespace aisdi {
             if (this == &other) {
                 return *this;
             }
-            this->size = 0;
-            fill(other.begin(), other.end());
+            // list copy-assignment would assign pairs with const keys, copy then move instead
+            auto copy = other.buckets;
+            this->buckets = std::move(copy);
+            this->size = other.size;
+            dirtyBuckets.set();
             return *this;
         }
 
@@ -65,15 +88,86 @@ namespace aisdi {
             }
             this->size = other.size;
             this->buckets = std::move(other.buckets);
+            dirtyBuckets.set();
             return *this;
         }
 
+        /**
+         * Copy made by the pool's workers, each copying a disjoint range of buckets.
+         * Result is equal, bucket by bucket, to the one made by the copy constructor.
+         */
+        HashMap clone(ThreadPool &pool) const {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "clone");
+            HashMap result;
+            const size_type rangeLength = (MAP_SIZE + pool.getSize() - 1) / pool.getSize();
+            std::vector<std::future<void>> copies;
+            for (size_type first = 0; first < MAP_SIZE; first += rangeLength) {
+                const size_type last = std::min<size_type>(first + rangeLength, MAP_SIZE);
+                copies.push_back(pool.submit([this, &result, first, last]() {
+                    for (size_type i = first; i < last; ++i) {
+                        result.buckets[i] = std::list<value_type>(buckets[i]);
+                    }
+                }));
+            }
+            waitAll(copies);
+            result.size = size;
+            return result;
+        }
+
+        /**
+         * Replaces the contents with a range of entries with distinct keys, skipping the key search
+         * of operator[]. Mapped values are moved out of the entries, keys are copied.
+         */
+        template<typename InputIterator>
+        void assignDistinct(InputIterator first, InputIterator last) {
+            std::array<std::list<value_type>, MAP_SIZE> filled;
+            size_type count = 0;
+            for (; first != last; ++first) {
+                auto &entry = *first;
+                filled[static_cast<size_type>(findBucket(entry.first) - buckets.begin())].emplace_back(
+                        entry.first, std::move(entry.second));
+                ++count;
+            }
+            buckets = std::move(filled);
+            size = count;
+            dirtyBuckets.set();
+        }
+
+        /**
+         * Entries in key order, as pointers into this map; see EntrySort for how they are sorted.
+         */
+        SortedView<value_type> sortedView() const {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "sortedView");
+            auto entries = gatherEntries();
+            EntrySort<value_type>::sort(entries, nullptr);
+            return SortedView<value_type>(std::move(entries));
+        }
+
+        /**
+         * sortedView made by the pool's workers, each taking a share of the radix passes or of
+         * the sample sort's buckets. Result is equal to the one made by sortedView().
+         */
+        SortedView<value_type> sortedView(ThreadPool &pool) const {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "sortedView");
+            auto entries = gatherEntries();
+            EntrySort<value_type>::sort(entries, &pool);
+            return SortedView<value_type>(std::move(entries));
+        }
+
+        /**
+         * Number of entries in the bucket of the key: the chain a lookup of it walks.
+         */
+        size_type bucketLength(const key_type &key) const {
+            return findBucket(key)->size();
+        }
+
         bool isEmpty() const {
             return this->size == 0;
         }
 
         mapped_type &operator[](const key_type &key) {
             const auto bucket = findBucket(key);
+            markDirty(bucket);
             auto found = findInBucket(bucket, key);
             if (found == bucket->end()) {
                 bucket->emplace_back(std::make_pair(key, mapped_type{}));
@@ -84,40 +178,74 @@ namespace aisdi {
         }
 
         const mapped_type &valueOf(const key_type &key) const {
-            return findOrThrow(key).second;
+            const auto entry = findEntry(key);
+            if (entry == nullptr) {
+                ErrorPolicy::fail(MapError::MissingKey);
+                return errorValue<mapped_type>();
+            }
+            return entry->second;
         }
 
         mapped_type &valueOf(const key_type &key) {
-            return findOrThrow(key).second;
+            const auto entry = findEntry(key);
+            if (entry == nullptr) {
+                ErrorPolicy::fail(MapError::MissingKey);
+                return errorValue<mapped_type>();
+            }
+            markDirty(findBucket(key));
+            return entry->second;
+        }
+
+        /**
+         * The value of key, or nullptr when it is missing; never an error.
+         */
+        const mapped_type *tryValueOf(const key_type &key) const {
+            const auto entry = findEntry(key);
+            return entry == nullptr ? nullptr : &entry->second;
         }
 
         const_iterator find(const key_type &key) const {
             const auto &bucket = findBucket(key);
             auto found = findInBucket(bucket, key);
-            return const_iterator(buckets, bucket, found);
+            if (found == bucket->end()) {
+                // the iterator would otherwise advance to the next bucket's first entry
+                return cend();
+            }
+            return const_iterator(*this, bucket, found);
         }
 
         iterator find(const key_type &key) {
-            const auto &bucket = findBucket(key);
-            auto found = findInBucket(bucket, key);
-            return iterator(buckets, bucket, found);
+            return iterator(static_cast<const HashMap &>(*this).find(key));
         }
 
         void remove(const key_type &key) {
+            if (!tryRemove(key)) {
+                ErrorPolicy::fail(MapError::MissingKey);
+            }
+        }
+
+        /**
+         * Removes key if present; returns whether it was, never an error.
+         */
+        bool tryRemove(const key_type &key) {
             const auto &bucket = findBucket(key);
             auto found = findInBucket(bucket, key);
             if (found == bucket->end()) {
-                throw std::out_of_range("Map does not contain key: " + key);
+                return false;
             }
+            markDirty(bucket);
             bucket->erase(found);
             --(this->size);
+            return true;
         }
 
         void remove(const const_iterator &it) {
             if (it == end()) {
-                throw std::out_of_range("Iterator out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return;
             }
 
+            markDirty(it.currentBucket);
             it.currentBucket->erase(it.iter);
             --(this->size);
         }
@@ -126,6 +254,72 @@ namespace aisdi {
             return this->size;
         }
 
+        /**
+         * Probes random (bucket, position) slots until an occupied one is hit, so every entry is
+         * equally likely. Expected number of probes is MAP_SIZE * longestBucket / size, a constant
+         * while buckets are about even, but the hit is then reached by walking its bucket's list:
+         * with the fixed MAP_SIZE buckets a draw costs O(size / MAP_SIZE), not O(1).
+         */
+        template<typename RandomGenerator>
+        const_iterator randomEntry(RandomGenerator &generator) const {
+            if (isEmpty()) {
+                return cend();
+            }
+            size_type longestBucket = 0;
+            for (const auto &bucket : buckets) {
+                longestBucket = std::max(longestBucket, bucket.size());
+            }
+
+            std::uniform_int_distribution<size_type> bucketIndex(0, MAP_SIZE - 1);
+            std::uniform_int_distribution<size_type> position(0, longestBucket - 1);
+            while (true) {
+                const auto bucket = buckets.begin() + bucketIndex(generator);
+                const auto offset = position(generator);
+                if (offset < bucket->size()) {
+                    return const_iterator(*this, bucket, std::next(bucket->begin(), offset));
+                }
+            }
+        }
+
+        template<typename RandomGenerator>
+        iterator randomEntry(RandomGenerator &generator) {
+            return iterator(static_cast<const HashMap &>(*this).randomEntry(generator));
+        }
+
+        /**
+         * Picks min(count, size) distinct entries, each subset being equally likely.
+         * Entries are returned in no particular order. Costs about count randomEntry draws, or
+         * a single pass over the map when count exceeds half the size.
+         */
+        template<typename RandomGenerator>
+        std::vector<const_iterator> sample(size_type count, RandomGenerator &generator) const {
+            count = std::min(count, size);
+            std::vector<const_iterator> result;
+            result.reserve(count);
+
+            if (2 * count <= size) {
+                // duplicates are rare, so rejecting them is cheaper than a full scan
+                std::unordered_set<const value_type *> picked;
+                while (result.size() < count) {
+                    auto candidate = randomEntry(generator);
+                    if (picked.insert(&*candidate).second) {
+                        result.push_back(candidate);
+                    }
+                }
+                return result;
+            }
+
+            // selection sampling: a single pass keeping each entry with probability needed / remaining
+            size_type remaining = size;
+            for (auto it = cbegin(); result.size() < count; ++it, --remaining) {
+                std::uniform_int_distribution<size_type> draw(0, remaining - 1);
+                if (draw(generator) < count - result.size()) {
+                    result.push_back(it);
+                }
+            }
+            return result;
+        }
+
         bool operator==(const HashMap &other) const {
             if (this->size != other.size) {
                 return false;
@@ -138,51 +332,157 @@ namespace aisdi {
             return !(*this == other);
         }
 
+        /**
+         * Writes every entry and starts tracking which buckets change until the next writeDelta.
+         */
+        void writeSnapshot(std::ostream &out) {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "writeSnapshot");
+            SnapshotHeader{SnapshotKind::Full, ++checkpoint}.write(out);
+            SnapshotCodec<std::uint64_t>::write(out, size);
+            for (const auto &bucket : buckets) {
+                writeEntries(out, bucket);
+            }
+            dirtyBuckets.reset();
+            trackingChanges = true;
+        }
+
+        /**
+         * Writes the buckets changed since the last snapshot or delta. Entries reached through
+         * operator[], non-const valueOf or non-const iterators count as changed.
+         */
+        void writeDelta(std::ostream &out) {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "writeDelta");
+            if (!trackingChanges) {
+                raiseError(std::logic_error("No snapshot to write a delta against"));
+            }
+            SnapshotHeader{SnapshotKind::Delta, ++checkpoint}.write(out);
+            const std::uint32_t bucketCount = MAP_SIZE;
+            SnapshotCodec<std::uint32_t>::write(out, bucketCount);
+            SnapshotCodec<std::uint32_t>::write(out, static_cast<std::uint32_t>(dirtyBuckets.count()));
+            for (std::uint32_t i = 0; i < bucketCount; ++i) {
+                if (dirtyBuckets.test(i)) {
+                    SnapshotCodec<std::uint32_t>::write(out, i);
+                    SnapshotCodec<std::uint64_t>::write(out, buckets[i].size());
+                    writeEntries(out, buckets[i]);
+                }
+            }
+            dirtyBuckets.reset();
+        }
+
+        /**
+         * Replaces the contents with a full snapshot. The map is left unchanged if reading fails.
+         */
+        void readSnapshot(std::istream &in) {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "readSnapshot");
+            const auto header = SnapshotHeader::read(in);
+            if (header.kind != SnapshotKind::Full) {
+                raiseError(std::runtime_error("Expected a full snapshot"));
+            }
+            HashMap loaded;
+            for (auto entries = SnapshotCodec<std::uint64_t>::read(in); entries > 0; --entries) {
+                auto key = SnapshotCodec<key_type>::read(in);
+                loaded[key] = SnapshotCodec<mapped_type>::read(in);
+            }
+            buckets = std::move(loaded.buckets);
+            size = loaded.size;
+            dirtyBuckets.reset();
+            trackingChanges = true;
+            checkpoint = header.sequence;
+        }
+
+        /**
+         * Replaces the buckets a delta carries. The delta must directly follow the last snapshot or
+         * delta read or written by this map; the map is left unchanged if reading fails.
+         */
+        void applyDelta(std::istream &in) {
+            AISDI_MAPS_TIMELINE_SPAN("HashMap", "applyDelta");
+            const auto header = SnapshotHeader::readDelta(in, checkpoint);
+            if (SnapshotCodec<std::uint32_t>::read(in) != static_cast<std::uint32_t>(MAP_SIZE)) {
+                raiseError(std::runtime_error("Delta written with a different bucket count"));
+            }
+            std::vector<std::pair<std::uint32_t, std::list<value_type>>> replaced;
+            for (auto count = SnapshotCodec<std::uint32_t>::read(in); count > 0; --count) {
+                const auto index = SnapshotCodec<std::uint32_t>::read(in);
+                if (index >= static_cast<std::uint32_t>(MAP_SIZE)) {
+                    raiseError(std::runtime_error("Bucket index out of range"));
+                }
+                replaced.push_back(std::make_pair(index, std::list<value_type>()));
+                for (auto entries = SnapshotCodec<std::uint64_t>::read(in); entries > 0; --entries) {
+                    auto key = SnapshotCodec<key_type>::read(in);
+                    replaced.back().second.emplace_back(std::move(key), SnapshotCodec<mapped_type>::read(in));
+                }
+            }
+            for (auto &bucket : replaced) {
+                size -= buckets[bucket.first].size();
+                size += bucket.second.size();
+                buckets[bucket.first].swap(bucket.second);
+            }
+            dirtyBuckets.reset();
+            checkpoint = header.sequence;
+        }
+
         iterator begin() {
-            return iterator(buckets, buckets.begin(), buckets.begin()->begin());
+            return iterator(*this, buckets.begin(), buckets.begin()->begin());
         }
 
         iterator end() {
-            return iterator(buckets, buckets.end() - 1, buckets.rbegin()->end());
+            return iterator(*this, buckets.end() - 1, buckets.rbegin()->end());
         }
 
         const_iterator cbegin() const {
-            return const_iterator(buckets, buckets.begin(), buckets.begin()->begin());
+            return const_iterator(*this, buckets.begin(), buckets.begin()->begin());
         }
 
         const_iterator cend() const {
-            return const_iterator(buckets, buckets.end() - 1, buckets.rbegin()->end());
+            return const_iterator(*this, buckets.end() - 1, buckets.rbegin()->end());
         }
 
         const_iterator begin() const {
-            return const_iterator(buckets, buckets.begin(), buckets.begin()->begin());
+            return const_iterator(*this, buckets.begin(), buckets.begin()->begin());
         }
 
         const_iterator end() const {
-            return const_iterator(buckets, buckets.end() - 1, buckets.rbegin()->end());
+            return const_iterator(*this, buckets.end() - 1, buckets.rbegin()->end());
         }
 
     private:
         mutable std::array<std::list<value_type>, MAP_SIZE> buckets;
         size_type size;
+        // buckets changed since the last snapshot or delta, set through const iterators too
+        mutable std::bitset<MAP_SIZE> dirtyBuckets;
+        bool trackingChanges;
+        std::uint64_t checkpoint;
+
+        void markDirty(const bucketIterator &bucket) const {
+            dirtyBuckets.set(static_cast<std::size_t>(bucket - buckets.begin()));
+        }
 
-        void fill(const_iterator begin, const_iterator end) {
-            std::for_each(begin, end, [this](const value_type &value) { (*this)[value.first] = value.second; });
+        std::vector<const value_type *> gatherEntries() const {
+            std::vector<const value_type *> entries;
+            entries.reserve(size);
+            for (const auto &bucket : buckets) {
+                for (const auto &entry : bucket) {
+                    entries.push_back(&entry);
+                }
+            }
+            return entries;
+        }
+
+        static void writeEntries(std::ostream &out, const std::list<value_type> &bucket) {
+            for (const auto &entry : bucket) {
+                SnapshotCodec<key_type>::write(out, entry.first);
+                SnapshotCodec<mapped_type>::write(out, entry.second);
+            }
         }
 
         bucketIterator findBucket(const KeyType &key) const {
             return (buckets.begin() + (std::hash<key_type>{}(key) % MAP_SIZE));
         }
 
-        value_type &findOrThrow(const key_type &key) const {
+        value_type *findEntry(const key_type &key) const {
             const auto bucket = findBucket(key);
-            auto bucket_it = std::find_if(
-                    bucket->begin(),
-                    bucket->end(), [&key](const value_type &v) { return v.first == key; });
-            if (bucket_it == bucket->end()) {
-                throw std::out_of_range("Map does not contain key: " + key);
-            }
-            return *bucket_it;
+            auto found = findInBucket(bucket, key);
+            return found == bucket->end() ? nullptr : &*found;
         }
 
         valueTypeIterator findInBucket(const bucketIterator &bucket, const key_type &key) const {
@@ -191,21 +491,22 @@ namespace aisdi {
         }
     };
 
-    template<typename KeyType, typename ValueType>
-    class HashMap<KeyType, ValueType>::ConstIterator {
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    class HashMap<KeyType, ValueType, ErrorPolicy>::ConstIterator {
     public:
         using reference = typename HashMap::const_reference;
         using iterator_category = std::bidirectional_iterator_tag;
         using value_type = typename HashMap::value_type;
+        using difference_type = std::ptrdiff_t;
         using pointer = const typename HashMap::value_type *;
         using bucketIterator = typename HashMap::bucketIterator;
         using valueTypeIterator = typename HashMap::valueTypeIterator;
 
         friend class HashMap;
 
-        explicit ConstIterator(std::array<std::list<value_type>, MAP_SIZE> &buckets,
+        explicit ConstIterator(const HashMap &map,
                                const bucketIterator &currentBucket,
-                               const valueTypeIterator &iter) : buckets(buckets),
+                               const valueTypeIterator &iter) : map(&map),
                                                                 currentBucket(currentBucket),
                                                                 iter(iter) {
             if (iter == currentBucket->end()) {
@@ -213,12 +514,20 @@ namespace aisdi {
             }
         }
 
-        ConstIterator(const ConstIterator &other) : buckets(other.buckets), currentBucket(other.currentBucket),
+        ConstIterator(const ConstIterator &other) : map(other.map), currentBucket(other.currentBucket),
                                                     iter(other.iter) {}
 
+        ConstIterator &operator=(const ConstIterator &other) {
+            map = other.map;
+            currentBucket = other.currentBucket;
+            iter = other.iter;
+            return *this;
+        }
+
         ConstIterator &operator++() {
             if (isEnd()) {
-                throw std::out_of_range("Index out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return *this;
             }
             ++iter;
             next();
@@ -233,12 +542,15 @@ namespace aisdi {
 
         ConstIterator &operator--() {
             if (iter == currentBucket->begin()) {
-                while (currentBucket->empty() && currentBucket != buckets.begin()) {
-                    --currentBucket;
-                }
-                if (currentBucket->empty()) {
-                    throw std::out_of_range("Iterator out of range");
-                }
+                auto bucket = currentBucket;
+                do {
+                    if (bucket == map->buckets.begin()) {
+                        ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                        return *this;
+                    }
+                    --bucket;
+                } while (bucket->empty());
+                currentBucket = bucket;
                 iter = --(currentBucket->end());
             } else {
                 --iter;
@@ -254,15 +566,13 @@ namespace aisdi {
 
         reference operator*() const {
             if (isEnd()) {
-                throw std::out_of_range("Iterator out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return errorValue<typename HashMap::value_type>();
             }
             return *iter;
         }
 
         pointer operator->() const {
-            if (isEnd()) {
-                throw std::out_of_range("Iterator out of range");
-            }
             return &this->operator*();
         }
 
@@ -276,32 +586,33 @@ namespace aisdi {
 
     private:
         void next() {
-            while (iter == currentBucket->end() && currentBucket != buckets.end() - 1) {
+            while (iter == currentBucket->end() && currentBucket != map->buckets.end() - 1) {
                 ++currentBucket;
                 iter = currentBucket->begin();
             }
         }
 
         bool isEnd() const {
-            return iter == buckets.rbegin()->end();
+            return iter == map->buckets.rbegin()->end();
         }
 
-        std::array<std::list<value_type>, MAP_SIZE> &buckets;
+        const HashMap *map;
         bucketIterator currentBucket;
         valueTypeIterator iter;
     };
 
-    template<typename KeyType, typename ValueType>
-    class HashMap<KeyType, ValueType>::Iterator : public HashMap<KeyType, ValueType>::ConstIterator {
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    class HashMap<KeyType, ValueType, ErrorPolicy>::Iterator
+            : public HashMap<KeyType, ValueType, ErrorPolicy>::ConstIterator {
     public:
         using reference = typename HashMap::reference;
         using pointer = typename HashMap::value_type *;
         using bucketIterator = typename HashMap::bucketIterator;
         using valueTypeIterator = typename HashMap::valueTypeIterator;
 
-        explicit Iterator(std::array<std::list<value_type>, MAP_SIZE> &buckets,
+        explicit Iterator(const HashMap &map,
                           const bucketIterator &currentBucket,
-                          const valueTypeIterator &iter) : ConstIterator(buckets, currentBucket, iter) {}
+                          const valueTypeIterator &iter) : ConstIterator(map, currentBucket, iter) {}
 
         explicit Iterator(const ConstIterator &other)
                 : ConstIterator(other) {}
@@ -334,7 +645,9 @@ namespace aisdi {
 
         reference operator*() const {
             // ugly cast, yet reduces code duplication.
-            return const_cast<reference>(ConstIterator::operator*());
+            auto &entry = const_cast<reference>(ConstIterator::operator*());
+            this->map->markDirty(this->currentBucket);
+            return entry;
         }
     };
 
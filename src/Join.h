@@ -0,0 +1,331 @@
+#ifndef AISDI_MAPS_JOIN_H
+#define AISDI_MAPS_JOIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ThreadPool.h"
+
+namespace aisdi {
+
+    enum class JoinKind {
+        // rows for keys present on both sides
+        Inner,
+        // every left entry, matched or not
+        Left,
+        // left entries with a match
+        Semi,
+        // left entries without a match
+        Anti
+    };
+
+    /**
+     * Result row pointing into the joined maps, which must outlive it. right is null where there
+     * is no matching right entry: in anti join rows and unmatched left join rows.
+     */
+    template<typename KeyType, typename LeftValue, typename RightValue>
+    struct JoinRow {
+        const KeyType *key;
+        const LeftValue *left;
+        const RightValue *right;
+    };
+
+    /**
+     * Joins of two maps on their keys. Keys are unique on both sides, so each left entry yields
+     * at most one row.
+     *
+     * The hash join radix-partitions both sides by key hash, so that the right (build) side of a
+     * partition fits in the L2 cache, then joins partitions independently through small
+     * open addressing tables. Row order is unspecified. The merge join walks two ordered maps
+     * side by side and returns rows in key order. Both take a ThreadPool to spread the work,
+     * with results equal as sets (and for the merge join, in the same order) to sequential runs.
+     *
+     * Maps are only read: concurrent readers are fine, concurrent writers are not.
+     */
+    template<typename LeftMap, typename RightMap>
+    class Join {
+    public:
+        using key_type = typename LeftMap::key_type;
+        using left_mapped_type = typename LeftMap::mapped_type;
+        using right_mapped_type = typename RightMap::mapped_type;
+        using row_type = JoinRow<key_type, left_mapped_type, right_mapped_type>;
+        using result_type = std::vector<row_type>;
+        using size_type = std::size_t;
+
+        // build side bytes per partition where the L2 size is unknown
+        static const size_type CACHE_BUDGET = 256 * 1024;
+        static const size_type MAX_PARTITION_BITS = 12;
+
+        static result_type hash(const LeftMap &left, const RightMap &right, JoinKind kind) {
+            return hashJoin(left, right, kind, nullptr);
+        }
+
+        static result_type hash(const LeftMap &left, const RightMap &right, JoinKind kind, ThreadPool &pool) {
+            return hashJoin(left, right, kind, &pool);
+        }
+
+        static result_type merge(const LeftMap &left, const RightMap &right, JoinKind kind) {
+            result_type rows;
+            auto r = right.begin();
+            const auto rightEnd = right.end();
+            for (auto l = left.begin(); l != left.end(); ++l) {
+                const auto &key = (*l).first;
+                while (r != rightEnd && (*r).first < key) {
+                    ++r;
+                }
+                const bool matched = r != rightEnd && !(key < (*r).first);
+                emit(rows, kind, &key, &(*l).second, matched ? &(*r).second : nullptr);
+            }
+            return rows;
+        }
+
+        /**
+         * Entries of both maps are listed in order first, then the left list is cut into one
+         * chunk per worker, each merged with the part of the right list starting at its first key.
+         */
+        static result_type merge(const LeftMap &left, const RightMap &right, JoinKind kind, ThreadPool &pool) {
+            const auto leftEntries = gather<left_mapped_type>(left, false);
+            const auto rightEntries = gather<right_mapped_type>(right, false);
+
+            const size_type chunks = std::max<size_type>(1, std::min(pool.getSize(), leftEntries.size()));
+            std::vector<result_type> parts(chunks);
+            parallelFor(&pool, chunks, [&](size_type chunk) {
+                const auto first = leftEntries.begin() + leftEntries.size() * chunk / chunks;
+                const auto last = leftEntries.begin() + leftEntries.size() * (chunk + 1) / chunks;
+                if (first == last) {
+                    return;
+                }
+                auto r = std::lower_bound(rightEntries.begin(), rightEntries.end(), *first->key,
+                                          [](const Entry<right_mapped_type> &entry, const key_type &key) {
+                                              return *entry.key < key;
+                                          });
+                for (auto l = first; l != last; ++l) {
+                    while (r != rightEntries.end() && *r->key < *l->key) {
+                        ++r;
+                    }
+                    const bool matched = r != rightEntries.end() && !(*l->key < *r->key);
+                    emit(parts[chunk], kind, l->key, l->value, matched ? r->value : nullptr);
+                }
+            });
+            return concatenate(parts);
+        }
+
+    private:
+        template<typename Value>
+        struct Entry {
+            std::uint64_t hash;
+            const key_type *key;
+            const Value *value;
+        };
+
+        static void emit(result_type &rows, JoinKind kind, const key_type *key, const left_mapped_type *left,
+                         const right_mapped_type *right) {
+            switch (kind) {
+                case JoinKind::Inner:
+                case JoinKind::Semi:
+                    if (right != nullptr) {
+                        rows.push_back(row_type{key, left, right});
+                    }
+                    break;
+                case JoinKind::Left:
+                    rows.push_back(row_type{key, left, right});
+                    break;
+                case JoinKind::Anti:
+                    if (right == nullptr) {
+                        rows.push_back(row_type{key, left, nullptr});
+                    }
+                    break;
+            }
+        }
+
+        static result_type concatenate(std::vector<result_type> &parts) {
+            size_type total = 0;
+            for (const auto &part : parts) {
+                total += part.size();
+            }
+            result_type rows;
+            rows.reserve(total);
+            for (auto &part : parts) {
+                rows.insert(rows.end(), part.begin(), part.end());
+                part = result_type();
+            }
+            return rows;
+        }
+
+        // Fibonacci hashing spreads patterned std::hash values (identity for integers) over the top bits
+        static std::uint64_t mix(const key_type &key) {
+            return static_cast<std::uint64_t>(std::hash<key_type>{}(key)) * 0x9E3779B97F4A7C15ull;
+        }
+
+        template<typename Value, typename Map>
+        static std::vector<Entry<Value>> gather(const Map &map, bool hashed) {
+            std::vector<Entry<Value>> entries;
+            entries.reserve(map.getSize());
+            for (auto it = map.begin(); it != map.end(); ++it) {
+                const auto &key = (*it).first;
+                entries.push_back(Entry<Value>{hashed ? mix(key) : 0, &key, &(*it).second});
+            }
+            return entries;
+        }
+
+        static size_type cacheBudget() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+            const auto detected = sysconf(_SC_LEVEL2_CACHE_SIZE);
+            if (detected > 0) {
+                return static_cast<size_type>(detected);
+            }
+#endif
+            return CACHE_BUDGET;
+        }
+
+        static size_type partitionBitsFor(size_type buildEntries) {
+            // a build entry takes its Entry and two table slots
+            const size_type bytes = buildEntries * (sizeof(Entry<right_mapped_type>) + 2 * sizeof(void *));
+            const auto budget = cacheBudget();
+            size_type bits = 0;
+            while (bits < MAX_PARTITION_BITS && (bytes >> bits) > budget) {
+                ++bits;
+            }
+            return bits;
+        }
+
+        /**
+         * Radix partitioning by the top bits of the hash. Each chunk of the input counts its
+         * entries per partition, prefix sums give every chunk its own output ranges, and the
+         * chunks scatter into them concurrently. bounds receives where each partition starts.
+         */
+        template<typename Value>
+        static std::vector<Entry<Value>> partition(const std::vector<Entry<Value>> &entries, size_type bits,
+                                                   size_type chunks, ThreadPool *pool,
+                                                   std::vector<size_type> &bounds) {
+            const size_type partitions = size_type(1) << bits;
+            const auto partitionOf = [bits](std::uint64_t hash) {
+                return bits == 0 ? 0 : static_cast<size_type>(hash >> (64 - bits));
+            };
+            const auto chunkBegin = [&entries, chunks](size_type chunk) {
+                return entries.size() * chunk / chunks;
+            };
+
+            std::vector<std::vector<size_type>> offsets(chunks, std::vector<size_type>(partitions, 0));
+            parallelFor(pool, chunks, [&](size_type chunk) {
+                for (auto i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+                    ++offsets[chunk][partitionOf(entries[i].hash)];
+                }
+            });
+
+            bounds.assign(partitions + 1, 0);
+            size_type position = 0;
+            for (size_type p = 0; p < partitions; ++p) {
+                bounds[p] = position;
+                for (size_type chunk = 0; chunk < chunks; ++chunk) {
+                    const auto count = offsets[chunk][p];
+                    offsets[chunk][p] = position;
+                    position += count;
+                }
+            }
+            bounds[partitions] = position;
+
+            std::vector<Entry<Value>> partitioned(entries.size());
+            parallelFor(pool, chunks, [&](size_type chunk) {
+                auto &next = offsets[chunk];
+                for (auto i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+                    partitioned[next[partitionOf(entries[i].hash)]++] = entries[i];
+                }
+            });
+            return partitioned;
+        }
+
+        static result_type hashJoin(const LeftMap &left, const RightMap &right, JoinKind kind, ThreadPool *pool) {
+            const auto leftEntries = gather<left_mapped_type>(left, true);
+            const auto rightEntries = gather<right_mapped_type>(right, true);
+            const auto bits = partitionBitsFor(rightEntries.size());
+            const size_type workers = pool == nullptr ? 1 : pool->getSize();
+
+            std::vector<size_type> leftBounds;
+            std::vector<size_type> rightBounds;
+            const auto probe = partition(leftEntries, bits, workers, pool, leftBounds);
+            const auto build = partition(rightEntries, bits, workers, pool, rightBounds);
+
+            const size_type partitions = size_type(1) << bits;
+            const size_type tasks = std::min(partitions, workers);
+            std::vector<result_type> parts(tasks);
+            parallelFor(pool, tasks, [&](size_type task) {
+                std::vector<const Entry<right_mapped_type> *> table;
+                for (size_type p = partitions * task / tasks; p < partitions * (task + 1) / tasks; ++p) {
+                    joinPartition(probe.begin() + leftBounds[p], probe.begin() + leftBounds[p + 1],
+                                  build.begin() + rightBounds[p], build.begin() + rightBounds[p + 1],
+                                  bits, kind, table, parts[task]);
+                }
+            });
+            return concatenate(parts);
+        }
+
+        template<typename ProbeIterator, typename BuildIterator>
+        static void joinPartition(ProbeIterator probeBegin, ProbeIterator probeEnd, BuildIterator buildBegin,
+                                  BuildIterator buildEnd, size_type partitionBits, JoinKind kind,
+                                  std::vector<const Entry<right_mapped_type> *> &table, result_type &rows) {
+            const auto buildSize = static_cast<size_type>(std::distance(buildBegin, buildEnd));
+            size_type tableBits = 1;
+            while ((size_type(1) << tableBits) < 2 * buildSize) {
+                ++tableBits;
+            }
+            // slots come from the hash bits just below those that chose the partition
+            const auto shift = 64 - partitionBits - tableBits;
+            const auto mask = (size_type(1) << tableBits) - 1;
+            table.assign(size_type(1) << tableBits, nullptr);
+
+            for (auto entry = buildBegin; entry != buildEnd; ++entry) {
+                auto slot = static_cast<size_type>(entry->hash >> shift) & mask;
+                while (table[slot] != nullptr) {
+                    slot = (slot + 1) & mask;
+                }
+                table[slot] = &*entry;
+            }
+
+            for (auto entry = probeBegin; entry != probeEnd; ++entry) {
+                const right_mapped_type *match = nullptr;
+                for (auto slot = static_cast<size_type>(entry->hash >> shift) & mask;
+                     table[slot] != nullptr; slot = (slot + 1) & mask) {
+                    if (table[slot]->hash == entry->hash && *table[slot]->key == *entry->key) {
+                        match = table[slot]->value;
+                        break;
+                    }
+                }
+                emit(rows, kind, entry->key, entry->value, match);
+            }
+        }
+    };
+
+    template<typename LeftMap, typename RightMap>
+    typename Join<LeftMap, RightMap>::result_type hashJoin(const LeftMap &left, const RightMap &right,
+                                                           JoinKind kind) {
+        return Join<LeftMap, RightMap>::hash(left, right, kind);
+    }
+
+    template<typename LeftMap, typename RightMap>
+    typename Join<LeftMap, RightMap>::result_type hashJoin(const LeftMap &left, const RightMap &right,
+                                                           JoinKind kind, ThreadPool &pool) {
+        return Join<LeftMap, RightMap>::hash(left, right, kind, pool);
+    }
+
+    template<typename LeftMap, typename RightMap>
+    typename Join<LeftMap, RightMap>::result_type mergeJoin(const LeftMap &left, const RightMap &right,
+                                                            JoinKind kind) {
+        return Join<LeftMap, RightMap>::merge(left, right, kind);
+    }
+
+    template<typename LeftMap, typename RightMap>
+    typename Join<LeftMap, RightMap>::result_type mergeJoin(const LeftMap &left, const RightMap &right,
+                                                            JoinKind kind, ThreadPool &pool) {
+        return Join<LeftMap, RightMap>::merge(left, right, kind, pool);
+    }
+
+}
+
+#endif /* AISDI_MAPS_JOIN_H */
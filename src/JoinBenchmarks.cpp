@@ -0,0 +1,97 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "HashMap.h"
+#include "Join.h"
+#include "ThreadPool.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ORDERED_ELEMENTS = 400000;
+            const std::size_t THREADS[] = {2, 4};
+
+            template<typename Map>
+            void fill(Map &map, std::size_t elements, unsigned seed) {
+                std::mt19937 generator(seed);
+                for (std::size_t i = 0; i < elements; ++i) {
+                    map[static_cast<int>(generator() % (elements * 2))] = static_cast<int>(i);
+                }
+            }
+
+            // what the query layer did before: look up every left key in the right map
+            template<typename Map>
+            void probeEach(const std::string &name, const Map &left, const Map &right) {
+                report(measure("join", name, left.getSize(), [&]() {
+                    std::size_t matched = 0;
+                    for (const auto &entry : left) {
+                        matched += right.find(entry.first) != right.end();
+                    }
+                    consume(matched);
+                }));
+            }
+
+            template<typename Join>
+            void joinWith(const std::string &name, std::size_t operations, Join join) {
+                report(measure("join", name, operations, [&]() {
+                    consume(join().size());
+                }));
+            }
+
+        }
+
+        void joinSuite() {
+            HashMap<int, int> hashedLeft;
+            HashMap<int, int> hashedRight;
+            fill(hashedLeft, HASH_MAP_ELEMENTS, 1);
+            fill(hashedRight, HASH_MAP_ELEMENTS, 2);
+            const auto hashedSize = hashedLeft.getSize();
+
+            probeEach("HashMap probe per key", hashedLeft, hashedRight);
+            joinWith("HashMap hashJoin inner", hashedSize, [&]() {
+                return hashJoin(hashedLeft, hashedRight, JoinKind::Inner);
+            });
+            joinWith("HashMap hashJoin anti", hashedSize, [&]() {
+                return hashJoin(hashedLeft, hashedRight, JoinKind::Anti);
+            });
+
+            TreeMap<int, int> left;
+            TreeMap<int, int> right;
+            fill(left, ORDERED_ELEMENTS, 3);
+            fill(right, ORDERED_ELEMENTS, 4);
+            const auto size = left.getSize();
+
+            probeEach("TreeMap find per key", left, right);
+            joinWith("TreeMap mergeJoin inner", size, [&]() {
+                return mergeJoin(left, right, JoinKind::Inner);
+            });
+            joinWith("TreeMap mergeJoin left", size, [&]() {
+                return mergeJoin(left, right, JoinKind::Left);
+            });
+            joinWith("TreeMap hashJoin inner", size, [&]() {
+                return hashJoin(left, right, JoinKind::Inner);
+            });
+
+            for (auto threads : THREADS) {
+                ThreadPool pool(threads);
+                const auto suffix = " threads=" + std::to_string(threads);
+                joinWith("HashMap hashJoin inner" + suffix, hashedSize, [&]() {
+                    return hashJoin(hashedLeft, hashedRight, JoinKind::Inner, pool);
+                });
+                joinWith("TreeMap mergeJoin inner" + suffix, size, [&]() {
+                    return mergeJoin(left, right, JoinKind::Inner, pool);
+                });
+                joinWith("TreeMap hashJoin inner" + suffix, size, [&]() {
+                    return hashJoin(left, right, JoinKind::Inner, pool);
+                });
+            }
+        }
+
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef AISDI_MAPS_MAPCONCEPT_H
+#define AISDI_MAPS_MAPCONCEPT_H
+
+#include <type_traits>
+#include <utility>
+
+namespace aisdi {
+
+    /**
+     * Compile-time check of the interface shared by all map engines: key_type, mapped_type,
+     * size_type, operator[], valueOf, find, remove by key and by iterator, getSize, isEmpty,
+     * begin and end. Use as static_assert(IsMap<M>::value, "...").
+     */
+    template<typename Map>
+    class IsMap {
+        template<typename M>
+        static auto check(int) -> decltype(
+                void(std::declval<M &>()[std::declval<const typename M::key_type &>()] =
+                             std::declval<const typename M::mapped_type &>()),
+                void(std::declval<const M &>().valueOf(std::declval<const typename M::key_type &>())),
+                void(std::declval<M &>().find(std::declval<const typename M::key_type &>()) ==
+                     std::declval<M &>().end()),
+                void(std::declval<const M &>().begin() != std::declval<const M &>().end()),
+                void(std::declval<M &>().remove(std::declval<const typename M::key_type &>())),
+                void(std::declval<M &>().remove(std::declval<M &>().begin())),
+                void(std::declval<typename M::size_type &>() = std::declval<const M &>().getSize()),
+                void(!std::declval<const M &>().isEmpty()),
+                std::true_type());
+
+        template<typename>
+        static std::false_type check(...);
+
+    public:
+        static const bool value = decltype(check<Map>(0))::value;
+    };
+
+}
+
+#endif /* AISDI_MAPS_MAPCONCEPT_H */
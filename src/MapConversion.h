@@ -0,0 +1,53 @@
+#ifndef AISDI_MAPS_MAPCONVERSION_H
+#define AISDI_MAPS_MAPCONVERSION_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "HashMap.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+
+    /*
+     * Conversions consuming their source map. Both move mapped values into the new map's entries
+     * and copy keys, which are const inside the source's entries; the source is left empty.
+     * Storage itself cannot be relinked: tree nodes and hash map list nodes have different layouts.
+     */
+
+    /**
+     * Sorts pointers to the entries once and builds a balanced tree from them in linear time,
+     * instead of a search and a rebalance per entry.
+     */
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    TreeMap<KeyType, ValueType, ErrorPolicy> toTreeMap(HashMap<KeyType, ValueType, ErrorPolicy> &&source) {
+        using value_type = typename HashMap<KeyType, ValueType, ErrorPolicy>::value_type;
+        std::vector<value_type *> entries;
+        entries.reserve(source.getSize());
+        for (auto &entry : source) {
+            entries.push_back(&entry);
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const value_type *left, const value_type *right) { return left->first < right->first; });
+
+        TreeMap<KeyType, ValueType, ErrorPolicy> result;
+        result.assignSorted(entries.begin(), entries.end());
+        source = HashMap<KeyType, ValueType, ErrorPolicy>();
+        return result;
+    }
+
+    /**
+     * Distributes the entries into buckets without searching them, as tree keys are distinct.
+     */
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    HashMap<KeyType, ValueType, ErrorPolicy> toHashMap(TreeMap<KeyType, ValueType, ErrorPolicy> &&source) {
+        HashMap<KeyType, ValueType, ErrorPolicy> result;
+        result.assignDistinct(source.begin(), source.end());
+        source = TreeMap<KeyType, ValueType, ErrorPolicy>();
+        return result;
+    }
+
+}
+
+#endif /* AISDI_MAPS_MAPCONVERSION_H */
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "AllocationCounter.h"
+#include "BeTreeMap.h"
+#include "Benchmark.h"
+#include "FlatTreeMap.h"
+#include "HashMap.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t ELEMENTS = 100000;
+            const std::size_t MISSES = 10000;
+
+            // TreeNode before the balance factor moved into the parent pointer
+            struct UntaggedNode {
+                std::pair<const int, int> val;
+                UntaggedNode *parent;
+                UntaggedNode *leftChild;
+                UntaggedNode *rightChild;
+                int height;
+                std::size_t count;
+                bool dirty;
+            };
+
+            /**
+             * Bytes handed out by malloc, allocator overhead included; 0 where glibc cannot tell.
+             */
+            std::size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+                return mallinfo2().uordblks;
+#else
+                return 0;
+#endif
+            }
+
+            void reportBytes(const std::string &name, double bytes) {
+                std::cout << std::left << std::setw(12) << "memory"
+                          << std::setw(48) << name
+                          << std::right << std::fixed << std::setprecision(2) << std::setw(12)
+                          << bytes << " bytes/entry" << std::endl;
+            }
+
+            template<typename Map>
+            void bytesPerEntry(const std::string &name, const std::vector<int> &keys) {
+                const auto before = heapInUse();
+                {
+                    Map map;
+                    for (auto key : keys) {
+                        map[key] = key;
+                    }
+                    reportBytes(name, static_cast<double>(heapInUse() - before) / keys.size());
+                }
+            }
+
+        }
+
+        void memorySuite() {
+            reportBytes("sizeof untagged TreeMap node", sizeof(UntaggedNode));
+            reportBytes("sizeof TreeMap node", sizeof(TreeMap<int, int>::node));
+
+            std::mt19937 generator(7);
+            std::vector<int> keys(ELEMENTS);
+            for (std::size_t i = 0; i < ELEMENTS; ++i) {
+                keys[i] = static_cast<int>(i);
+            }
+            std::shuffle(keys.begin(), keys.end(), generator);
+
+            bytesPerEntry<TreeMap<int, int>>("heap TreeMap", keys);
+            bytesPerEntry<HashMap<int, int>>("heap HashMap", keys);
+            bytesPerEntry<FlatTreeMap<int, int>>("heap FlatTreeMap", keys);
+            bytesPerEntry<BeTreeMap<int, int>>("heap BeTreeMap", keys);
+            bytesPerEntry<std::map<int, int>>("heap std::map", keys);
+
+            AllocationCounts counts{};
+            {
+                using Allocator = CountingAllocator<std::pair<const int, int>>;
+                std::map<int, int, std::less<int>, Allocator> map{std::less<int>(), Allocator(counts)};
+                for (auto key : keys) {
+                    map[key] = key;
+                }
+            }
+            reportBytes("allocator std::map", static_cast<double>(counts.bytes.load()) / keys.size());
+
+            HashMap<int, int> small;
+            for (int key = 0; key < 100; ++key) {
+                small[key] = key;
+            }
+            report(measure("memory", "HashMap remove missing key", MISSES, [&]() {
+                for (std::size_t i = 0; i < MISSES; ++i) {
+                    try {
+                        small.remove(-1);
+                    } catch (const std::out_of_range &) {
+                    }
+                }
+            }));
+
+            TreeMap<int, int> sorted;
+            report(measure("memory", "build TreeMap sorted keys", ELEMENTS, [&]() {
+                for (std::size_t i = 0; i < ELEMENTS; ++i) {
+                    sorted[static_cast<int>(i)] = 0;
+                }
+            }));
+            consume(sorted.getHeight());
+        }
+
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef AISDI_MAPS_MUTATIONLOG_H
+#define AISDI_MAPS_MUTATIONLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "AsyncWriter.h"
+#include "Snapshot.h"
+
+namespace aisdi {
+
+    /**
+     * Append-only log of map mutations written in the background through an AsyncWriter.
+     *
+     * Records are buffered and written in AsyncFileOutput chunks; commit() makes everything
+     * recorded so far durable and reports it through its callback, so many records share one
+     * fsync. Each record is framed by its length and an FNV-1a checksum, keys and values inside
+     * are encoded with SnapshotCodec.
+     */
+    template<typename KeyType, typename ValueType>
+    class MutationLog {
+    public:
+        using key_type = KeyType;
+        using mapped_type = ValueType;
+
+        /**
+         * Appends to fd from the given offset; a log started at offset 0 gets a header first.
+         */
+        MutationLog(AsyncWriter &writer, int fd, std::uint64_t offset = 0) : output(writer, fd, offset),
+                                                                            stream(&output) {
+            if (offset == 0) {
+                stream.write(magic(), MAGIC_LENGTH);
+            }
+        }
+
+        void recordAssign(const key_type &key, const mapped_type &value) {
+            startRecord(ASSIGN);
+            SnapshotCodec<key_type>::write(record, key);
+            SnapshotCodec<mapped_type>::write(record, value);
+            endRecord();
+        }
+
+        void recordRemove(const key_type &key) {
+            startRecord(REMOVE);
+            SnapshotCodec<key_type>::write(record, key);
+            endRecord();
+        }
+
+        /**
+         * done runs once every record made so far is on disk, with the first error met on the way.
+         */
+        void commit(AsyncWriter::Completion done) {
+            output.finish(std::move(done));
+        }
+
+        std::uint64_t getOffset() const {
+            return output.getOffset();
+        }
+
+        /**
+         * Applies the records of a log to the map and returns how many were applied. Reading stops
+         * at the first incomplete or corrupted record: the tail of a log cut short by a crash
+         * holds only uncommitted records.
+         */
+        template<typename Map>
+        static std::size_t replay(Map &map, std::istream &in) {
+            char found[MAGIC_LENGTH];
+            in.read(found, MAGIC_LENGTH);
+            if (!in || std::memcmp(found, magic(), MAGIC_LENGTH) != 0) {
+                throw std::runtime_error("Not a mutation log");
+            }
+
+            std::size_t applied = 0;
+            std::string payload;
+            while (in.peek() != std::istream::traits_type::eof()) {
+                try {
+                    const auto length = SnapshotCodec<std::uint32_t>::read(in);
+                    const auto checksum = SnapshotCodec<std::uint32_t>::read(in);
+                    if (length == 0 || length > MAX_RECORD_LENGTH) {
+                        break;
+                    }
+                    payload.resize(length);
+                    in.read(&payload[0], length);
+                    if (!in || fnv1a(payload) != checksum) {
+                        break;
+                    }
+
+                    std::istringstream fields(payload);
+                    const auto operation = SnapshotCodec<std::uint8_t>::read(fields);
+                    auto key = SnapshotCodec<key_type>::read(fields);
+                    if (operation == ASSIGN) {
+                        map[key] = SnapshotCodec<mapped_type>::read(fields);
+                    } else if (operation == REMOVE) {
+                        if (map.find(key) != map.end()) {
+                            map.remove(key);
+                        }
+                    } else {
+                        break;
+                    }
+                } catch (const std::runtime_error &) {
+                    break;
+                }
+                ++applied;
+            }
+            return applied;
+        }
+
+    private:
+        enum : std::uint8_t {
+            ASSIGN = 1, REMOVE = 2
+        };
+
+        enum : std::uint32_t {
+            MAGIC_LENGTH = 8,
+            // larger lengths are taken for garbage rather than allocated
+            MAX_RECORD_LENGTH = 1u << 30
+        };
+
+        static const char *magic() {
+            return "AISDILOG";
+        }
+
+        AsyncFileOutput output;
+        std::ostream stream;
+        std::ostringstream record;
+
+        static std::uint32_t fnv1a(const std::string &bytes) {
+            std::uint32_t hash = 2166136261u;
+            for (auto byte : bytes) {
+                hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+            }
+            return hash;
+        }
+
+        void startRecord(std::uint8_t operation) {
+            record.str(std::string());
+            SnapshotCodec<std::uint8_t>::write(record, operation);
+        }
+
+        void endRecord() {
+            const auto payload = record.str();
+            SnapshotCodec<std::uint32_t>::write(stream, static_cast<std::uint32_t>(payload.size()));
+            SnapshotCodec<std::uint32_t>::write(stream, fnv1a(payload));
+            stream.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_MUTATIONLOG_H */
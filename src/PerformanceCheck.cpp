@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "FlatTreeMap.h"
+#include "HashMap.h"
+#include "PerformanceCounter.h"
+#include "TreeMap.h"
+
+/*
+ * Performance regression check: runs a short, deterministic set of map workloads and compares
+ * their cost per operation with a baseline file.
+ *
+ *   aisdiMapsPerf --baseline FILE [--tolerance FRACTION] [--update]
+ *
+ * Costs are retired instructions where perf events can count them, otherwise the best of a few
+ * timed runs. Baseline lines read "<metric> <value> <workload>"; only entries of the metric being
+ * measured are compared, so one file may keep both, and a workload without one fails the check.
+ * --update rewrites the file with the current results for that metric, and notes the compiler and
+ * flags they were measured with in a "# <metric> measured by <build>" line. The allowed slowdown
+ * defaults to 5% for instruction counts and 50% for timings, which vary that much between runs on
+ * shared machines.
+ */
+
+#ifndef AISDI_MAPS_PERF_BUILD
+#define AISDI_MAPS_PERF_BUILD "an unknown build"
+#endif
+
+namespace
+{
+
+// instruction counts barely vary, timings need more runs for a stable minimum
+const int COUNTED_REPETITIONS = 3;
+const int TIMED_REPETITIONS = 15;
+const double COUNTED_TOLERANCE = 0.05;
+const double TIMED_TOLERANCE = 0.5;
+const std::size_t TREE_ELEMENTS = 50000;
+const std::size_t HASH_ELEMENTS = 4000;
+
+class Meter
+{
+public:
+    explicit Meter(aisdi::benchmark::InstructionCounter &counter) : counter(counter), best(0), operations(0) {}
+
+    const char *getMetric() const
+    {
+        return counter.isAvailable() ? "instructions" : "nanoseconds";
+    }
+
+    void reset(std::size_t operations)
+    {
+        this->operations = operations;
+        best = std::numeric_limits<double>::max();
+    }
+
+    template<typename Operation>
+    void measure(Operation operation)
+    {
+        double cost;
+        if (counter.isAvailable()) {
+            counter.start();
+            operation();
+            cost = static_cast<double>(counter.stop());
+        } else {
+            aisdi::benchmark::Stopwatch stopwatch;
+            operation();
+            cost = stopwatch.elapsedNanoseconds();
+        }
+        best = std::min(best, cost / operations);
+    }
+
+    double getBest() const
+    {
+        return best;
+    }
+
+private:
+    aisdi::benchmark::InstructionCounter &counter;
+    double best;
+    std::size_t operations;
+};
+
+std::vector<int> shuffledKeys(std::size_t count)
+{
+    std::vector<int> keys(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        keys[i] = static_cast<int>(i);
+    }
+    std::mt19937 generator(17);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    return keys;
+}
+
+template<typename Map>
+void fill(Map &map, const std::vector<int> &keys)
+{
+    for (auto key : keys) {
+        map[key] = key;
+    }
+}
+
+struct Workload
+{
+    const char *name;
+    std::size_t operations;
+    void (*run)(Meter &meter);
+};
+
+const Workload workloads[] = {
+    {"TreeMap insert", TREE_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(TREE_ELEMENTS);
+        aisdi::TreeMap<int, int> map;
+        meter.measure([&]() { fill(map, keys); });
+    }},
+    {"TreeMap find hit", TREE_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(TREE_ELEMENTS);
+        aisdi::TreeMap<int, int> map;
+        fill(map, keys);
+        meter.measure([&]() {
+            std::size_t sum = 0;
+            for (auto key : keys) {
+                sum += static_cast<std::size_t>(map.find(key)->second);
+            }
+            aisdi::benchmark::consume(sum);
+        });
+    }},
+    {"TreeMap findSorted", TREE_ELEMENTS, [](Meter &meter) {
+        auto keys = shuffledKeys(TREE_ELEMENTS);
+        aisdi::TreeMap<int, int> map;
+        fill(map, keys);
+        std::sort(keys.begin(), keys.end());
+        std::vector<aisdi::TreeMap<int, int>::const_iterator> found;
+        found.reserve(keys.size());
+        meter.measure([&]() {
+            found.clear();
+            map.findSorted(keys.begin(), keys.end(), std::back_inserter(found));
+            aisdi::benchmark::consume(found.size());
+        });
+    }},
+    {"TreeMap iterate", TREE_ELEMENTS, [](Meter &meter) {
+        aisdi::TreeMap<int, int> map;
+        fill(map, shuffledKeys(TREE_ELEMENTS));
+        meter.measure([&]() {
+            std::size_t sum = 0;
+            for (const auto &entry : map) {
+                sum += static_cast<std::size_t>(entry.second);
+            }
+            aisdi::benchmark::consume(sum);
+        });
+    }},
+    {"TreeMap remove", TREE_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(TREE_ELEMENTS);
+        aisdi::TreeMap<int, int> map;
+        fill(map, keys);
+        meter.measure([&]() {
+            for (auto key : keys) {
+                map.remove(key);
+            }
+        });
+    }},
+    {"HashMap insert", HASH_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(HASH_ELEMENTS);
+        aisdi::HashMap<int, int> map;
+        meter.measure([&]() { fill(map, keys); });
+    }},
+    {"HashMap find hit", HASH_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(HASH_ELEMENTS);
+        aisdi::HashMap<int, int> map;
+        fill(map, keys);
+        meter.measure([&]() {
+            std::size_t sum = 0;
+            for (auto key : keys) {
+                sum += static_cast<std::size_t>(map.find(key)->second);
+            }
+            aisdi::benchmark::consume(sum);
+        });
+    }},
+    {"FlatTreeMap find hit", TREE_ELEMENTS, [](Meter &meter) {
+        const auto keys = shuffledKeys(TREE_ELEMENTS);
+        std::vector<std::pair<int, int>> pairs;
+        for (auto key : keys) {
+            pairs.emplace_back(key, key);
+        }
+        const aisdi::FlatTreeMap<int, int> map(pairs.begin(), pairs.end());
+        meter.measure([&]() {
+            std::size_t sum = 0;
+            for (auto key : keys) {
+                sum += static_cast<std::size_t>(map.valueOf(key));
+            }
+            aisdi::benchmark::consume(sum);
+        });
+    }},
+};
+
+using Baseline = std::map<std::pair<std::string, std::string>, double>;
+// build each metric's baseline was measured with
+using Builds = std::map<std::string, std::string>;
+
+const std::string MEASURED_BY = " measured by ";
+
+bool readBaseline(const std::string &path, Baseline &baseline, Builds &builds)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            const auto measuredBy = line.find(MEASURED_BY);
+            if (line.compare(0, 2, "# ") == 0 && measuredBy != std::string::npos) {
+                builds[line.substr(2, measuredBy - 2)] = line.substr(measuredBy + MEASURED_BY.size());
+            }
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string metric;
+        double value;
+        std::string name;
+        if (fields >> metric >> value >> std::ws && std::getline(fields, name)) {
+            baseline[std::make_pair(metric, name)] = value;
+        }
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string &path, const Baseline &baseline, const Builds &builds)
+{
+    std::ofstream out(path);
+    out << "# <metric> <cost per operation> <workload>, written by aisdiMapsPerf --update" << std::endl;
+    for (const auto &build : builds) {
+        out << "# " << build.first << MEASURED_BY << build.second << std::endl;
+    }
+    for (const auto &entry : baseline) {
+        out << entry.first.first << ' ' << std::fixed << std::setprecision(2) << entry.second << ' '
+            << entry.first.second << std::endl;
+    }
+    return static_cast<bool>(out);
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "usage: " << program << " --baseline FILE [--tolerance FRACTION] [--update]" << std::endl;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::string baselinePath;
+    double tolerance = -1;
+    bool update = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (argument == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else if (argument == "--update") {
+            update = true;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (baselinePath.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    Baseline baseline;
+    Builds builds;
+    if (!readBaseline(baselinePath, baseline, builds) && !update) {
+        std::cerr << "cannot read baseline " << baselinePath << std::endl;
+        return 2;
+    }
+
+    aisdi::benchmark::InstructionCounter counter;
+    Meter meter(counter);
+    const std::string metric = meter.getMetric();
+    const auto repetitions = counter.isAvailable() ? COUNTED_REPETITIONS : TIMED_REPETITIONS;
+    if (tolerance < 0) {
+        tolerance = counter.isAvailable() ? COUNTED_TOLERANCE : TIMED_TOLERANCE;
+    }
+    const auto build = builds.find(metric);
+    if (!update && build != builds.end() && build->second != AISDI_MAPS_PERF_BUILD) {
+        std::cerr << "the " << metric << " baseline was measured by " << build->second << ", this is "
+                  << AISDI_MAPS_PERF_BUILD << std::endl;
+    }
+
+    int regressions = 0;
+    int missing = 0;
+    for (const auto &workload : workloads) {
+        meter.reset(workload.operations);
+        for (int repetition = 0; repetition < repetitions; ++repetition) {
+            workload.run(meter);
+        }
+        const auto cost = meter.getBest();
+        const auto key = std::make_pair(metric, std::string(workload.name));
+        const auto found = baseline.find(key);
+        std::cout << std::left << std::setw(32) << workload.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << cost << ' ' << metric << "/op";
+        if (update) {
+            baseline[key] = cost;
+        } else if (found == baseline.end()) {
+            std::cout << "  NO BASELINE";
+            ++missing;
+        } else {
+            const auto change = cost / found->second - 1.0;
+            std::cout << std::showpos << std::setw(10) << change * 100 << std::noshowpos << "%";
+            if (change > tolerance) {
+                std::cout << "  REGRESSION";
+                ++regressions;
+            } else if (change < -tolerance) {
+                std::cout << "  faster than baseline, consider --update";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (update) {
+        builds[metric] = AISDI_MAPS_PERF_BUILD;
+        return writeBaseline(baselinePath, baseline, builds) ? 0 : 2;
+    }
+    if (missing > 0) {
+        std::cerr << missing << " workload(s) have no " << metric << " baseline, add them with --update" << std::endl;
+    }
+    if (regressions > 0) {
+        std::cerr << regressions << " workload(s) regressed by more than " << tolerance * 100 << "%" << std::endl;
+    }
+    return missing > 0 || regressions > 0 ? 1 : 0;
+}
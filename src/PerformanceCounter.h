@@ -0,0 +1,114 @@
+#ifndef AISDI_MAPS_PERFORMANCECOUNTER_H
+#define AISDI_MAPS_PERFORMANCECOUNTER_H
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace aisdi {
+    namespace benchmark {
+
+        /**
+         * Counts one hardware event for the calling thread's user-space code through perf events.
+         * Unavailable outside Linux, in most virtual machines and where perf_event_paranoid
+         * forbids it; isAvailable() tells.
+         */
+        class EventCounter {
+        public:
+            enum class Event {
+                Instructions,
+                // loads missing the level 1 data cache
+                L1DataMisses,
+                // references missing the last level cache
+                LastLevelMisses
+            };
+
+            explicit EventCounter(Event event) : descriptor(-1) {
+#ifdef __linux__
+                perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.size = sizeof(attributes);
+                switch (event) {
+                    case Event::Instructions:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+                        break;
+                    case Event::L1DataMisses:
+                        attributes.type = PERF_TYPE_HW_CACHE;
+                        attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                        break;
+                    case Event::LastLevelMisses:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                        break;
+                }
+                attributes.disabled = 1;
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+                (void) event;
+#endif
+            }
+
+            EventCounter(const EventCounter &) = delete;
+
+            EventCounter &operator=(const EventCounter &) = delete;
+
+            ~EventCounter() {
+#ifdef __linux__
+                if (descriptor >= 0) {
+                    close(descriptor);
+                }
+#endif
+            }
+
+            bool isAvailable() const {
+                return descriptor >= 0;
+            }
+
+            void start() {
+#ifdef __linux__
+                ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+                ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+            }
+
+            /**
+             * Events since start(), 0 when counting is unavailable.
+             */
+            std::uint64_t stop() {
+                std::uint64_t count = 0;
+#ifdef __linux__
+                ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(descriptor, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                    count = 0;
+                }
+#endif
+                return count;
+            }
+
+        private:
+            int descriptor;
+        };
+
+        /**
+         * Retired instructions. Unlike time, the count hardly changes between runs, so it makes a
+         * steady regression metric.
+         */
+        class InstructionCounter : public EventCounter {
+        public:
+            InstructionCounter() : EventCounter(Event::Instructions) {}
+        };
+
+    }
+}
+
+#endif /* AISDI_MAPS_PERFORMANCECOUNTER_H */
@@ -0,0 +1,470 @@
+#ifndef AISDI_MAPS_RECLAMATION_H
+#define AISDI_MAPS_RECLAMATION_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace aisdi {
+
+    /**
+     * Node removed from a concurrent structure, waiting until no reader can hold it.
+     */
+    struct RetiredPointer {
+        void *pointer;
+        void (*deleter)(void *);
+        std::uint64_t epoch;
+
+        void destroy() const {
+            deleter(pointer);
+        }
+    };
+
+    /**
+     * Lock-free list of per-thread records. Records are never unlinked, a thread leaving the domain
+     * only marks its record free so the next registering thread can reuse it.
+     */
+    template<typename Record>
+    class ThreadRecordList {
+    public:
+        ThreadRecordList() : head(nullptr), count(0) {}
+
+        ThreadRecordList(const ThreadRecordList &) = delete;
+
+        ThreadRecordList &operator=(const ThreadRecordList &) = delete;
+
+        ~ThreadRecordList() {
+            auto record = head.load();
+            while (record != nullptr) {
+                auto next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+
+        Record *acquire() {
+            for (auto record = head.load(); record != nullptr; record = record->next) {
+                bool expected = false;
+                if (!record->inUse.load() && record->inUse.compare_exchange_strong(expected, true)) {
+                    return record;
+                }
+            }
+            auto record = new Record();
+            record->inUse.store(true);
+            record->next = head.load();
+            while (!head.compare_exchange_weak(record->next, record)) {}
+            ++count;
+            return record;
+        }
+
+        void release(Record *record) {
+            record->inUse.store(false);
+        }
+
+        template<typename Visitor>
+        void forEach(Visitor visitor) const {
+            for (auto record = head.load(); record != nullptr; record = record->next) {
+                visitor(*record);
+            }
+        }
+
+        std::size_t getCount() const {
+            return count.load();
+        }
+
+    private:
+        std::atomic<Record *> head;
+        std::atomic<std::size_t> count;
+    };
+
+    /**
+     * Epoch-based reclamation. Readers pin the current epoch for the duration of an operation,
+     * pointers retired in epoch e are freed once the global epoch reaches e + 2, which requires
+     * every pinned reader to have observed e + 1.
+     *
+     * Read side costs one store and one fence per pin; a reader stalled while pinned delays all
+     * reclamation, so garbage is bounded only while readers make progress.
+     */
+    class EpochDomain {
+        struct Record {
+            Record() : announced(0), inUse(false), next(nullptr), pinDepth(0) {}
+
+            // (epoch << 1) | 1 while pinned, 0 otherwise
+            std::atomic<std::uint64_t> announced;
+            std::atomic<bool> inUse;
+            Record *next;
+            std::size_t pinDepth;
+            std::vector<RetiredPointer> retired;
+        };
+
+    public:
+        using size_type = std::size_t;
+
+        static const size_type RETIRE_THRESHOLD = 64;
+
+        class Guard;
+
+        class Handle;
+
+        EpochDomain() : globalEpoch(0) {}
+
+        EpochDomain(const EpochDomain &) = delete;
+
+        EpochDomain &operator=(const EpochDomain &) = delete;
+
+        /**
+         * Must only be destroyed once no thread uses the domain.
+         */
+        ~EpochDomain() {
+            records.forEach([](Record &record) {
+                for (const auto &retired : record.retired) {
+                    retired.destroy();
+                }
+            });
+            for (const auto &retired : orphans) {
+                retired.destroy();
+            }
+        }
+
+        Handle registerThread();
+
+        std::uint64_t getEpoch() const {
+            return globalEpoch.load();
+        }
+
+    private:
+        std::atomic<std::uint64_t> globalEpoch;
+        ThreadRecordList<Record> records;
+        std::mutex orphansLock;
+        std::vector<RetiredPointer> orphans;
+
+        void pin(Record &record) {
+            if (record.pinDepth++ > 0) {
+                return;
+            }
+            std::uint64_t epoch;
+            do {
+                epoch = globalEpoch.load();
+                record.announced.store((epoch << 1) | 1);
+            } while (globalEpoch.load() != epoch);
+        }
+
+        void unpin(Record &record) {
+            if (--record.pinDepth == 0) {
+                record.announced.store(0, std::memory_order_release);
+            }
+        }
+
+        bool tryAdvance() {
+            auto epoch = globalEpoch.load();
+            bool lagging = false;
+            records.forEach([epoch, &lagging](const Record &record) {
+                const auto announced = record.announced.load();
+                if ((announced & 1) != 0 && (announced >> 1) != epoch) {
+                    lagging = true;
+                }
+            });
+            return !lagging && globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+        }
+
+        static void freeExpired(std::vector<RetiredPointer> &retired, std::uint64_t epoch) {
+            auto expired = std::partition(retired.begin(), retired.end(), [epoch](const RetiredPointer &r) {
+                return r.epoch + 2 > epoch;
+            });
+            std::for_each(expired, retired.end(), [](const RetiredPointer &r) { r.destroy(); });
+            retired.erase(expired, retired.end());
+        }
+
+        void collect(Record &record) {
+            tryAdvance();
+            const auto epoch = globalEpoch.load();
+            freeExpired(record.retired, epoch);
+            std::unique_lock<std::mutex> lock(orphansLock, std::try_to_lock);
+            if (lock.owns_lock()) {
+                freeExpired(orphans, epoch);
+            }
+        }
+
+        void retire(Record &record, const RetiredPointer &retired) {
+            record.retired.push_back(retired);
+            record.retired.back().epoch = globalEpoch.load();
+            if (record.retired.size() >= RETIRE_THRESHOLD) {
+                collect(record);
+            }
+        }
+
+        void leave(Record *record) {
+            {
+                std::lock_guard<std::mutex> lock(orphansLock);
+                orphans.insert(orphans.end(), record->retired.begin(), record->retired.end());
+            }
+            record->retired.clear();
+            record->announced.store(0);
+            record->pinDepth = 0;
+            records.release(record);
+        }
+    };
+
+    /**
+     * Keeps the owning thread's epoch pinned while alive. Pointers loaded from a concurrent
+     * structure stay valid until the guard is destroyed.
+     */
+    class EpochDomain::Guard {
+    public:
+        Guard(EpochDomain &domain, Record &record) : domain(&domain), record(&record) {
+            domain.pin(record);
+        }
+
+        Guard(Guard &&other) : domain(other.domain), record(other.record) {
+            other.record = nullptr;
+        }
+
+        Guard(const Guard &) = delete;
+
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard() {
+            if (record != nullptr) {
+                domain->unpin(*record);
+            }
+        }
+
+    private:
+        EpochDomain *domain;
+        Record *record;
+    };
+
+    /**
+     * Per-thread membership in an EpochDomain. Not to be shared between threads.
+     */
+    class EpochDomain::Handle {
+    public:
+        explicit Handle(EpochDomain &domain) : domain(&domain), record(domain.records.acquire()) {}
+
+        Handle(Handle &&other) : domain(other.domain), record(other.record) {
+            other.record = nullptr;
+        }
+
+        Handle(const Handle &) = delete;
+
+        Handle &operator=(const Handle &) = delete;
+
+        ~Handle() {
+            if (record != nullptr) {
+                domain->leave(record);
+            }
+        }
+
+        Guard pin() {
+            return Guard(*domain, *record);
+        }
+
+        template<typename T>
+        void retire(T *pointer) {
+            domain->retire(*record, RetiredPointer{pointer, [](void *p) { delete static_cast<T *>(p); }, 0});
+        }
+
+        void collect() {
+            domain->collect(*record);
+        }
+
+        size_type getRetiredCount() const {
+            return record->retired.size();
+        }
+
+    private:
+        EpochDomain *domain;
+        Record *record;
+    };
+
+    inline EpochDomain::Handle EpochDomain::registerThread() {
+        return Handle(*this);
+    }
+
+    /**
+     * Hazard pointer reclamation. Readers publish every pointer they are about to dereference in one
+     * of their slots; a retired pointer is freed once no slot holds it.
+     *
+     * Read side costs a store and a re-validating load per protected pointer, but a stalled reader
+     * holds back only the nodes it protects: each thread keeps at most
+     * max(RETIRE_THRESHOLD, 2 * SLOTS_PER_THREAD * threads) retired pointers.
+     */
+    class HazardPointerDomain {
+    public:
+        using size_type = std::size_t;
+
+        static const size_type SLOTS_PER_THREAD = 4;
+        static const size_type RETIRE_THRESHOLD = 64;
+
+    private:
+        struct Record {
+            Record() : inUse(false), next(nullptr) {
+                for (auto &hazard : hazards) {
+                    hazard.store(nullptr);
+                }
+            }
+
+            std::array<std::atomic<void *>, SLOTS_PER_THREAD> hazards;
+            std::atomic<bool> inUse;
+            Record *next;
+            std::vector<RetiredPointer> retired;
+        };
+
+    public:
+        class Handle;
+
+        HazardPointerDomain() = default;
+
+        HazardPointerDomain(const HazardPointerDomain &) = delete;
+
+        HazardPointerDomain &operator=(const HazardPointerDomain &) = delete;
+
+        /**
+         * Must only be destroyed once no thread uses the domain.
+         */
+        ~HazardPointerDomain() {
+            records.forEach([](Record &record) {
+                for (const auto &retired : record.retired) {
+                    retired.destroy();
+                }
+            });
+            for (const auto &retired : orphans) {
+                retired.destroy();
+            }
+        }
+
+        Handle registerThread();
+
+    private:
+        ThreadRecordList<Record> records;
+        std::mutex orphansLock;
+        std::vector<RetiredPointer> orphans;
+
+        void freeUnprotected(std::vector<RetiredPointer> &retired) {
+            std::vector<void *> protectedPointers;
+            records.forEach([&protectedPointers](const Record &record) {
+                for (const auto &hazard : record.hazards) {
+                    if (auto pointer = hazard.load()) {
+                        protectedPointers.push_back(pointer);
+                    }
+                }
+            });
+            std::sort(protectedPointers.begin(), protectedPointers.end());
+
+            auto unprotected = std::partition(retired.begin(), retired.end(), [&](const RetiredPointer &r) {
+                return std::binary_search(protectedPointers.begin(), protectedPointers.end(), r.pointer);
+            });
+            std::for_each(unprotected, retired.end(), [](const RetiredPointer &r) { r.destroy(); });
+            retired.erase(unprotected, retired.end());
+        }
+
+        void collect(Record &record) {
+            freeUnprotected(record.retired);
+            std::unique_lock<std::mutex> lock(orphansLock, std::try_to_lock);
+            if (lock.owns_lock()) {
+                freeUnprotected(orphans);
+            }
+        }
+
+        void retire(Record &record, const RetiredPointer &retired) {
+            record.retired.push_back(retired);
+            const auto threshold = std::max(RETIRE_THRESHOLD + 0, 2 * SLOTS_PER_THREAD * records.getCount());
+            if (record.retired.size() >= threshold) {
+                collect(record);
+            }
+        }
+
+        void leave(Record *record) {
+            for (auto &hazard : record->hazards) {
+                hazard.store(nullptr);
+            }
+            {
+                std::lock_guard<std::mutex> lock(orphansLock);
+                orphans.insert(orphans.end(), record->retired.begin(), record->retired.end());
+            }
+            record->retired.clear();
+            records.release(record);
+        }
+    };
+
+    /**
+     * Per-thread membership in a HazardPointerDomain. Not to be shared between threads.
+     */
+    class HazardPointerDomain::Handle {
+    public:
+        explicit Handle(HazardPointerDomain &domain) : domain(&domain), record(domain.records.acquire()) {}
+
+        Handle(Handle &&other) : domain(other.domain), record(other.record) {
+            other.record = nullptr;
+        }
+
+        Handle(const Handle &) = delete;
+
+        Handle &operator=(const Handle &) = delete;
+
+        ~Handle() {
+            if (record != nullptr) {
+                domain->leave(record);
+            }
+        }
+
+        /**
+         * Loads source and publishes the result in the given slot, retrying until the published
+         * pointer is still the current one - only then it cannot have been retired before publishing.
+         */
+        template<typename T>
+        T *protect(size_type slot, const std::atomic<T *> &source) {
+            auto &hazard = hazardAt(slot);
+            auto pointer = source.load();
+            while (true) {
+                hazard.store(pointer);
+                auto reloaded = source.load();
+                if (reloaded == pointer) {
+                    return pointer;
+                }
+                pointer = reloaded;
+            }
+        }
+
+        void clear(size_type slot) {
+            hazardAt(slot).store(nullptr, std::memory_order_release);
+        }
+
+        template<typename T>
+        void retire(T *pointer) {
+            domain->retire(*record, RetiredPointer{pointer, [](void *p) { delete static_cast<T *>(p); }, 0});
+        }
+
+        void collect() {
+            domain->collect(*record);
+        }
+
+        size_type getRetiredCount() const {
+            return record->retired.size();
+        }
+
+    private:
+        HazardPointerDomain *domain;
+        Record *record;
+
+        std::atomic<void *> &hazardAt(size_type slot) {
+            if (slot >= SLOTS_PER_THREAD) {
+                throw std::out_of_range("Hazard pointer slot out of range");
+            }
+            return record->hazards[slot];
+        }
+    };
+
+    inline HazardPointerDomain::Handle HazardPointerDomain::registerThread() {
+        return Handle(*this);
+    }
+
+}
+
+#endif /* AISDI_MAPS_RECLAMATION_H */
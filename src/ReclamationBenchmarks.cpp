@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+#include "Benchmark.h"
+#include "Reclamation.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t READS = 2000000;
+            const std::size_t RETIRES = 200000;
+
+            struct Node {
+                explicit Node(std::size_t value) : value(value) {}
+
+                std::size_t value;
+            };
+
+            /**
+             * Reads a shared pointer READS times, optionally while another thread keeps replacing it.
+             */
+            template<typename Read>
+            void measureReads(const std::string &name, std::atomic<Node *> &shared, Read read) {
+                report(measure("reclamation", name, READS, [&]() {
+                    std::size_t sum = 0;
+                    for (std::size_t i = 0; i < READS; ++i) {
+                        sum += read(shared);
+                    }
+                    consume(sum);
+                }));
+            }
+
+            template<typename Domain>
+            void measureRetires(const std::string &name) {
+                Domain domain;
+                auto handle = domain.registerThread();
+                report(measure("reclamation", name, RETIRES, [&]() {
+                    for (std::size_t i = 0; i < RETIRES; ++i) {
+                        handle.retire(new Node(i));
+                    }
+                }));
+            }
+
+            void measureReadSide(const std::string &suffix, std::atomic<Node *> &shared) {
+                measureReads("read raw pointer (unsafe)" + suffix, shared, [](std::atomic<Node *> &source) {
+                    return source.load()->value;
+                });
+
+                EpochDomain epochs;
+                auto epochHandle = epochs.registerThread();
+                measureReads("read with epoch pin" + suffix, shared, [&](std::atomic<Node *> &source) {
+                    auto guard = epochHandle.pin();
+                    return source.load()->value;
+                });
+
+                HazardPointerDomain hazards;
+                auto hazardHandle = hazards.registerThread();
+                measureReads("read with hazard pointer" + suffix, shared, [&](std::atomic<Node *> &source) {
+                    auto value = hazardHandle.protect(0, source)->value;
+                    hazardHandle.clear(0);
+                    return value;
+                });
+            }
+
+        }
+
+        void reclamationSuite() {
+            Node stable(1);
+            std::atomic<Node *> shared(&stable);
+            measureReadSide("", shared);
+
+            // a writer flipping between two nodes makes the reader's cache line bounce
+            Node other(2);
+            std::atomic<bool> done(false);
+            std::thread writer([&]() {
+                while (!done.load(std::memory_order_relaxed)) {
+                    shared.store(shared.load() == &stable ? &other : &stable);
+                    std::this_thread::yield();
+                }
+            });
+            measureReadSide(" +writer", shared);
+            done = true;
+            writer.join();
+
+            measureRetires<EpochDomain>("retire epoch");
+            measureRetires<HazardPointerDomain>("retire hazard pointer");
+        }
+
+    }
+}
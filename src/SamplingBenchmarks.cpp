@@ -0,0 +1,60 @@
+#include <cstddef>
+#include <random>
+#include <string>
+
+#include "Benchmark.h"
+#include "TreeMap.h"
+#include "HashMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t DRAWS = 10000;
+
+            template<typename Map>
+            void sampleMap(const std::string &mapName, std::size_t elements) {
+                Map map;
+                for (std::size_t i = 0; i < elements; ++i) {
+                    map[static_cast<int>(i * 2654435761u % 1000000007u)] = static_cast<int>(i);
+                }
+                const auto suffix = " " + mapName + " n=" + std::to_string(elements);
+
+                std::mt19937 generator(42);
+                report(measure("sampling", "iterate to random offset" + suffix, DRAWS, [&]() {
+                    std::uniform_int_distribution<std::size_t> offset(0, elements - 1);
+                    for (std::size_t i = 0; i < DRAWS; ++i) {
+                        auto it = map.cbegin();
+                        for (auto steps = offset(generator); steps > 0; --steps) {
+                            ++it;
+                        }
+                        consume(static_cast<std::size_t>(it->first));
+                    }
+                }));
+
+                report(measure("sampling", "randomEntry" + suffix, DRAWS, [&]() {
+                    for (std::size_t i = 0; i < DRAWS; ++i) {
+                        consume(static_cast<std::size_t>(map.randomEntry(generator)->first));
+                    }
+                }));
+
+                const std::size_t sampleSize = 16;
+                report(measure("sampling", "sample(16)" + suffix, DRAWS / sampleSize, [&]() {
+                    for (std::size_t i = 0; i < DRAWS / sampleSize; ++i) {
+                        consume(map.sample(sampleSize, generator).size());
+                    }
+                }));
+            }
+
+        }
+
+        void samplingSuite() {
+            for (std::size_t elements : {1000u, 20000u}) {
+                sampleMap<TreeMap<int, int>>("TreeMap", elements);
+                sampleMap<HashMap<int, int>>("HashMap", elements);
+            }
+        }
+
+    }
+}
@@ -0,0 +1,348 @@
+#ifndef AISDI_MAPS_SLOWOPERATIONS_H
+#define AISDI_MAPS_SLOWOPERATIONS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "HashMap.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+
+    /**
+     * Cheap timestamps: the time stamp counter on x86, which is constant-rate on any recent CPU,
+     * steady_clock nanoseconds elsewhere.
+     */
+    struct CycleClock {
+        static std::uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        /**
+         * Measured once, against steady_clock over a few milliseconds.
+         */
+        static double ticksPerNanosecond() {
+            static const double ticks = calibrate();
+            return ticks;
+        }
+
+    private:
+        static double calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+            const auto started = std::chrono::steady_clock::now();
+            const auto startTicks = now();
+            std::chrono::steady_clock::duration elapsed;
+            do {
+                elapsed = std::chrono::steady_clock::now() - started;
+            } while (elapsed < std::chrono::milliseconds(5));
+            const auto ticks = now() - startTicks;
+            return static_cast<double>(ticks) /
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+#else
+            return 1.0;
+#endif
+        }
+    };
+
+    enum class MonitoredOperation : std::uint8_t {
+        Access,
+        Find,
+        Remove
+    };
+
+    inline const char *monitoredOperationName(MonitoredOperation operation) {
+        switch (operation) {
+            case MonitoredOperation::Access:
+                return "access";
+            case MonitoredOperation::Find:
+                return "find";
+            case MonitoredOperation::Remove:
+                return "remove";
+        }
+        return "unknown";
+    }
+
+    struct SlowOperation {
+        // position among all slow operations recorded by the log
+        std::uint64_t sequence;
+        MonitoredOperation operation;
+        std::uint64_t keyHash;
+        // chain length for HashMap, nodes visited for TreeMap, 0 where unknown
+        std::uint64_t probeLength;
+        std::uint64_t nanoseconds;
+    };
+
+    /**
+     * Lock-free ring buffer of operations slower than a threshold, keeping the most recent ones.
+     *
+     * A writer takes a ticket, then claims its slot by moving the slot's sequence from even to
+     * odd, writes the fields and makes the sequence even again. A writer finding the slot being
+     * written, or already taken by a later ticket, drops its record rather than wait. dump()
+     * copies a slot and keeps the copy only if the sequence was even and unchanged around it.
+     * Recording never blocks and allocates nothing; dump() may run at any time.
+     */
+    class SlowOperationLog {
+    public:
+        /**
+         * Capacity is rounded up to a power of two.
+         */
+        explicit SlowOperationLog(std::uint64_t thresholdNanoseconds = 100000, std::size_t capacity = 1024)
+                : threshold(static_cast<std::uint64_t>(thresholdNanoseconds * CycleClock::ticksPerNanosecond())),
+                  mask(roundUp(capacity) - 1), slots(new Slot[mask + 1]), tickets(0), dropped(0) {}
+
+        SlowOperationLog(const SlowOperationLog &) = delete;
+
+        SlowOperationLog &operator=(const SlowOperationLog &) = delete;
+
+        std::uint64_t thresholdTicks() const {
+            return threshold;
+        }
+
+        void record(MonitoredOperation operation, std::uint64_t keyHash, std::uint64_t probeLength,
+                    std::uint64_t ticks) {
+            const auto ticket = tickets.fetch_add(1, std::memory_order_relaxed);
+            auto &slot = slots[ticket & mask];
+            auto sequence = slot.sequence.load(std::memory_order_relaxed);
+            if ((sequence & 1) != 0 || sequence > 2 * ticket ||
+                !slot.sequence.compare_exchange_strong(sequence, 2 * ticket + 1, std::memory_order_relaxed)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.operation.store(static_cast<std::uint64_t>(operation), std::memory_order_relaxed);
+            slot.keyHash.store(keyHash, std::memory_order_relaxed);
+            slot.probeLength.store(probeLength, std::memory_order_relaxed);
+            slot.ticks.store(ticks, std::memory_order_relaxed);
+            slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+        }
+
+        /**
+         * Records still in the buffer, oldest first. Those being written or overwritten are left out.
+         */
+        std::vector<SlowOperation> dump() const {
+            const auto last = tickets.load(std::memory_order_acquire);
+            const auto first = last > mask + 1 ? last - (mask + 1) : 0;
+            const auto ticksPerNanosecond = CycleClock::ticksPerNanosecond();
+            std::vector<SlowOperation> records;
+            for (auto ticket = first; ticket < last; ++ticket) {
+                const auto &slot = slots[ticket & mask];
+                if (slot.sequence.load(std::memory_order_acquire) != 2 * ticket + 2) {
+                    continue;
+                }
+                SlowOperation record;
+                record.sequence = ticket;
+                record.operation = static_cast<MonitoredOperation>(slot.operation.load(std::memory_order_relaxed));
+                record.keyHash = slot.keyHash.load(std::memory_order_relaxed);
+                record.probeLength = slot.probeLength.load(std::memory_order_relaxed);
+                record.nanoseconds = static_cast<std::uint64_t>(slot.ticks.load(std::memory_order_relaxed) /
+                                                                ticksPerNanosecond);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == 2 * ticket + 2) {
+                    records.push_back(record);
+                }
+            }
+            return records;
+        }
+
+        /**
+         * dump() as text, one operation per line.
+         */
+        void write(std::ostream &out) const {
+            for (const auto &record : dump()) {
+                out << '#' << record.sequence << ' ' << monitoredOperationName(record.operation)
+                    << " hash=" << record.keyHash << " probe=" << record.probeLength
+                    << " ns=" << record.nanoseconds << '\n';
+            }
+        }
+
+        /**
+         * Slow operations seen so far, including those overwritten or dropped.
+         */
+        std::uint64_t getRecordCount() const {
+            return tickets.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t getDroppedCount() const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // fields are atomic so that dump() racing with a writer is well defined
+        struct Slot {
+            std::atomic<std::uint64_t> sequence;
+            std::atomic<std::uint64_t> operation;
+            std::atomic<std::uint64_t> keyHash;
+            std::atomic<std::uint64_t> probeLength;
+            std::atomic<std::uint64_t> ticks;
+
+            Slot() : sequence(0), operation(0), keyHash(0), probeLength(0), ticks(0) {}
+        };
+
+        const std::uint64_t threshold;
+        const std::uint64_t mask;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<std::uint64_t> tickets;
+        std::atomic<std::uint64_t> dropped;
+
+        static std::uint64_t roundUp(std::size_t capacity) {
+            std::uint64_t rounded = 1;
+            while (rounded < capacity) {
+                rounded <<= 1;
+            }
+            return rounded;
+        }
+    };
+
+    /*
+     * How far a lookup of a key walks, asked only once an operation was found slow.
+     */
+
+    template<typename Map>
+    std::uint64_t probeLength(const Map &, const typename Map::key_type &) {
+        return 0;
+    }
+
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    std::uint64_t probeLength(const HashMap<KeyType, ValueType, ErrorPolicy> &map, const KeyType &key) {
+        return map.bucketLength(key);
+    }
+
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    std::uint64_t probeLength(const TreeMap<KeyType, ValueType, ErrorPolicy> &map, const KeyType &key) {
+        return map.depthOf(key);
+    }
+
+    /**
+     * Map wrapper timing every keyed operation with CycleClock and recording those slower than the
+     * log's threshold, with the key hash and the probe length of the map after the operation.
+     * The unwrapped map pays nothing; the wrapper pays two counter reads per operation.
+     */
+    template<typename Map>
+    class MonitoredMap {
+    public:
+        using key_type = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+        using size_type = typename Map::size_type;
+        using iterator = typename Map::iterator;
+        using const_iterator = typename Map::const_iterator;
+
+        MonitoredMap(Map &map, SlowOperationLog &log) : map(map), log(log) {}
+
+        mapped_type &operator[](const key_type &key) {
+            Timer timer(*this, MonitoredOperation::Access, key);
+            return map[key];
+        }
+
+        /**
+         * Same as (*this)[key] = value, with the assignment timed too.
+         */
+        void assign(const key_type &key, const mapped_type &value) {
+            Timer timer(*this, MonitoredOperation::Access, key);
+            map[key] = value;
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            Timer timer(*this, MonitoredOperation::Find, key);
+            return static_cast<const Map &>(map).valueOf(key);
+        }
+
+        mapped_type &valueOf(const key_type &key) {
+            Timer timer(*this, MonitoredOperation::Find, key);
+            return map.valueOf(key);
+        }
+
+        const_iterator find(const key_type &key) const {
+            Timer timer(*this, MonitoredOperation::Find, key);
+            return static_cast<const Map &>(map).find(key);
+        }
+
+        iterator find(const key_type &key) {
+            Timer timer(*this, MonitoredOperation::Find, key);
+            return map.find(key);
+        }
+
+        void remove(const key_type &key) {
+            Timer timer(*this, MonitoredOperation::Remove, key);
+            map.remove(key);
+        }
+
+        void remove(const const_iterator &it) {
+            if (it == static_cast<const Map &>(map).end()) {
+                map.remove(it);
+                return;
+            }
+            const key_type key = (*it).first;
+            Timer timer(*this, MonitoredOperation::Remove, key);
+            map.remove(it);
+        }
+
+        size_type getSize() const {
+            return map.getSize();
+        }
+
+        bool isEmpty() const {
+            return map.isEmpty();
+        }
+
+        iterator begin() {
+            return map.begin();
+        }
+
+        iterator end() {
+            return map.end();
+        }
+
+        const_iterator begin() const {
+            return static_cast<const Map &>(map).begin();
+        }
+
+        const_iterator end() const {
+            return static_cast<const Map &>(map).end();
+        }
+
+    private:
+        Map &map;
+        SlowOperationLog &log;
+
+        /**
+         * Times its own lifetime, so operations leaving by an exception are recorded as well.
+         */
+        class Timer {
+        public:
+            Timer(const MonitoredMap &owner, MonitoredOperation operation, const key_type &key)
+                    : owner(owner), operation(operation), key(key), started(CycleClock::now()) {}
+
+            ~Timer() {
+                const auto ticks = CycleClock::now() - started;
+                if (ticks > owner.log.thresholdTicks()) {
+                    owner.log.record(operation, std::hash<key_type>{}(key),
+                                     probeLength(static_cast<const Map &>(owner.map), key), ticks);
+                }
+            }
+
+        private:
+            const MonitoredMap &owner;
+            const MonitoredOperation operation;
+            const key_type &key;
+            const std::uint64_t started;
+        };
+    };
+
+}
+
+#endif /* AISDI_MAPS_SLOWOPERATIONS_H */
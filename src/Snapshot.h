@@ -0,0 +1,134 @@
+#ifndef AISDI_MAPS_SNAPSHOT_H
+#define AISDI_MAPS_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ErrorPolicy.h"
+
+namespace aisdi {
+
+    /**
+     * Binary encoding of snapshot keys and values. Trivially copyable types are written as raw bytes
+     * in host order, strings as a 64-bit length followed by their characters. Specialize for other
+     * types.
+     */
+    template<typename T, typename Enable = void>
+    struct SnapshotCodec;
+
+    template<typename T>
+    struct SnapshotCodec<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+        static void write(std::ostream &out, const T &value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        static T read(std::istream &in) {
+            T value;
+            in.read(reinterpret_cast<char *>(&value), sizeof(T));
+            if (!in) {
+                raiseError(std::runtime_error("Truncated snapshot"));
+            }
+            return value;
+        }
+    };
+
+    template<>
+    struct SnapshotCodec<std::string> {
+        static void write(std::ostream &out, const std::string &value) {
+            SnapshotCodec<std::uint64_t>::write(out, value.size());
+            out.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        static std::string read(std::istream &in) {
+            std::string value(static_cast<std::size_t>(SnapshotCodec<std::uint64_t>::read(in)), '\0');
+            in.read(&value[0], static_cast<std::streamsize>(value.size()));
+            if (!in) {
+                raiseError(std::runtime_error("Truncated snapshot"));
+            }
+            return value;
+        }
+    };
+
+    enum class SnapshotKind : std::uint8_t {
+        Full = 0, Delta = 1
+    };
+
+    /**
+     * Common prefix of full and delta snapshots. A full snapshot starts a chain at some sequence
+     * number, each delta moves it from sequence to sequence + 1.
+     */
+    struct SnapshotHeader {
+        static const std::uint32_t VERSION = 1;
+
+        SnapshotKind kind;
+        std::uint64_t sequence;
+
+        void write(std::ostream &out) const {
+            out.write(magic(), MAGIC_LENGTH);
+            const std::uint32_t version = VERSION;
+            SnapshotCodec<std::uint32_t>::write(out, version);
+            SnapshotCodec<std::uint8_t>::write(out, static_cast<std::uint8_t>(kind));
+            SnapshotCodec<std::uint64_t>::write(out, sequence);
+        }
+
+        static SnapshotHeader read(std::istream &in) {
+            char found[MAGIC_LENGTH];
+            in.read(found, MAGIC_LENGTH);
+            if (!in || std::memcmp(found, magic(), MAGIC_LENGTH) != 0) {
+                raiseError(std::runtime_error("Not a map snapshot"));
+            }
+            if (SnapshotCodec<std::uint32_t>::read(in) != VERSION) {
+                raiseError(std::runtime_error("Unsupported snapshot version"));
+            }
+            const auto kind = SnapshotCodec<std::uint8_t>::read(in);
+            if (kind > static_cast<std::uint8_t>(SnapshotKind::Delta)) {
+                raiseError(std::runtime_error("Unknown snapshot kind"));
+            }
+            return SnapshotHeader{static_cast<SnapshotKind>(kind), SnapshotCodec<std::uint64_t>::read(in)};
+        }
+
+        /**
+         * Reads the header of a snapshot expected to continue from the given sequence number.
+         */
+        static SnapshotHeader readDelta(std::istream &in, std::uint64_t sequence) {
+            const auto header = read(in);
+            if (header.kind != SnapshotKind::Delta) {
+                raiseError(std::runtime_error("Expected a delta snapshot"));
+            }
+            if (header.sequence != sequence + 1) {
+                raiseError(std::runtime_error("Delta does not follow the loaded snapshot"));
+            }
+            return header;
+        }
+
+    private:
+        enum {
+            MAGIC_LENGTH = 8
+        };
+
+        static const char *magic() {
+            return "AISDISNP";
+        }
+    };
+
+    /**
+     * Restores a map from a full snapshot followed by the deltas written after it, in order.
+     * The map can go on writing deltas continuing the chain.
+     */
+    template<typename Map>
+    void loadSnapshotChain(Map &map, std::istream &base, const std::vector<std::istream *> &deltas) {
+        map.readSnapshot(base);
+        for (auto delta : deltas) {
+            map.applyDelta(*delta);
+        }
+    }
+
+}
+
+#endif /* AISDI_MAPS_SNAPSHOT_H */
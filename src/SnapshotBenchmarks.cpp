@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "Benchmark.h"
+#include "TreeMap.h"
+#include "HashMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const std::size_t TREE_ELEMENTS = 200000;
+
+            template<typename Map>
+            void snapshotMap(const std::string &mapName, std::size_t elements) {
+                Map map;
+                std::mt19937 generator(42);
+                for (std::size_t i = 0; i < elements; ++i) {
+                    map[static_cast<int>(generator())] = static_cast<int>(i);
+                }
+
+                std::ostringstream snapshot;
+                auto full = measure("snapshot", "", map.getSize(), [&]() {
+                    map.writeSnapshot(snapshot);
+                });
+                full.name = "full " + mapName + " bytes=" + std::to_string(snapshot.str().size());
+                report(full);
+
+                for (std::size_t permille : {1u, 10u, 100u}) {
+                    const std::size_t changes = elements * permille / 1000;
+                    for (std::size_t i = 0; i < changes; ++i) {
+                        map[static_cast<int>(generator())] = static_cast<int>(i);
+                    }
+                    std::ostringstream delta;
+                    auto result = measure("snapshot", "", changes, [&]() {
+                        map.writeDelta(delta);
+                    });
+                    result.name = "delta " + mapName + " changed=" + std::to_string(permille) +
+                                  "/1000 bytes=" + std::to_string(delta.str().size());
+                    report(result);
+                }
+            }
+
+        }
+
+        void snapshotSuite() {
+            snapshotMap<HashMap<int, int>>("HashMap", HASH_MAP_ELEMENTS);
+            snapshotMap<TreeMap<int, int>>("TreeMap", TREE_ELEMENTS);
+        }
+
+    }
+}
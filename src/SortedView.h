@@ -0,0 +1,278 @@
+#ifndef AISDI_MAPS_SORTEDVIEW_H
+#define AISDI_MAPS_SORTEDVIEW_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace aisdi {
+
+    /**
+     * Entries of a map in key order, held as pointers into the map: nothing else is copied, and
+     * the view is valid until the map is changed.
+     */
+    template<typename Entry>
+    class SortedView {
+    public:
+        using value_type = Entry;
+        using size_type = std::size_t;
+        using const_reference = const Entry &;
+
+        class ConstIterator {
+        public:
+            using reference = const Entry &;
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = Entry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Entry *;
+
+            explicit ConstIterator(typename std::vector<const Entry *>::const_iterator position)
+                    : position(position) {}
+
+            reference operator*() const {
+                return **position;
+            }
+
+            pointer operator->() const {
+                return *position;
+            }
+
+            ConstIterator &operator++() {
+                ++position;
+                return *this;
+            }
+
+            ConstIterator operator++(int) {
+                auto result = *this;
+                ++position;
+                return result;
+            }
+
+            ConstIterator &operator--() {
+                --position;
+                return *this;
+            }
+
+            ConstIterator operator--(int) {
+                auto result = *this;
+                --position;
+                return result;
+            }
+
+            bool operator==(const ConstIterator &other) const {
+                return position == other.position;
+            }
+
+            bool operator!=(const ConstIterator &other) const {
+                return position != other.position;
+            }
+
+        private:
+            typename std::vector<const Entry *>::const_iterator position;
+        };
+
+        using const_iterator = ConstIterator;
+
+        explicit SortedView(std::vector<const Entry *> entries) : entries(std::move(entries)) {}
+
+        const_reference operator[](size_type index) const {
+            return *entries[index];
+        }
+
+        size_type getSize() const {
+            return entries.size();
+        }
+
+        bool isEmpty() const {
+            return entries.empty();
+        }
+
+        const_iterator begin() const {
+            return const_iterator(entries.begin());
+        }
+
+        const_iterator end() const {
+            return const_iterator(entries.end());
+        }
+
+    private:
+        std::vector<const Entry *> entries;
+    };
+
+    /**
+     * Sorts pointers to map entries by key. Integer keys go through an LSD radix sort, one byte
+     * per pass, of (key, pointer) pairs, so the entries themselves are read once; passes where
+     * every key has the same byte are skipped. Other keys are compared through the pointers, with
+     * std::sort, or with a pool by a sample sort: splitters picked from a sorted sample cut the
+     * entries into one bucket per worker, and the buckets are sorted concurrently.
+     */
+    template<typename Entry>
+    class EntrySort {
+    public:
+        using key_type = typename std::remove_const<typename Entry::first_type>::type;
+        using size_type = std::size_t;
+
+        // smallest share of entries worth handing to a worker
+        static const size_type MIN_CHUNK = 16384;
+        // samples taken per bucket when picking splitters
+        static const size_type OVERSAMPLING = 64;
+
+        static void sort(std::vector<const Entry *> &entries, ThreadPool *pool) {
+            sortBy(entries, pool, std::integral_constant<bool, std::is_integral<key_type>::value &&
+                                                               !std::is_same<key_type, bool>::value>());
+        }
+
+    private:
+        static const size_type RADIX = 256;
+
+        struct Keyed {
+            std::uint64_t key;
+            const Entry *entry;
+        };
+
+        using Histogram = std::array<size_type, RADIX>;
+
+        static size_type chunksFor(size_type entries, ThreadPool *pool) {
+            if (pool == nullptr) {
+                return 1;
+            }
+            return std::max<size_type>(1, std::min(pool->getSize(), entries / MIN_CHUNK));
+        }
+
+        // order preserving: the sign bit is flipped so negative keys come first
+        static std::uint64_t radixKey(const key_type &key) {
+            using unsigned_type = typename std::make_unsigned<key_type>::type;
+            const auto bits = static_cast<unsigned_type>(key);
+            const auto sign = std::is_signed<key_type>::value
+                              ? static_cast<unsigned_type>(1) << (std::numeric_limits<unsigned_type>::digits - 1)
+                              : static_cast<unsigned_type>(0);
+            return static_cast<std::uint64_t>(static_cast<unsigned_type>(bits ^ sign));
+        }
+
+        static void sortBy(std::vector<const Entry *> &entries, ThreadPool *pool, std::true_type) {
+            const size_type count = entries.size();
+            const size_type chunks = chunksFor(count, pool);
+            const auto first = [count, chunks](size_type chunk) { return count * chunk / chunks; };
+
+            std::vector<Keyed> keyed(count);
+            parallelFor(pool, chunks, [&](size_type chunk) {
+                for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                    keyed[i] = Keyed{radixKey(entries[i]->first), entries[i]};
+                }
+            });
+
+            std::vector<Keyed> buffer(count);
+            std::vector<Histogram> histograms(chunks);
+            for (unsigned shift = 0; shift < 8 * sizeof(key_type); shift += 8) {
+                parallelFor(pool, chunks, [&](size_type chunk) {
+                    auto &histogram = histograms[chunk];
+                    histogram.fill(0);
+                    for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                        ++histogram[(keyed[i].key >> shift) & (RADIX - 1)];
+                    }
+                });
+
+                // offsets of every chunk's share of each digit, digits in order, chunks in order within them
+                size_type offset = 0;
+                bool skipped = false;
+                for (size_type digit = 0; digit < RADIX; ++digit) {
+                    size_type total = 0;
+                    for (auto &histogram : histograms) {
+                        const auto digitCount = histogram[digit];
+                        histogram[digit] = offset + total;
+                        total += digitCount;
+                    }
+                    skipped = skipped || total == count;
+                    offset += total;
+                }
+                if (skipped) {
+                    continue;
+                }
+
+                parallelFor(pool, chunks, [&](size_type chunk) {
+                    auto &positions = histograms[chunk];
+                    for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                        buffer[positions[(keyed[i].key >> shift) & (RADIX - 1)]++] = keyed[i];
+                    }
+                });
+                keyed.swap(buffer);
+            }
+
+            parallelFor(pool, chunks, [&](size_type chunk) {
+                for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                    entries[i] = keyed[i].entry;
+                }
+            });
+        }
+
+        static bool keyLess(const Entry *left, const Entry *right) {
+            return left->first < right->first;
+        }
+
+        static void sortBy(std::vector<const Entry *> &entries, ThreadPool *pool, std::false_type) {
+            const size_type count = entries.size();
+            const size_type buckets = chunksFor(count, pool);
+            if (buckets == 1) {
+                std::sort(entries.begin(), entries.end(), keyLess);
+                return;
+            }
+            const auto first = [count, buckets](size_type chunk) { return count * chunk / buckets; };
+
+            // entries are in hash order, so evenly spaced ones are a fair sample of the keys
+            std::vector<const Entry *> sample;
+            const size_type samples = std::min(count, buckets * OVERSAMPLING);
+            for (size_type i = 0; i < samples; ++i) {
+                sample.push_back(entries[count * i / samples]);
+            }
+            std::sort(sample.begin(), sample.end(), keyLess);
+            std::vector<const Entry *> splitters;
+            for (size_type bucket = 1; bucket < buckets; ++bucket) {
+                splitters.push_back(sample[samples * bucket / buckets]);
+            }
+
+            // every chunk counts, then scatters, its entries per bucket, as the radix passes do
+            std::vector<std::uint32_t> bucketOf(count);
+            std::vector<std::vector<size_type>> positions(buckets, std::vector<size_type>(buckets, 0));
+            parallelFor(pool, buckets, [&](size_type chunk) {
+                for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                    const auto bucket = std::upper_bound(splitters.begin(), splitters.end(), entries[i], keyLess) -
+                                        splitters.begin();
+                    bucketOf[i] = static_cast<std::uint32_t>(bucket);
+                    ++positions[chunk][bucket];
+                }
+            });
+            std::vector<size_type> bucketStarts(buckets + 1, 0);
+            for (size_type bucket = 0; bucket < buckets; ++bucket) {
+                bucketStarts[bucket + 1] = bucketStarts[bucket];
+                for (auto &chunkPositions : positions) {
+                    const auto bucketCount = chunkPositions[bucket];
+                    chunkPositions[bucket] = bucketStarts[bucket + 1];
+                    bucketStarts[bucket + 1] += bucketCount;
+                }
+            }
+            std::vector<const Entry *> scattered(count);
+            parallelFor(pool, buckets, [&](size_type chunk) {
+                for (size_type i = first(chunk); i < first(chunk + 1); ++i) {
+                    scattered[positions[chunk][bucketOf[i]]++] = entries[i];
+                }
+            });
+
+            parallelFor(pool, buckets, [&](size_type bucket) {
+                std::sort(scattered.begin() + bucketStarts[bucket], scattered.begin() + bucketStarts[bucket + 1],
+                          keyLess);
+            });
+            entries.swap(scattered);
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_SORTEDVIEW_H */
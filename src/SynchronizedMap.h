@@ -0,0 +1,243 @@
+#ifndef AISDI_MAPS_SYNCHRONIZEDMAP_H
+#define AISDI_MAPS_SYNCHRONIZEDMAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <stdexcept>
+
+#include <pthread.h>
+
+namespace aisdi {
+
+    /**
+     * Reader-writer lock over pthread_rwlock_t, since C++11 has no shared mutex. Writers are
+     * preferred where glibc allows choosing, so a stream of readers cannot starve them.
+     */
+    class SharedMutex {
+    public:
+        SharedMutex() {
+            pthread_rwlockattr_t attributes;
+            pthread_rwlockattr_init(&attributes);
+#if defined(__GLIBC__)
+            pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+            pthread_rwlock_init(&rwlock, &attributes);
+            pthread_rwlockattr_destroy(&attributes);
+        }
+
+        SharedMutex(const SharedMutex &) = delete;
+
+        SharedMutex &operator=(const SharedMutex &) = delete;
+
+        ~SharedMutex() {
+            pthread_rwlock_destroy(&rwlock);
+        }
+
+        void lock() {
+            pthread_rwlock_wrlock(&rwlock);
+        }
+
+        void unlock() {
+            pthread_rwlock_unlock(&rwlock);
+        }
+
+        void lock_shared() {
+            pthread_rwlock_rdlock(&rwlock);
+        }
+
+        void unlock_shared() {
+            pthread_rwlock_unlock(&rwlock);
+        }
+
+    private:
+        pthread_rwlock_t rwlock;
+    };
+
+    /**
+     * Scoped lock for reading: shared for SharedMutex, exclusive for any other mutex.
+     */
+    template<typename Mutex>
+    class ReadLock {
+    public:
+        explicit ReadLock(Mutex &mutex) : lock(mutex) {}
+
+    private:
+        std::lock_guard<Mutex> lock;
+    };
+
+    template<>
+    class ReadLock<SharedMutex> {
+    public:
+        explicit ReadLock(SharedMutex &mutex) : mutex(mutex) {
+            mutex.lock_shared();
+        }
+
+        ReadLock(const ReadLock &) = delete;
+
+        ReadLock &operator=(const ReadLock &) = delete;
+
+        ~ReadLock() {
+            mutex.unlock_shared();
+        }
+
+    private:
+        SharedMutex &mutex;
+    };
+
+    /**
+     * Thread-safe wrapper holding a TreeMap or HashMap behind a single lock, with the value-based
+     * interface of ConcurrentHashMap: iterators could not outlive the lock. With SharedMutex,
+     * readers run in parallel.
+     */
+    template<typename Map, typename Mutex = std::mutex>
+    class SynchronizedMap {
+    public:
+        using key_type = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+        using value_type = typename Map::value_type;
+        using size_type = typename Map::size_type;
+
+        SynchronizedMap() = default;
+
+        SynchronizedMap(std::initializer_list<value_type> list) {
+            for (const auto &entry : list) {
+                insertOrAssign(entry.first, entry.second);
+            }
+        }
+
+        SynchronizedMap(const SynchronizedMap &) = delete;
+
+        SynchronizedMap &operator=(const SynchronizedMap &) = delete;
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        size_type getSize() const {
+            ReadLock<Mutex> lock(mutex);
+            return map.getSize();
+        }
+
+        /**
+         * Returns true when the key was not present before.
+         */
+        bool insertOrAssign(const key_type &key, const mapped_type &value) {
+            std::lock_guard<Mutex> lock(mutex);
+            return assign(map, key, value);
+        }
+
+        mapped_type valueOf(const key_type &key) const {
+            ReadLock<Mutex> lock(mutex);
+            return map.valueOf(key);
+        }
+
+        bool contains(const key_type &key) const {
+            ReadLock<Mutex> lock(mutex);
+            return map.find(key) != map.end();
+        }
+
+        void remove(const key_type &key) {
+            std::lock_guard<Mutex> lock(mutex);
+            map.remove(key);
+        }
+
+    private:
+        mutable Mutex mutex;
+        Map map;
+
+        static bool assign(Map &map, const key_type &key, const mapped_type &value) {
+            const auto sizeBefore = map.getSize();
+            map[key] = value;
+            return map.getSize() != sizeBefore;
+        }
+    };
+
+    /**
+     * Thread-safe wrapper splitting keys by hash over STRIPES maps, each behind its own lock, so
+     * operations on different stripes do not contend.
+     */
+    template<typename Map, std::size_t STRIPES = 16, typename Mutex = std::mutex>
+    class StripedMap {
+    public:
+        using key_type = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+        using value_type = typename Map::value_type;
+        using size_type = typename Map::size_type;
+
+        StripedMap() = default;
+
+        StripedMap(std::initializer_list<value_type> list) {
+            for (const auto &entry : list) {
+                insertOrAssign(entry.first, entry.second);
+            }
+        }
+
+        StripedMap(const StripedMap &) = delete;
+
+        StripedMap &operator=(const StripedMap &) = delete;
+
+        bool isEmpty() const {
+            return getSize() == 0;
+        }
+
+        /**
+         * Sum over the stripes, each read under its own lock, so not a snapshot while writers run.
+         */
+        size_type getSize() const {
+            size_type size = 0;
+            for (const auto &stripe : stripes) {
+                ReadLock<Mutex> lock(stripe.mutex);
+                size += stripe.map.getSize();
+            }
+            return size;
+        }
+
+        bool insertOrAssign(const key_type &key, const mapped_type &value) {
+            auto &stripe = stripes[stripeOf(key)];
+            std::lock_guard<Mutex> lock(stripe.mutex);
+            const auto sizeBefore = stripe.map.getSize();
+            stripe.map[key] = value;
+            return stripe.map.getSize() != sizeBefore;
+        }
+
+        mapped_type valueOf(const key_type &key) const {
+            const auto &stripe = stripes[stripeOf(key)];
+            ReadLock<Mutex> lock(stripe.mutex);
+            return stripe.map.valueOf(key);
+        }
+
+        bool contains(const key_type &key) const {
+            const auto &stripe = stripes[stripeOf(key)];
+            ReadLock<Mutex> lock(stripe.mutex);
+            return stripe.map.find(key) != stripe.map.end();
+        }
+
+        void remove(const key_type &key) {
+            auto &stripe = stripes[stripeOf(key)];
+            std::lock_guard<Mutex> lock(stripe.mutex);
+            stripe.map.remove(key);
+        }
+
+    private:
+        // one cache line per lock, or neighbouring stripes would contend anyway
+        struct alignas(64) Stripe {
+            mutable Mutex mutex;
+            Map map;
+        };
+
+        std::array<Stripe, STRIPES> stripes;
+
+        static std::size_t stripeOf(const key_type &key) {
+            // HashMap buckets by the same hash, so mix it before picking a stripe
+            const auto hash = static_cast<std::uint64_t>(std::hash<key_type>{}(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(hash >> 32) % STRIPES;
+        }
+    };
+
+}
+
+#endif /* AISDI_MAPS_SYNCHRONIZEDMAP_H */
@@ -0,0 +1,141 @@
+#ifndef AISDI_MAPS_THREADPOOL_H
+#define AISDI_MAPS_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aisdi {
+
+    /**
+     * Fixed set of worker threads executing submitted tasks in FIFO order.
+     * Destruction waits for all queued tasks to finish.
+     */
+    class ThreadPool {
+    public:
+        using size_type = std::size_t;
+
+        explicit ThreadPool(size_type threads = std::thread::hardware_concurrency()) : stopping(false) {
+            threads = std::max<size_type>(threads, 1);
+            workers.reserve(threads);
+            for (size_type i = 0; i < threads; ++i) {
+                workers.emplace_back([this]() { work(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeUp.notify_all();
+            for (auto &worker : workers) {
+                worker.join();
+            }
+        }
+
+        template<typename Task>
+        std::future<typename std::result_of<Task()>::type> submit(Task task) {
+            using result_type = typename std::result_of<Task()>::type;
+            // std::function requires copyable targets, packaged_task is move-only
+            auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::move(task));
+            auto result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace([packaged]() { (*packaged)(); });
+            }
+            wakeUp.notify_one();
+            return result;
+        }
+
+        size_type getSize() const {
+            return workers.size();
+        }
+
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        bool stopping;
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wakeUp.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                    if (tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+    };
+
+    /**
+     * Waits for every future, then rethrows the first exception any of them holds: tasks usually
+     * write into the caller's objects, so none may still run once the caller unwinds.
+     */
+    template<typename Result>
+    void waitAll(std::vector<std::future<Result>> &futures) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+        std::exception_ptr first;
+        for (auto &future : futures) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!first) {
+                    first = std::current_exception();
+                }
+            }
+        }
+        if (first) {
+            std::rethrow_exception(first);
+        }
+#else
+        for (auto &future : futures) {
+            future.get();
+        }
+#endif
+    }
+
+    /**
+     * Runs task(0) .. task(count - 1), on the pool's workers when there is one, and returns once
+     * all of them finished.
+     */
+    template<typename Task>
+    void parallelFor(ThreadPool *pool, std::size_t count, Task task) {
+        if (pool == nullptr || count == 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        std::vector<std::future<void>> done;
+        done.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            done.push_back(pool->submit([&task, i]() { task(i); }));
+        }
+        waitAll(done);
+    }
+
+}
+
+#endif /* AISDI_MAPS_THREADPOOL_H */
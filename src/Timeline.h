@@ -0,0 +1,217 @@
+#ifndef AISDI_MAPS_TIMELINE_H
+#define AISDI_MAPS_TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aisdi {
+
+    struct TimelineEvent {
+        const char *category;
+        std::string name;
+        // nanoseconds since the recording started
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    /**
+     * Records spans of time, per thread, and writes them as Chrome trace event JSON, which
+     * chrome://tracing and ui.perfetto.dev open. Recording is off until start(); while it is off a
+     * span costs one atomic load.
+     *
+     * Each thread appends to its own buffer, under a mutex only write() ever contends for.
+     * Buffers outlive their threads, so spans of finished workers are written too. A thread keeps
+     * at most MAX_THREAD_EVENTS events, later ones are counted as dropped.
+     */
+    class Timeline {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static const std::size_t MAX_THREAD_EVENTS = 1 << 20;
+
+        /**
+         * Discards events recorded so far and starts recording.
+         */
+        static void start() {
+            auto &timeline = instance();
+            std::lock_guard<std::mutex> lock(timeline.mutex);
+            for (auto &buffer : timeline.buffers) {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                buffer->events.clear();
+                buffer->dropped = 0;
+            }
+            timeline.origin.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            timeline.recording.store(true, std::memory_order_release);
+        }
+
+        static void stop() {
+            instance().recording.store(false, std::memory_order_release);
+        }
+
+        static bool isRecording() {
+            return instance().recording.load(std::memory_order_acquire);
+        }
+
+        static void record(const char *category, std::string name, clock::time_point started) {
+            auto &timeline = instance();
+            const auto ended = clock::now();
+            auto &buffer = threadBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            if (buffer.events.size() >= MAX_THREAD_EVENTS) {
+                ++buffer.dropped;
+                return;
+            }
+            const clock::time_point origin(clock::duration(timeline.origin.load(std::memory_order_relaxed)));
+            buffer.events.push_back(TimelineEvent{category, std::move(name), nanosecondsSince(origin, started),
+                                                  nanosecondsSince(started, ended)});
+        }
+
+        /**
+         * Writes every event recorded since start() as a JSON object with a traceEvents array of
+         * complete ("X") events, in microseconds, one tid per recording thread.
+         */
+        static void write(std::ostream &out) {
+            auto &timeline = instance();
+            std::lock_guard<std::mutex> lock(timeline.mutex);
+            std::uint64_t dropped = 0;
+            bool first = true;
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            for (std::size_t tid = 0; tid < timeline.buffers.size(); ++tid) {
+                auto &buffer = *timeline.buffers[tid];
+                std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+                if (buffer.events.empty()) {
+                    continue;
+                }
+                out << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+                    << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+                first = false;
+                for (const auto &event : buffer.events) {
+                    out << ",\n{\"ph\":\"X\",\"cat\":\"" << event.category << "\",\"name\":\"";
+                    writeEscaped(out, event.name);
+                    out << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << microseconds(event.start)
+                        << ",\"dur\":" << microseconds(event.duration) << '}';
+                }
+                dropped += buffer.dropped;
+            }
+            out << "\n],\"otherData\":{\"droppedEvents\":\"" << dropped << "\"}}\n";
+        }
+
+    private:
+        struct Buffer {
+            std::mutex mutex;
+            std::vector<TimelineEvent> events;
+            std::uint64_t dropped = 0;
+        };
+
+        std::atomic<bool> recording;
+        // clock ticks of the start() call
+        std::atomic<clock::rep> origin;
+        // guards the list of buffers, each buffer has its own mutex for its events
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Buffer>> buffers;
+
+        Timeline() : recording(false), origin(clock::now().time_since_epoch().count()) {}
+
+        static Timeline &instance() {
+            static Timeline timeline;
+            return timeline;
+        }
+
+        static Buffer &threadBuffer() {
+            static thread_local std::shared_ptr<Buffer> buffer;
+            if (!buffer) {
+                buffer = std::make_shared<Buffer>();
+                auto &timeline = instance();
+                std::lock_guard<std::mutex> lock(timeline.mutex);
+                timeline.buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        static std::int64_t nanosecondsSince(clock::time_point from, clock::time_point to) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+        }
+
+        static std::string microseconds(std::int64_t nanoseconds) {
+            char formatted[32];
+            std::snprintf(formatted, sizeof(formatted), "%.3f", nanoseconds / 1000.0);
+            return formatted;
+        }
+
+        static void writeEscaped(std::ostream &out, const std::string &text) {
+            for (const auto c : text) {
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+        }
+    };
+
+    /**
+     * Records the time between its construction and destruction, if the timeline was recording
+     * when it was constructed.
+     */
+    class TimelineSpan {
+    public:
+        TimelineSpan(const char *category, const char *name) : category(category), active(Timeline::isRecording()) {
+            if (active) {
+                this->name = name;
+                started = Timeline::clock::now();
+            }
+        }
+
+        TimelineSpan(const char *category, const std::string &name)
+                : category(category), active(Timeline::isRecording()) {
+            if (active) {
+                this->name = name;
+                started = Timeline::clock::now();
+            }
+        }
+
+        TimelineSpan(const TimelineSpan &) = delete;
+
+        TimelineSpan &operator=(const TimelineSpan &) = delete;
+
+        ~TimelineSpan() {
+            if (active) {
+                Timeline::record(category, std::move(name), started);
+            }
+        }
+
+    private:
+        const char *category;
+        const bool active;
+        std::string name;
+        Timeline::clock::time_point started;
+    };
+
+}
+
+/*
+ * Spans inside the maps exist only in builds defining AISDI_MAPS_TIMELINE, see src/CMakeLists.txt,
+ * so that other builds do not pay even the check of whether the timeline records.
+ */
+#ifdef AISDI_MAPS_TIMELINE
+#define AISDI_MAPS_TIMELINE_CONCAT_(a, b) a##b
+#define AISDI_MAPS_TIMELINE_CONCAT(a, b) AISDI_MAPS_TIMELINE_CONCAT_(a, b)
+#define AISDI_MAPS_TIMELINE_SPAN(category, name) \
+    ::aisdi::TimelineSpan AISDI_MAPS_TIMELINE_CONCAT(timelineSpan, __LINE__)(category, name)
+#else
+#define AISDI_MAPS_TIMELINE_SPAN(category, name) static_cast<void>(0)
+#endif
+
+#endif /* AISDI_MAPS_TIMELINE_H */
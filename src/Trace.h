@@ -0,0 +1,397 @@
+#ifndef AISDI_MAPS_TRACE_H
+#define AISDI_MAPS_TRACE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Snapshot.h"
+
+namespace aisdi {
+
+    enum class TraceOperation : std::uint8_t {
+        // operator[], which inserts a default value for a missing key
+        Access = 1,
+        Assign = 2,
+        // find and valueOf
+        Find = 3,
+        Remove = 4
+    };
+
+    inline const char *traceOperationName(TraceOperation operation) {
+        switch (operation) {
+            case TraceOperation::Access:
+                return "access";
+            case TraceOperation::Assign:
+                return "assign";
+            case TraceOperation::Find:
+                return "find";
+            case TraceOperation::Remove:
+                return "remove";
+        }
+        return "unknown";
+    }
+
+    /**
+     * Size recorded for a value: its length for strings, its object size otherwise. Replays
+     * build values of the recorded size with makeTraceValue.
+     */
+    template<typename T>
+    std::uint32_t traceValueSize(const T &) {
+        return sizeof(T);
+    }
+
+    inline std::uint32_t traceValueSize(const std::string &value) {
+        return static_cast<std::uint32_t>(value.size());
+    }
+
+    template<typename T>
+    T makeTraceValue(std::uint32_t) {
+        return T{};
+    }
+
+    template<>
+    inline std::string makeTraceValue<std::string>(std::uint32_t size) {
+        return std::string(size, 'v');
+    }
+
+    template<typename KeyType>
+    struct TraceRecord {
+        TraceOperation operation;
+        KeyType key;
+        std::uint32_t valueSize;
+        // nanoseconds since the trace started
+        std::uint64_t timestamp;
+    };
+
+    /**
+     * Start of a trace: magic, version and how keys are encoded, so a replay can pick the
+     * matching key type before reading records.
+     */
+    struct TraceHeader {
+        static const std::uint32_t VERSION = 1;
+
+        enum class KeyEncoding : std::uint8_t {
+            // trivially copyable, keySize bytes in host order
+            Raw = 0,
+            String = 1
+        };
+
+        KeyEncoding encoding;
+        std::uint8_t keySize;
+
+        template<typename KeyType>
+        static TraceHeader of() {
+            return std::is_same<KeyType, std::string>::value
+                   ? TraceHeader{KeyEncoding::String, 0}
+                   : TraceHeader{KeyEncoding::Raw, static_cast<std::uint8_t>(sizeof(KeyType))};
+        }
+
+        bool operator==(const TraceHeader &other) const {
+            return encoding == other.encoding && keySize == other.keySize;
+        }
+
+        void write(std::ostream &out) const {
+            out.write(magic(), MAGIC_LENGTH);
+            const std::uint32_t version = VERSION;
+            SnapshotCodec<std::uint32_t>::write(out, version);
+            SnapshotCodec<std::uint8_t>::write(out, static_cast<std::uint8_t>(encoding));
+            SnapshotCodec<std::uint8_t>::write(out, keySize);
+        }
+
+        static TraceHeader read(std::istream &in) {
+            char found[MAGIC_LENGTH];
+            in.read(found, MAGIC_LENGTH);
+            if (!in || std::memcmp(found, magic(), MAGIC_LENGTH) != 0) {
+                throw std::runtime_error("Not a map operation trace");
+            }
+            if (SnapshotCodec<std::uint32_t>::read(in) != VERSION) {
+                throw std::runtime_error("Unsupported trace version");
+            }
+            const auto encoding = SnapshotCodec<std::uint8_t>::read(in);
+            if (encoding > static_cast<std::uint8_t>(KeyEncoding::String)) {
+                throw std::runtime_error("Unknown trace key encoding");
+            }
+            return TraceHeader{static_cast<KeyEncoding>(encoding), SnapshotCodec<std::uint8_t>::read(in)};
+        }
+
+    private:
+        enum {
+            MAGIC_LENGTH = 8
+        };
+
+        static const char *magic() {
+            return "AISDITRC";
+        }
+    };
+
+    /**
+     * Writes a trace: after the header, each record is its operation byte, the time since the
+     * previous record and, for Access and Assign, the value size as LEB128 varints, with the key
+     * in between encoded by SnapshotCodec. Not thread-safe.
+     */
+    template<typename KeyType>
+    class TraceWriter {
+    public:
+        using key_type = KeyType;
+        using clock = std::chrono::steady_clock;
+
+        explicit TraceWriter(std::ostream &out) : out(out), start(clock::now()), previous(0), records(0) {
+            TraceHeader::of<key_type>().write(out);
+        }
+
+        void record(TraceOperation operation, const key_type &key, std::uint32_t valueSize = 0) {
+            const auto timestamp = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+            SnapshotCodec<std::uint8_t>::write(out, static_cast<std::uint8_t>(operation));
+            writeVarint(out, timestamp - previous);
+            SnapshotCodec<key_type>::write(out, key);
+            if (operation == TraceOperation::Access || operation == TraceOperation::Assign) {
+                writeVarint(out, valueSize);
+            }
+            previous = timestamp;
+            ++records;
+        }
+
+        std::size_t getRecordCount() const {
+            return records;
+        }
+
+    private:
+        std::ostream &out;
+        clock::time_point start;
+        std::uint64_t previous;
+        std::size_t records;
+
+        static void writeVarint(std::ostream &out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.put(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            out.put(static_cast<char>(value));
+        }
+    };
+
+    template<typename KeyType>
+    class TraceReader {
+    public:
+        using key_type = KeyType;
+
+        /**
+         * Reads the header, which must describe key_type.
+         */
+        explicit TraceReader(std::istream &in) : in(in), timestamp(0) {
+            if (!(TraceHeader::read(in) == TraceHeader::of<key_type>())) {
+                throw std::runtime_error("Trace keys do not match the key type");
+            }
+        }
+
+        /**
+         * Returns false at the end of the trace; a record cut short throws.
+         */
+        bool next(TraceRecord<key_type> &record) {
+            if (in.peek() == std::istream::traits_type::eof()) {
+                return false;
+            }
+            const auto operation = SnapshotCodec<std::uint8_t>::read(in);
+            if (operation < static_cast<std::uint8_t>(TraceOperation::Access) ||
+                operation > static_cast<std::uint8_t>(TraceOperation::Remove)) {
+                throw std::runtime_error("Unknown trace operation");
+            }
+            record.operation = static_cast<TraceOperation>(operation);
+            timestamp += readVarint(in);
+            record.timestamp = timestamp;
+            record.key = SnapshotCodec<key_type>::read(in);
+            record.valueSize = 0;
+            if (record.operation == TraceOperation::Access || record.operation == TraceOperation::Assign) {
+                record.valueSize = static_cast<std::uint32_t>(readVarint(in));
+            }
+            return true;
+        }
+
+    private:
+        std::istream &in;
+        std::uint64_t timestamp;
+
+        static std::uint64_t readVarint(std::istream &in) {
+            std::uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const auto byte = in.get();
+                if (byte == std::istream::traits_type::eof()) {
+                    throw std::runtime_error("Truncated trace");
+                }
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("Corrupted trace");
+        }
+    };
+
+    /**
+     * Map wrapper recording every operation into a trace before forwarding it. The wrapped map
+     * and the writer must outlive the wrapper; iteration is passed through unrecorded.
+     */
+    template<typename Map>
+    class RecordingMap {
+    public:
+        using key_type = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+        using size_type = typename Map::size_type;
+        using iterator = typename Map::iterator;
+        using const_iterator = typename Map::const_iterator;
+
+        RecordingMap(Map &map, TraceWriter<key_type> &writer) : map(map), writer(writer) {}
+
+        mapped_type &operator[](const key_type &key) {
+            auto &value = map[key];
+            writer.record(TraceOperation::Access, key, traceValueSize(value));
+            return value;
+        }
+
+        /**
+         * Same as (*this)[key] = value, but records the size of the value assigned.
+         */
+        void assign(const key_type &key, const mapped_type &value) {
+            writer.record(TraceOperation::Assign, key, traceValueSize(value));
+            map[key] = value;
+        }
+
+        const mapped_type &valueOf(const key_type &key) const {
+            writer.record(TraceOperation::Find, key);
+            return map.valueOf(key);
+        }
+
+        mapped_type &valueOf(const key_type &key) {
+            writer.record(TraceOperation::Find, key);
+            return map.valueOf(key);
+        }
+
+        const_iterator find(const key_type &key) const {
+            writer.record(TraceOperation::Find, key);
+            return static_cast<const Map &>(map).find(key);
+        }
+
+        iterator find(const key_type &key) {
+            writer.record(TraceOperation::Find, key);
+            return map.find(key);
+        }
+
+        void remove(const key_type &key) {
+            writer.record(TraceOperation::Remove, key);
+            map.remove(key);
+        }
+
+        void remove(const const_iterator &it) {
+            if (it != static_cast<const Map &>(map).end()) {
+                writer.record(TraceOperation::Remove, (*it).first);
+            }
+            map.remove(it);
+        }
+
+        size_type getSize() const {
+            return map.getSize();
+        }
+
+        bool isEmpty() const {
+            return map.isEmpty();
+        }
+
+        iterator begin() {
+            return map.begin();
+        }
+
+        iterator end() {
+            return map.end();
+        }
+
+        const_iterator begin() const {
+            return static_cast<const Map &>(map).begin();
+        }
+
+        const_iterator end() const {
+            return static_cast<const Map &>(map).end();
+        }
+
+    private:
+        Map &map;
+        TraceWriter<key_type> &writer;
+    };
+
+    /**
+     * Durations of replayed operations in nanoseconds, by operation.
+     */
+    struct TraceReplayTimes {
+        std::array<std::vector<double>, 5> nanoseconds;
+        // duration of the traced run, from the first to the last record
+        std::uint64_t tracedNanoseconds;
+
+        std::vector<double> &of(TraceOperation operation) {
+            return nanoseconds[static_cast<std::size_t>(operation)];
+        }
+    };
+
+    /**
+     * Runs the operations of a trace against a map, timing each one. Assigned values are built
+     * with the recorded sizes; removals of missing keys are looked up but not attempted.
+     */
+    template<typename Map>
+    TraceReplayTimes replayTrace(Map &map, TraceReader<typename Map::key_type> &reader) {
+        using clock = std::chrono::steady_clock;
+        using mapped_type = typename Map::mapped_type;
+
+        TraceReplayTimes times;
+        times.tracedNanoseconds = 0;
+        std::uint64_t firstTimestamp = 0;
+        bool first = true;
+        TraceRecord<typename Map::key_type> record;
+        std::size_t sink = 0;
+        while (reader.next(record)) {
+            if (first) {
+                firstTimestamp = record.timestamp;
+                first = false;
+            }
+            times.tracedNanoseconds = record.timestamp - firstTimestamp;
+
+            // built outside the timed region, like the caller's value would have been
+            const auto value = record.operation == TraceOperation::Assign
+                               ? makeTraceValue<mapped_type>(record.valueSize) : mapped_type{};
+            const auto started = clock::now();
+            switch (record.operation) {
+                case TraceOperation::Access:
+                    sink += traceValueSize(map[record.key]);
+                    break;
+                case TraceOperation::Assign:
+                    map[record.key] = value;
+                    break;
+                case TraceOperation::Find:
+                    sink += map.find(record.key) != map.end();
+                    break;
+                case TraceOperation::Remove: {
+                    const auto found = map.find(record.key);
+                    if (found != map.end()) {
+                        map.remove(found);
+                    }
+                    break;
+                }
+            }
+            times.of(record.operation).push_back(
+                    std::chrono::duration<double, std::nano>(clock::now() - started).count());
+        }
+        static volatile std::size_t consumed = 0;
+        consumed = consumed ^ sink;
+        return times;
+    }
+
+}
+
+#endif /* AISDI_MAPS_TRACE_H */
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BeTreeMap.h"
+#include "Benchmark.h"
+#include "FlatTreeMap.h"
+#include "HashMap.h"
+#include "SlowOperations.h"
+#include "Trace.h"
+#include "TreeMap.h"
+
+namespace aisdi {
+    namespace benchmark {
+
+        namespace {
+
+            const int KEYS = 5000;
+            const std::size_t OPERATIONS = 100000;
+
+            const TraceOperation operations[] = {TraceOperation::Access, TraceOperation::Assign,
+                                                 TraceOperation::Find, TraceOperation::Remove};
+
+            double percentile(const std::vector<double> &sorted, double fraction) {
+                return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()))];
+            }
+
+            void reportReplay(const std::string &engine, TraceReplayTimes &times) {
+                std::size_t count = 0;
+                double total = 0;
+                for (auto operation : operations) {
+                    auto &nanoseconds = times.of(operation);
+                    if (nanoseconds.empty()) {
+                        continue;
+                    }
+                    std::sort(nanoseconds.begin(), nanoseconds.end());
+                    double sum = 0;
+                    for (auto duration : nanoseconds) {
+                        sum += duration;
+                    }
+                    report(Result{"replay", engine + " " + traceOperationName(operation), nanoseconds.size(), sum});
+                    std::cout << std::setw(60) << "p50/p99/max" << std::fixed << std::setprecision(0)
+                              << std::setw(12) << percentile(nanoseconds, 0.5) << " / "
+                              << percentile(nanoseconds, 0.99) << " / " << nanoseconds.back() << " ns" << std::endl;
+                    count += nanoseconds.size();
+                    total += sum;
+                }
+                report(Result{"replay", engine + " all, traced run took "
+                                        + std::to_string(times.tracedNanoseconds / 1000) + " us",
+                              count, total});
+            }
+
+            template<typename Map>
+            void replayOn(const std::string &engine, std::istream &in) {
+                TraceReader<typename Map::key_type> reader(in);
+                Map map;
+                auto times = replayTrace(map, reader);
+                reportReplay(engine, times);
+            }
+
+            template<typename KeyType>
+            bool replayWith(const std::string &engine, std::istream &in) {
+                if (engine == "tree") {
+                    replayOn<TreeMap<KeyType, std::string>>(engine, in);
+                } else if (engine == "hash") {
+                    replayOn<HashMap<KeyType, std::string>>(engine, in);
+                } else if (engine == "flat") {
+                    replayOn<FlatTreeMap<KeyType, std::string>>(engine, in);
+                } else if (engine == "betree") {
+                    replayOn<BeTreeMap<KeyType, std::string>>(engine, in);
+                } else {
+                    return false;
+                }
+                return true;
+            }
+
+            template<typename Map>
+            void runWorkload(Map &map, std::size_t operations) {
+                std::mt19937 generator(11);
+                std::uniform_int_distribution<int> keys(0, KEYS - 1);
+                std::uniform_int_distribution<int> kinds(0, 9);
+                std::size_t sum = 0;
+                for (std::size_t i = 0; i < operations; ++i) {
+                    const auto key = keys(generator);
+                    const auto kind = kinds(generator);
+                    if (kind < 6) {
+                        auto it = map.find(key);
+                        sum += it == map.end() ? 0 : it->second.size();
+                    } else if (kind < 9) {
+                        map.assign(key, std::string(static_cast<std::size_t>(key % 32), 'v'));
+                    } else {
+                        auto it = map.find(key);
+                        if (it != map.end()) {
+                            map.remove(it);
+                        }
+                    }
+                }
+                consume(sum);
+            }
+
+            /**
+             * Plain map with the assign() of RecordingMap, for measuring the recording overhead.
+             */
+            template<typename Map>
+            struct Assigning : Map {
+                void assign(const typename Map::key_type &key, const typename Map::mapped_type &value) {
+                    (*this)[key] = value;
+                }
+            };
+
+        }
+
+        int replay(const std::string &engine, const std::string &path) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                std::cerr << "cannot read trace " << path << std::endl;
+                return 1;
+            }
+            try {
+                const auto header = TraceHeader::read(in);
+                in.seekg(0);
+                bool known;
+                if (header == TraceHeader::of<std::string>()) {
+                    known = replayWith<std::string>(engine, in);
+                } else if (header == TraceHeader::of<std::int32_t>()) {
+                    known = replayWith<std::int32_t>(engine, in);
+                } else if (header == TraceHeader::of<std::int64_t>()) {
+                    known = replayWith<std::int64_t>(engine, in);
+                } else {
+                    std::cerr << "unsupported trace key size " << static_cast<int>(header.keySize) << std::endl;
+                    return 1;
+                }
+                if (!known) {
+                    std::cerr << "unknown engine " << engine << ", expected tree, hash, flat or betree" << std::endl;
+                    return 1;
+                }
+            } catch (const std::runtime_error &error) {
+                std::cerr << path << ": " << error.what() << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
+        void traceSuite() {
+            Assigning<TreeMap<int, std::string>> plain;
+            report(measure("trace", "TreeMap workload", OPERATIONS, [&]() { runWorkload(plain, OPERATIONS); }));
+
+            std::stringstream trace;
+            TraceWriter<int> writer(trace);
+            TreeMap<int, std::string> recorded;
+            RecordingMap<TreeMap<int, std::string>> recording(recorded, writer);
+            report(measure("trace", "TreeMap workload, recorded", OPERATIONS, [&]() {
+                runWorkload(recording, OPERATIONS);
+            }));
+            std::cout << std::setw(60) << "trace size" << std::fixed << std::setprecision(2) << std::setw(12)
+                      << static_cast<double>(trace.str().size()) / writer.getRecordCount() << " bytes/op"
+                      << std::endl;
+
+            // a threshold no operation reaches: the cost of timing every operation alone
+            SlowOperationLog log(1000000000);
+            TreeMap<int, std::string> monitoredMap;
+            MonitoredMap<TreeMap<int, std::string>> monitored(monitoredMap, log);
+            report(measure("trace", "TreeMap workload, monitored", OPERATIONS, [&]() {
+                runWorkload(monitored, OPERATIONS);
+            }));
+
+            for (auto engine : {"tree", "hash", "flat", "betree"}) {
+                std::istringstream in(trace.str());
+                replayWith<int>(engine, in);
+            }
+        }
+
+    }
+}
@@ -7,10 +7,26 @@
 #include <utility>
 #include <algorithm>
 #include <stdexcept>
+#include <random>
+#include <set>
+#include <vector>
+#include <future>
+#include <numeric>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "ErrorPolicy.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Timeline.h"
 
 namespace aisdi {
 
-    template<typename KeyType, typename ValueType>
+    /**
+     * ErrorPolicy decides what a missing key or an out-of-range iterator does; see ErrorPolicy.h.
+     */
+    template<typename KeyType, typename ValueType, typename ErrorPolicy = ThrowOnError>
     class TreeMap {
     public:
         using key_type = KeyType;
@@ -27,44 +43,92 @@ namespace aisdi {
         using iterator = Iterator;
         using const_iterator = ConstIterator;
 
-        using node = struct TreeNode {
+        /**
+         * The AVL balance factor and the snapshot dirty flag are kept in the low bits of the parent
+         * pointer, which are always zero for an 8-byte aligned node.
+         */
+        using node = struct alignas(8) TreeNode {
             value_type val;
-            TreeNode *parent;
             TreeNode *leftChild;
             TreeNode *rightChild;
-            int height;
+            size_type count;
 
-            TreeNode() : val(std::make_pair(key_type(), mapped_type())), parent(nullptr), leftChild(nullptr),
-                         rightChild(nullptr), height(0) {}
+            TreeNode() : val(std::make_pair(key_type(), mapped_type())), leftChild(nullptr), rightChild(nullptr),
+                         count(1), parentAndTags(LEVEL | DIRTY_BIT) {}
 
-            explicit TreeNode(value_type value, TreeNode *parent = nullptr) : val(value), parent(parent),
+            explicit TreeNode(value_type value, TreeNode *parent = nullptr) : val(std::move(value)),
                                                                               leftChild(nullptr),
-                                                                              rightChild(nullptr), height(0) {}
+                                                                              rightChild(nullptr), count(1),
+                                                                              parentAndTags(tagged(parent) | LEVEL |
+                                                                                            DIRTY_BIT) {}
 
-            key_type key() {
+            const key_type &key() const {
                 return val.first;
             }
 
             mapped_type &value() {
                 return val.second;
             }
+
+            TreeNode *parent() const {
+                return reinterpret_cast<TreeNode *>(parentAndTags & ~TAG_MASK);
+            }
+
+            void setParent(TreeNode *parent) {
+                parentAndTags = tagged(parent) | (parentAndTags & TAG_MASK);
+            }
+
+            // height of the right subtree minus height of the left one
+            int balance() const {
+                return static_cast<int>((parentAndTags & BALANCE_MASK) >> BALANCE_SHIFT) - 1;
+            }
+
+            void setBalance(int balance) {
+                parentAndTags = (parentAndTags & ~BALANCE_MASK) |
+                                (static_cast<std::uintptr_t>(balance + 1) << BALANCE_SHIFT);
+            }
+
+            // something in this subtree changed since the last snapshot; implies dirty ancestors
+            bool isDirty() const {
+                return (parentAndTags & DIRTY_BIT) != 0;
+            }
+
+            void setDirty(bool dirty) {
+                parentAndTags = dirty ? parentAndTags | DIRTY_BIT : parentAndTags & ~DIRTY_BIT;
+            }
+
+        private:
+            enum : std::uintptr_t {
+                DIRTY_BIT = 1, BALANCE_SHIFT = 1, BALANCE_MASK = 3 << BALANCE_SHIFT, TAG_MASK = 7,
+                // balance factor 0, stored off by one
+                LEVEL = 1 << BALANCE_SHIFT
+            };
+
+            std::uintptr_t parentAndTags;
+
+            static std::uintptr_t tagged(TreeNode *parent) {
+                return reinterpret_cast<std::uintptr_t>(parent);
+            }
         };
         using node_pointer = node *;
 
-        TreeMap() : root(nullptr), size(0) {}
+        TreeMap() : root(nullptr), size(0), trackingChanges(false), replacedSinceCheckpoint(false), checkpoint(0) {}
 
         TreeMap(std::initializer_list<value_type> list) : TreeMap() {
             std::for_each(list.begin(), list.end(),
                           [this](const value_type &v) { this->operator[](v.first) = v.second; });
         }
 
-        TreeMap(const TreeMap &other) : TreeMap() {
-            fill(other);
-        }
+        TreeMap(const TreeMap &other) : root(copySubtree(other.root, nullptr)), size(other.size),
+                                        trackingChanges(false), replacedSinceCheckpoint(false), checkpoint(0) {}
 
         TreeMap(TreeMap &&other) {
             this->root = other.root;
             this->size = other.size;
+            this->removedSinceCheckpoint = std::move(other.removedSinceCheckpoint);
+            this->trackingChanges = other.trackingChanges;
+            this->replacedSinceCheckpoint = other.replacedSinceCheckpoint;
+            this->checkpoint = other.checkpoint;
             other.root = nullptr;
         }
 
@@ -77,7 +141,9 @@ namespace aisdi {
                 return *this;
             }
             clear();
-            fill(other);
+            root = copySubtree(other.root, nullptr);
+            size = other.size;
+            markReplaced();
             return *this;
         }
 
@@ -89,9 +155,74 @@ namespace aisdi {
             this->root = other.root;
             this->size = other.size;
             other.root = nullptr;
+            markSubtreeDirty(root);
+            markReplaced();
             return *this;
         }
 
+        /**
+         * Copy made by the pool's workers: nodes near the root are copied by the calling thread,
+         * the subtrees hanging below them are copied concurrently and linked in place.
+         * Result has exactly the same shape as the one made by the copy constructor.
+         */
+        TreeMap clone(ThreadPool &pool) const {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "clone");
+            struct Subtree {
+                node_pointer source;
+                node_pointer copyParent;
+                node_pointer *slot;
+            };
+
+            TreeMap result;
+            std::vector<Subtree> frontier{Subtree{root, nullptr, &result.root}};
+            const size_type wantedSubtrees = 4 * pool.getSize();
+            for (int depth = 0; depth < MAX_SPLIT_DEPTH && frontier.size() < wantedSubtrees; ++depth) {
+                std::vector<Subtree> next;
+                for (const auto &subtree : frontier) {
+                    if (subtree.source == nullptr) {
+                        continue;
+                    }
+                    auto copy = copyNode(subtree.source, subtree.copyParent);
+                    *subtree.slot = copy;
+                    next.push_back(Subtree{subtree.source->leftChild, copy, &copy->leftChild});
+                    next.push_back(Subtree{subtree.source->rightChild, copy, &copy->rightChild});
+                }
+                frontier.swap(next);
+            }
+
+            std::vector<std::future<void>> copies;
+            for (const auto &subtree : frontier) {
+                if (subtree.source != nullptr) {
+                    copies.push_back(pool.submit([subtree]() {
+                        *subtree.slot = copySubtree(subtree.source, subtree.copyParent);
+                    }));
+                }
+            }
+            waitAll(copies);
+            result.size = size;
+            return result;
+        }
+
+        /**
+         * Replaces the contents with a range of entries, or of pointers to entries, with strictly
+         * increasing keys, building a balanced tree in linear time. Mapped values are moved out of
+         * the entries, keys are copied. The map is left unchanged if the range is out of order.
+         */
+        template<typename RandomAccessIterator>
+        void assignSorted(RandomAccessIterator first, RandomAccessIterator last) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "assignSorted");
+            for (auto it = first; it != last && it + 1 != last; ++it) {
+                if (!(entryOf(*it).first < entryOf(*(it + 1)).first)) {
+                    raiseError(std::invalid_argument("Entries out of order"));
+                }
+            }
+            clear();
+            const auto count = static_cast<size_type>(last - first);
+            root = buildSubtree(first, 0, count, nullptr, true);
+            size = count;
+            markReplaced();
+        }
+
         bool isEmpty() const {
             return getSize() == 0;
         }
@@ -116,21 +247,46 @@ namespace aisdi {
             }
 
             if (*node != nullptr) {
+                markDirty(*node);
                 return (*node)->value();
             }
             *node = new TreeNode(std::make_pair(key, mapped_type()), parent);
             auto ret = *node;
+            for (; parent != nullptr; parent = parent->parent()) {
+                ++parent->count;
+                parent->setDirty(true);
+            }
+            rebalanceAfterInsert(ret);
             ++size;
 
             return ret->value();
         }
 
         const mapped_type &valueOf(const key_type &key) const {
-            return (*find(key)).second;
+            const auto node = findNode(key);
+            if (node == nullptr) {
+                ErrorPolicy::fail(MapError::MissingKey);
+                return errorValue<mapped_type>();
+            }
+            return node->val.second;
         }
 
         mapped_type &valueOf(const key_type &key) {
-            return (*find(key)).second;
+            const auto node = findNode(key);
+            if (node == nullptr) {
+                ErrorPolicy::fail(MapError::MissingKey);
+                return errorValue<mapped_type>();
+            }
+            markDirty(node);
+            return node->val.second;
+        }
+
+        /**
+         * The value of key, or nullptr when it is missing; never an error.
+         */
+        const mapped_type *tryValueOf(const key_type &key) const {
+            const auto node = findNode(key);
+            return node == nullptr ? nullptr : &node->val.second;
         }
 
         const_iterator find(const key_type &key) const {
@@ -141,28 +297,106 @@ namespace aisdi {
             return iterator(*this, findNode(key));
         }
 
+        /**
+         * Looks up a batch of keys and writes a const_iterator for each (end() for missing ones) to
+         * out, in input order. Keys are searched in ascending order, each search resuming from the
+         * lowest node on the previous search path whose subtree can hold the key, so k lookups take
+         * O(k log(n/k)) key comparisons rather than O(k log n). Sorted input is searched in place.
+         */
+        template<typename ForwardIterator, typename OutputIterator>
+        OutputIterator findSorted(ForwardIterator keysBegin, ForwardIterator keysEnd, OutputIterator out) const {
+            node_pointer finger = root;
+            std::vector<node_pointer> bounds;
+            const auto less = [](const key_type &a, const key_type &b) {
+                return b > a;
+            };
+            if (std::is_sorted(keysBegin, keysEnd, less)) {
+                for (; keysBegin != keysEnd; ++keysBegin) {
+                    *out++ = const_iterator(*this, findFrom(finger, bounds, *keysBegin));
+                }
+                return out;
+            }
+
+            std::vector<const key_type *> keys;
+            for (; keysBegin != keysEnd; ++keysBegin) {
+                keys.push_back(&*keysBegin);
+            }
+            std::vector<size_type> order(keys.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&keys, &less](size_type a, size_type b) {
+                return less(*keys[a], *keys[b]);
+            });
+
+            std::vector<node_pointer> found(keys.size());
+            for (auto i : order) {
+                found[i] = findFrom(finger, bounds, *keys[i]);
+            }
+            for (auto node : found) {
+                *out++ = const_iterator(*this, node);
+            }
+            return out;
+        }
+
         void remove(const key_type &key) {
-            remove(find(key));
+            const auto it = find(key);
+            if (it == end()) {
+                ErrorPolicy::fail(MapError::MissingKey);
+                return;
+            }
+            remove(it);
+        }
+
+        /**
+         * Removes key if present; returns whether it was, never an error.
+         */
+        bool tryRemove(const key_type &key) {
+            const auto it = find(key);
+            if (it == end()) {
+                return false;
+            }
+            remove(it);
+            return true;
         }
 
         void remove(const const_iterator &it) {
             if (it == end()) {
-                throw std::out_of_range("Iterator out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return;
             }
 
             auto nodeToDelete = it.currentNode;
-            node_pointer *nodeToDeleteParentPtr = (nodeToDelete->parent == nullptr) ? &root :
-                                                  (nodeToDelete->parent->leftChild == nodeToDelete) ?
-                                                  &nodeToDelete->parent->leftChild :
-                                                  &nodeToDelete->parent->rightChild;
+            // the lowest subtree that got shorter, and on which side
+            node_pointer shrunk = nodeToDelete->parent();
+            bool leftShrunk = shrunk != nullptr && shrunk->leftChild == nodeToDelete;
+            if (trackingChanges) {
+                removedSinceCheckpoint.push_back(nodeToDelete->key());
+            }
 
-            if (nodeToDelete->leftChild == nullptr && nodeToDelete->rightChild == nullptr) {
-                *nodeToDeleteParentPtr = nullptr;
+            if (nodeToDelete->leftChild == nullptr || nodeToDelete->rightChild == nullptr) {
+                replaceInParent(nodeToDelete, nodeToDelete->leftChild == nullptr ? nodeToDelete->rightChild
+                                                                                  : nodeToDelete->leftChild);
             } else {
-                auto branch = nodeToDelete->rightChild == nullptr ? nodeToDelete->leftChild : nodeToDelete->rightChild;
-                branch->parent = nodeToDelete->parent;
-                *nodeToDeleteParentPtr = branch;
+                // relink the in-order successor instead of moving values, so other iterators stay valid
+                node_pointer successor = nodeToDelete->rightChild;
+                while (successor->leftChild != nullptr) {
+                    successor = successor->leftChild;
+                }
+                successor->setBalance(nodeToDelete->balance());
+                shrunk = successor;
+                leftShrunk = false;
+                if (successor->parent() != nodeToDelete) {
+                    shrunk = successor->parent();
+                    leftShrunk = true;
+                    replaceInParent(successor, successor->rightChild);
+                    successor->rightChild = nodeToDelete->rightChild;
+                    successor->rightChild->setParent(successor);
+                }
+                replaceInParent(nodeToDelete, successor);
+                successor->leftChild = nodeToDelete->leftChild;
+                successor->leftChild->setParent(successor);
             }
+            recount(shrunk);
+            rebalanceAfterRemove(shrunk, leftShrunk);
             delete nodeToDelete;
             --size;
         }
@@ -171,6 +405,78 @@ namespace aisdi {
             return size;
         }
 
+        /**
+         * Number of nodes a lookup of the key visits, the key's own included if it is found.
+         */
+        size_type depthOf(const key_type &key) const {
+            size_type depth = 0;
+            for (node_pointer node = root; node != nullptr; ++depth) {
+                if (node->key() == key) {
+                    return depth + 1;
+                }
+                node = node->key() > key ? node->leftChild : node->rightChild;
+            }
+            return depth;
+        }
+
+        /**
+         * Number of nodes on the longest root-to-leaf path, found by following the taller child.
+         */
+        size_type getHeight() const {
+            size_type height = 0;
+            for (node_pointer node = root; node != nullptr; ++height) {
+                node = node->balance() > 0 ? node->rightChild : node->leftChild;
+            }
+            return height;
+        }
+
+        /**
+         * Height of the key's right subtree minus that of its left one, as kept for rebalancing,
+         * or 0 for a missing key.
+         */
+        int balanceOf(const key_type &key) const {
+            const node_pointer node = findNode(key);
+            return node == nullptr ? 0 : node->balance();
+        }
+
+        template<typename RandomGenerator>
+        const_iterator randomEntry(RandomGenerator &generator) const {
+            if (isEmpty()) {
+                return cend();
+            }
+            std::uniform_int_distribution<size_type> rank(0, size - 1);
+            return const_iterator(*this, findByRank(rank(generator)));
+        }
+
+        template<typename RandomGenerator>
+        iterator randomEntry(RandomGenerator &generator) {
+            return iterator(static_cast<const TreeMap &>(*this).randomEntry(generator));
+        }
+
+        /**
+         * Picks min(count, size) distinct entries, each subset being equally likely.
+         * Entries are returned in key order.
+         */
+        template<typename RandomGenerator>
+        std::vector<const_iterator> sample(size_type count, RandomGenerator &generator) const {
+            count = std::min(count, size);
+            // Floyd's algorithm - exactly count draws, no rejection
+            std::set<size_type> ranks;
+            for (size_type upper = size - count; upper < size; ++upper) {
+                std::uniform_int_distribution<size_type> rank(0, upper);
+                if (!ranks.insert(rank(generator)).second) {
+                    ranks.insert(upper);
+                }
+            }
+
+            std::vector<const_iterator> result;
+            result.reserve(count);
+            for (auto rank : ranks) {
+                result.push_back(const_iterator(*this, findByRank(rank)));
+            }
+            return result;
+        }
+
         bool operator==(const TreeMap &other) const {
             if (size != other.size) {
                 return false;
@@ -188,6 +494,110 @@ namespace aisdi {
             return !(*this == other);
         }
 
+        /**
+         * Writes every entry in key order and starts tracking changes until the next writeDelta.
+         */
+        void writeSnapshot(std::ostream &out) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "writeSnapshot");
+            SnapshotHeader{SnapshotKind::Full, ++checkpoint}.write(out);
+            SnapshotCodec<std::uint64_t>::write(out, size);
+            for (auto it = cbegin(); it != cend(); ++it) {
+                writeEntry(out, *it);
+                it.currentNode->setDirty(false);
+            }
+            removedSinceCheckpoint.clear();
+            replacedSinceCheckpoint = false;
+            trackingChanges = true;
+        }
+
+        /**
+         * Writes keys removed since the last snapshot or delta, then the entries of changed subtrees.
+         * Only dirty subtrees are visited; those of at most DELTA_SUBTREE_SIZE entries are written
+         * whole. Entries reached through operator[], non-const valueOf or non-const iterators count
+         * as changed.
+         */
+        void writeDelta(std::ostream &out) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "writeDelta");
+            if (!trackingChanges) {
+                raiseError(std::logic_error("No snapshot to write a delta against"));
+            }
+            SnapshotHeader{SnapshotKind::Delta, ++checkpoint}.write(out);
+            const std::uint8_t replaced = replacedSinceCheckpoint ? 1 : 0;
+            SnapshotCodec<std::uint8_t>::write(out, replaced);
+            SnapshotCodec<std::uint64_t>::write(out, removedSinceCheckpoint.size());
+            for (const auto &key : removedSinceCheckpoint) {
+                SnapshotCodec<key_type>::write(out, key);
+            }
+            std::vector<node_pointer> changed;
+            takeChangedNodes(changed);
+            SnapshotCodec<std::uint64_t>::write(out, changed.size());
+            for (auto node : changed) {
+                writeEntry(out, node->val);
+            }
+            removedSinceCheckpoint.clear();
+            replacedSinceCheckpoint = false;
+        }
+
+        /**
+         * Replaces the contents with a full snapshot, building a balanced tree.
+         * The map is left unchanged if reading fails.
+         */
+        void readSnapshot(std::istream &in) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "readSnapshot");
+            const auto header = SnapshotHeader::read(in);
+            if (header.kind != SnapshotKind::Full) {
+                raiseError(std::runtime_error("Expected a full snapshot"));
+            }
+            std::vector<value_type> entries;
+            readEntries(in, entries);
+            for (size_type i = 1; i < entries.size(); ++i) {
+                if (!(entries[i - 1].first < entries[i].first)) {
+                    raiseError(std::runtime_error("Snapshot entries out of order"));
+                }
+            }
+            clear();
+            root = buildSubtree(entries.begin(), 0, entries.size(), nullptr, false);
+            size = entries.size();
+            removedSinceCheckpoint.clear();
+            replacedSinceCheckpoint = false;
+            trackingChanges = true;
+            checkpoint = header.sequence;
+        }
+
+        /**
+         * Applies removals and changed entries of a delta. The delta must directly follow the last
+         * snapshot or delta read or written by this map; the map is left unchanged if reading fails.
+         */
+        void applyDelta(std::istream &in) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "applyDelta");
+            const auto header = SnapshotHeader::readDelta(in, checkpoint);
+            const bool replaced = SnapshotCodec<std::uint8_t>::read(in) != 0;
+            std::vector<key_type> removed;
+            for (auto count = SnapshotCodec<std::uint64_t>::read(in); count > 0; --count) {
+                removed.push_back(SnapshotCodec<key_type>::read(in));
+            }
+            std::vector<value_type> entries;
+            readEntries(in, entries);
+
+            if (replaced) {
+                clear();
+            }
+            for (const auto &key : removed) {
+                auto node = findNode(key);
+                if (node != nullptr) {
+                    remove(const_iterator(*this, node));
+                }
+            }
+            for (const auto &entry : entries) {
+                (*this)[entry.first] = entry.second;
+            }
+            std::vector<node_pointer> changed;
+            takeChangedNodes(changed);
+            removedSinceCheckpoint.clear();
+            replacedSinceCheckpoint = false;
+            checkpoint = header.sequence;
+        }
+
         iterator begin() {
             return iterator(*this, minElement());
         }
@@ -213,8 +623,112 @@ namespace aisdi {
         }
 
     private:
+        static const int MAX_SPLIT_DEPTH = 16;
+        static const size_type DELTA_SUBTREE_SIZE = 32;
+
         node_pointer root;
         size_type size;
+        std::vector<key_type> removedSinceCheckpoint;
+        bool trackingChanges;
+        // contents were assigned from another map, a delta must start from an empty map
+        bool replacedSinceCheckpoint;
+        std::uint64_t checkpoint;
+
+        static void markDirty(node_pointer node) {
+            for (; node != nullptr && !node->isDirty(); node = node->parent()) {
+                node->setDirty(true);
+            }
+        }
+
+        /**
+         * Adopted nodes may have been clean in their former map, but a delta after a replacement
+         * must carry every entry.
+         */
+        static void markSubtreeDirty(node_pointer subtree) {
+            std::vector<node_pointer> pending;
+            if (subtree != nullptr) {
+                pending.push_back(subtree);
+            }
+            while (!pending.empty()) {
+                auto node = pending.back();
+                pending.pop_back();
+                node->setDirty(true);
+                for (auto child : {node->leftChild, node->rightChild}) {
+                    if (child != nullptr) {
+                        pending.push_back(child);
+                    }
+                }
+            }
+        }
+
+        void markReplaced() {
+            removedSinceCheckpoint.clear();
+            replacedSinceCheckpoint = true;
+        }
+
+        /**
+         * Collects nodes of dirty subtrees and marks them clean again. A large dirty subtree
+         * contributes its root and is searched further; a small one is taken whole, as it is
+         * unknown which of its nodes changed.
+         */
+        void takeChangedNodes(std::vector<node_pointer> &changed) {
+            std::vector<node_pointer> pending;
+            if (root != nullptr && root->isDirty()) {
+                pending.push_back(root);
+            }
+            while (!pending.empty()) {
+                auto node = pending.back();
+                pending.pop_back();
+                const bool whole = node->count <= DELTA_SUBTREE_SIZE;
+                node->setDirty(false);
+                changed.push_back(node);
+                for (auto child : {node->leftChild, node->rightChild}) {
+                    if (child != nullptr && (whole || child->isDirty())) {
+                        pending.push_back(child);
+                    }
+                }
+            }
+        }
+
+        static void writeEntry(std::ostream &out, const value_type &entry) {
+            SnapshotCodec<key_type>::write(out, entry.first);
+            SnapshotCodec<mapped_type>::write(out, entry.second);
+        }
+
+        static void readEntries(std::istream &in, std::vector<value_type> &entries) {
+            for (auto count = SnapshotCodec<std::uint64_t>::read(in); count > 0; --count) {
+                auto key = SnapshotCodec<key_type>::read(in);
+                entries.emplace_back(std::move(key), SnapshotCodec<mapped_type>::read(in));
+            }
+        }
+
+        static value_type &entryOf(value_type &entry) {
+            return entry;
+        }
+
+        static value_type &entryOf(value_type *entry) {
+            return *entry;
+        }
+
+        /**
+         * Builds a balanced subtree of sorted entries [first, last), moving their mapped values.
+         */
+        template<typename RandomAccessIterator>
+        static node_pointer buildSubtree(RandomAccessIterator entries, size_type first, size_type last,
+                                         node_pointer parent, bool dirty) {
+            if (first == last) {
+                return nullptr;
+            }
+            const auto middle = first + (last - first) / 2;
+            auto &entry = entryOf(entries[middle]);
+            auto node = new TreeNode(value_type(entry.first, std::move(entry.second)), parent);
+            node->setDirty(dirty);
+            node->count = last - first;
+            node->setBalance(heightOf(last - middle - 1) - heightOf(middle - first));
+            node->leftChild = buildSubtree(entries, first, middle, node, dirty);
+            node->rightChild = buildSubtree(entries, middle + 1, last, node, dirty);
+            return node;
+        }
 
         node_pointer minElement() const {
             node_pointer element = root;
@@ -233,19 +747,261 @@ namespace aisdi {
         }
 
         void clear() {
-            auto it = begin();
-            while (it != end()) {
-                auto node = it.currentNode;
-                ++it;
-                delete (node);
-            }
+            deleteSubtree(root);
             root = nullptr;
             size = 0;
         }
 
-        void fill(const TreeMap &other) {
-            std::for_each(other.begin(), other.end(),
-                          [this](const value_type &v) { this->operator[](v.first) = v.second; });
+        /**
+         * Frees the nodes of a subtree; the link to it from its parent is left to the caller.
+         */
+        static void deleteSubtree(node_pointer subtree) {
+            // post-order, so no freed node is ever read again
+            node_pointer node = subtree;
+            while (node != nullptr) {
+                if (node->leftChild != nullptr) {
+                    node = node->leftChild;
+                } else if (node->rightChild != nullptr) {
+                    node = node->rightChild;
+                } else {
+                    node_pointer parent = node == subtree ? nullptr : node->parent();
+                    if (parent != nullptr) {
+                        (parent->leftChild == node ? parent->leftChild : parent->rightChild) = nullptr;
+                    }
+                    delete node;
+                    node = parent;
+                }
+            }
+        }
+
+        static node_pointer copyNode(node_pointer source, node_pointer parent) {
+            auto copy = new TreeNode(source->val, parent);
+            copy->setBalance(source->balance());
+            copy->count = source->count;
+            return copy;
+        }
+
+        /**
+         * Frees a partly built copy if copying a value throws.
+         */
+        struct SubtreeGuard {
+            node_pointer subtree;
+
+            ~SubtreeGuard() {
+                deleteSubtree(subtree);
+            }
+        };
+
+        /**
+         * Pre-order copy keeping the shape and balance factors of the source.
+         */
+        static node_pointer copySubtree(node_pointer source, node_pointer parent) {
+            if (source == nullptr) {
+                return nullptr;
+            }
+            const auto copyRoot = copyNode(source, parent);
+            SubtreeGuard guard{copyRoot};
+            node_pointer from = source;
+            node_pointer to = copyRoot;
+            while (true) {
+                if (from->leftChild != nullptr && to->leftChild == nullptr) {
+                    to->leftChild = copyNode(from->leftChild, to);
+                    from = from->leftChild;
+                    to = to->leftChild;
+                } else if (from->rightChild != nullptr && to->rightChild == nullptr) {
+                    to->rightChild = copyNode(from->rightChild, to);
+                    from = from->rightChild;
+                    to = to->rightChild;
+                } else if (from == source) {
+                    guard.subtree = nullptr;
+                    return copyRoot;
+                } else {
+                    from = from->parent();
+                    to = to->parent();
+                }
+            }
+        }
+
+        static size_type countOf(node_pointer node) {
+            return node == nullptr ? 0 : node->count;
+        }
+
+        /**
+         * Also marks the path dirty, so subtrees relinked by a removal stay reachable through
+         * dirty nodes only.
+         */
+        void recount(node_pointer node) {
+            for (; node != nullptr; node = node->parent()) {
+                node->count = 1 + countOf(node->leftChild) + countOf(node->rightChild);
+                node->setDirty(true);
+            }
+        }
+
+        void replaceInParent(node_pointer node, node_pointer replacement) {
+            const auto parent = node->parent();
+            if (parent == nullptr) {
+                root = replacement;
+            } else if (parent->leftChild == node) {
+                parent->leftChild = replacement;
+            } else {
+                parent->rightChild = replacement;
+            }
+            if (replacement != nullptr) {
+                replacement->setParent(parent);
+            }
+        }
+
+        // height of a perfectly balanced tree of the given size, as built by buildSubtree
+        static int heightOf(size_type count) {
+            int height = 0;
+            for (; count > 0; count >>= 1) {
+                ++height;
+            }
+            return height;
+        }
+
+        /**
+         * Lifts the child on the given side (1 right, -1 left) above node and returns it. Counts
+         * of both nodes are refreshed; balance factors are left to the caller.
+         */
+        node_pointer rotate(node_pointer node, int side) {
+            const auto lifted = side > 0 ? node->rightChild : node->leftChild;
+            auto &crossing = side > 0 ? lifted->leftChild : lifted->rightChild;
+            auto &vacated = side > 0 ? node->rightChild : node->leftChild;
+
+            vacated = crossing;
+            if (vacated != nullptr) {
+                vacated->setParent(node);
+            }
+            replaceInParent(node, lifted);
+            crossing = node;
+            node->setParent(lifted);
+
+            node->count = 1 + countOf(node->leftChild) + countOf(node->rightChild);
+            lifted->count = 1 + countOf(lifted->leftChild) + countOf(lifted->rightChild);
+            node->setDirty(true);
+            lifted->setDirty(true);
+            return lifted;
+        }
+
+        /**
+         * Rotates a subtree whose side (1 right, -1 left) is two levels taller than the other one
+         * and returns its new root.
+         */
+        node_pointer rebalance(node_pointer node, int side) {
+            AISDI_MAPS_TIMELINE_SPAN("TreeMap", "rebalance");
+            const auto taller = side > 0 ? node->rightChild : node->leftChild;
+            const auto tallerBalance = taller->balance() * side;
+            if (tallerBalance >= 0) {
+                const auto top = rotate(node, side);
+                node->setBalance(tallerBalance == 0 ? side : 0);
+                top->setBalance(tallerBalance == 0 ? -side : 0);
+                return top;
+            }
+
+            const auto middleBalance = (side > 0 ? taller->leftChild : taller->rightChild)->balance() * side;
+            rotate(taller, -side);
+            const auto top = rotate(node, side);
+            node->setBalance(middleBalance > 0 ? -side : 0);
+            taller->setBalance(middleBalance < 0 ? side : 0);
+            top->setBalance(0);
+            return top;
+        }
+
+        void rebalanceAfterInsert(node_pointer child) {
+            for (auto node = child->parent(); node != nullptr; child = node, node = node->parent()) {
+                const auto grown = node->leftChild == child ? -1 : 1;
+                const auto balance = node->balance() + grown;
+                if (balance == 0) {
+                    node->setBalance(0);
+                    return;
+                }
+                if (balance != grown) {
+                    // a rotation brings the subtree back to its height before the insertion
+                    rebalance(node, grown);
+                    return;
+                }
+                node->setBalance(balance);
+            }
+        }
+
+        void rebalanceAfterRemove(node_pointer node, bool leftShrunk) {
+            while (node != nullptr) {
+                const auto shrunk = leftShrunk ? -1 : 1;
+                const auto balance = node->balance() - shrunk;
+                const auto parent = node->parent();
+                const auto wasLeft = parent != nullptr && parent->leftChild == node;
+
+                if (balance == -shrunk) {
+                    node->setBalance(balance);
+                    return;
+                }
+                if (balance == 0) {
+                    node->setBalance(0);
+                } else {
+                    const auto taller = shrunk > 0 ? node->leftChild : node->rightChild;
+                    const auto tallerWasLevel = taller->balance() == 0;
+                    rebalance(node, -shrunk);
+                    if (tallerWasLevel) {
+                        return;
+                    }
+                }
+                node = parent;
+                leftShrunk = wasLeft;
+            }
+        }
+
+        node_pointer findByRank(size_type rank) const {
+            node_pointer currentNode = root;
+            while (currentNode != nullptr) {
+                const auto leftCount = countOf(currentNode->leftChild);
+                if (rank < leftCount) {
+                    currentNode = currentNode->leftChild;
+                } else if (rank == leftCount) {
+                    return currentNode;
+                } else {
+                    rank -= leftCount + 1;
+                    currentNode = currentNode->rightChild;
+                }
+            }
+            return currentNode;
+        }
+
+        /**
+         * findNode for a key not smaller than any searched before with the same finger and bounds.
+         * bounds keeps the nodes where the previous search turned left, which are the upper bounds
+         * of its path; the search restarts below the deepest one still above the key, and finger
+         * is left at the last node visited.
+         */
+        node_pointer findFrom(node_pointer &finger, std::vector<node_pointer> &bounds, const key_type &key) const {
+            node_pointer currentNode = finger;
+            if (!bounds.empty() && !(bounds.back()->key() > key)) {
+                do {
+                    currentNode = bounds.back();
+                    bounds.pop_back();
+                } while (!bounds.empty() && !(bounds.back()->key() > key));
+                finger = currentNode;
+                if (currentNode->key() != key) {
+                    currentNode = currentNode->rightChild;
+                }
+            }
+
+            while (currentNode != nullptr && currentNode->key() != key) {
+                finger = currentNode;
+                if (currentNode->key() > key) {
+                    // already there when the previous key was missing from this node's left subtree
+                    if (bounds.empty() || bounds.back() != currentNode) {
+                        bounds.push_back(currentNode);
+                    }
+                    currentNode = currentNode->leftChild;
+                } else {
+                    currentNode = currentNode->rightChild;
+                }
+            }
+            if (currentNode != nullptr) {
+                finger = currentNode;
+            }
+            return currentNode;
         }
 
         node_pointer findNode(const KeyType &key) const {
@@ -263,24 +1019,32 @@ namespace aisdi {
 
     };
 
-    template<typename KeyType, typename ValueType>
-    class TreeMap<KeyType, ValueType>::ConstIterator {
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    class TreeMap<KeyType, ValueType, ErrorPolicy>::ConstIterator {
     public:
         using reference = typename TreeMap::const_reference;
         using iterator_category = std::bidirectional_iterator_tag;
         using value_type = typename TreeMap::value_type;
+        using difference_type = std::ptrdiff_t;
         using pointer = const typename TreeMap::value_type *;
 
         friend class TreeMap;
 
-        explicit ConstIterator(const TreeMap &parent, node_pointer currentNode) : parent(parent),
+        explicit ConstIterator(const TreeMap &parent, node_pointer currentNode) : parent(&parent),
                                                                                   currentNode(currentNode) {}
 
         ConstIterator(const ConstIterator &other) : parent(other.parent), currentNode(other.currentNode) {}
 
+        ConstIterator &operator=(const ConstIterator &other) {
+            parent = other.parent;
+            currentNode = other.currentNode;
+            return *this;
+        }
+
         ConstIterator &operator++() {
             if (currentNode == nullptr) {
-                throw std::out_of_range("Iterator out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return *this;
             }
 
             if (currentNode->rightChild != nullptr) {
@@ -289,10 +1053,10 @@ namespace aisdi {
                     currentNode = currentNode->leftChild;
                 }
             } else {
-                while (currentNode->parent != nullptr && currentNode->parent->rightChild == currentNode) {
-                    currentNode = currentNode->parent;
+                while (currentNode->parent() != nullptr && currentNode->parent()->rightChild == currentNode) {
+                    currentNode = currentNode->parent();
                 }
-                currentNode = currentNode->parent;
+                currentNode = currentNode->parent();
             }
             return *this;
         }
@@ -304,12 +1068,13 @@ namespace aisdi {
         }
 
         ConstIterator &operator--() {
-            if (parent.isEmpty()) {
-                throw std::out_of_range("Iterator out of range");
+            if (parent->isEmpty()) {
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return *this;
             }
 
             if (currentNode == nullptr) {
-                currentNode = parent.maxElement();
+                currentNode = parent->maxElement();
                 return *this;
             }
 
@@ -320,14 +1085,15 @@ namespace aisdi {
                     currentNode = currentNode->rightChild;
                 }
             } else {
-                while (currentNode->parent != nullptr && currentNode->parent->leftChild == currentNode) {
-                    currentNode = currentNode->parent;
+                while (currentNode->parent() != nullptr && currentNode->parent()->leftChild == currentNode) {
+                    currentNode = currentNode->parent();
                 }
-                if (currentNode->parent == nullptr) {
+                if (currentNode->parent() == nullptr) {
                     currentNode = initialValue;
-                    throw std::out_of_range("Iterator out of range");
+                    ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                    return *this;
                 }
-                currentNode = currentNode->parent;
+                currentNode = currentNode->parent();
             }
             return *this;
         }
@@ -340,7 +1106,8 @@ namespace aisdi {
 
         reference operator*() const {
             if (currentNode == nullptr) {
-                throw std::out_of_range("Iterator out of range");
+                ErrorPolicy::fail(MapError::IteratorOutOfRange);
+                return errorValue<typename TreeMap::value_type>();
             }
             return currentNode->val;
         }
@@ -358,12 +1125,13 @@ namespace aisdi {
         }
 
     private:
-        const TreeMap &parent;
+        const TreeMap *parent;
         node_pointer currentNode;
     };
 
-    template<typename KeyType, typename ValueType>
-    class TreeMap<KeyType, ValueType>::Iterator : public TreeMap<KeyType, ValueType>::ConstIterator {
+    template<typename KeyType, typename ValueType, typename ErrorPolicy>
+    class TreeMap<KeyType, ValueType, ErrorPolicy>::Iterator
+            : public TreeMap<KeyType, ValueType, ErrorPolicy>::ConstIterator {
     public:
         using reference = typename TreeMap::reference;
         using pointer = typename TreeMap::value_type *;
@@ -401,7 +1169,9 @@ namespace aisdi {
 
         reference operator*() const {
             // ugly cast, yet reduces code duplication.
-            return const_cast<reference>(ConstIterator::operator*());
+            auto &entry = const_cast<reference>(ConstIterator::operator*());
+            TreeMap::markDirty(this->currentNode);
+            return entry;
         }
     };
 
@@ -4,12 +4,121 @@
 #include <iostream>
 #include <list>
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 
 #include "TreeMap.h"
 #include "HashMap.h"
+#include "Benchmark.h"
+#include "Timeline.h"
 
-int main()
+namespace
 {
-    aisdi::HashMap<int, int> map = {{1, 1}};
+
+struct Suite
+{
+    const char *name;
+    void (*run)();
+};
+
+const Suite suites[] = {
+    {"sampling", aisdi::benchmark::samplingSuite},
+    {"clone", aisdi::benchmark::cloneSuite},
+    {"reclamation", aisdi::benchmark::reclamationSuite},
+    {"flat", aisdi::benchmark::flatTreeMapSuite},
+    {"betree", aisdi::benchmark::beTreeMapSuite},
+    {"anymap", aisdi::benchmark::anyMapSuite},
+    {"adaptive", aisdi::benchmark::adaptiveMapSuite},
+    {"snapshot", aisdi::benchmark::snapshotSuite},
+    {"io", aisdi::benchmark::asyncWriterSuite},
+    {"memory", aisdi::benchmark::memorySuite},
+    {"batch", aisdi::benchmark::batchLookupSuite},
+    {"join", aisdi::benchmark::joinSuite},
+    {"trace", aisdi::benchmark::traceSuite},
+    {"compare", aisdi::benchmark::comparisonSuite},
+    {"contention", aisdi::benchmark::contentionSuite},
+};
+
+const Suite *findSuite(const std::string &name)
+{
+    for (const auto &suite : suites) {
+        if (name == suite.name) {
+            return &suite;
+        }
+    }
+    return nullptr;
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "usage: " << program << " [suite...]" << std::endl
+              << "       " << program << " replay tree|hash|flat|betree TRACE" << std::endl
+              << "       " << program << " sweep [CSV]" << std::endl << "suites:";
+    for (const auto &suite : suites) {
+        std::cerr << ' ' << suite.name;
+    }
+    std::cerr << std::endl << "AISDI_MAPS_THREADS=1,2,4,8 sets the thread counts of the contention suite" << std::endl
+              << "AISDI_MAPS_TIMELINE=FILE writes a Chrome trace of the run to FILE" << std::endl;
+}
+
+void runSuite(const Suite &suite)
+{
+    aisdi::TimelineSpan span("suite", suite.name);
+    suite.run();
+}
+
+int run(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::for_each(std::begin(suites), std::end(suites), runSuite);
+        return 0;
+    }
+    if (std::string(argv[1]) == "replay") {
+        if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        aisdi::TimelineSpan span("suite", "replay");
+        return aisdi::benchmark::replay(argv[2], argv[3]);
+    }
+    if (std::string(argv[1]) == "sweep") {
+        if (argc > 3) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        aisdi::TimelineSpan span("suite", "sweep");
+        return aisdi::benchmark::sweep(argc == 3 ? argv[2] : "");
+    }
+
+    std::list<const Suite *> selected;
+    for (int i = 1; i < argc; ++i) {
+        const auto suite = findSuite(argv[i]);
+        if (suite == nullptr) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        selected.push_back(suite);
+    }
+    std::for_each(selected.begin(), selected.end(), [](const Suite *suite) { runSuite(*suite); });
     return 0;
 }
+
+}
+
+int main(int argc, char **argv)
+{
+    const auto timelinePath = std::getenv("AISDI_MAPS_TIMELINE");
+    if (timelinePath == nullptr) {
+        return run(argc, argv);
+    }
+    aisdi::Timeline::start();
+    const auto status = run(argc, argv);
+    aisdi::Timeline::stop();
+    std::ofstream timeline(timelinePath);
+    aisdi::Timeline::write(timeline);
+    if (!timeline) {
+        std::cerr << "cannot write timeline " << timelinePath << std::endl;
+        return 1;
+    }
+    return status;
+}
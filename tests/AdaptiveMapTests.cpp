@@ -0,0 +1,164 @@
+#include <AdaptiveMap.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::AdaptiveMap<int, std::string>;
+using Representation = Map::Representation;
+using IndexState = Map::IndexState;
+
+namespace
+{
+
+std::vector<std::pair<int, std::string>> collectRange(Map& map, int from, int to)
+{
+  std::vector<std::pair<int, std::string>> result;
+  map.forEachInRange(from, to, [&](int key, const std::string& value) {
+    result.push_back(std::make_pair(key, value));
+  });
+  return result;
+}
+
+std::vector<std::pair<int, std::string>> collectRange(const std::map<int, std::string>& map, int from, int to)
+{
+  return std::vector<std::pair<int, std::string>>(map.lower_bound(from), map.lower_bound(to));
+}
+
+void fill(Map& map, int count)
+{
+  for (int i = 0; i < count; ++i)
+    map[i] = std::to_string(i);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AdaptiveMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenFewEntries_WhenInserting_ThenMapStaysInline)
+{
+  const int capacity = Map::INLINE_CAPACITY;
+  Map map;
+  fill(map, capacity);
+
+  BOOST_CHECK(map.getRepresentation() == Representation::Inline);
+  BOOST_CHECK_EQUAL(map.getSize(), capacity);
+  BOOST_CHECK_EQUAL(map.valueOf(3), "3");
+  BOOST_CHECK_THROW(map.valueOf(capacity), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFullInlineMap_WhenInsertingAnotherKey_ThenMapIsHashed)
+{
+  const int capacity = Map::INLINE_CAPACITY;
+  Map map;
+  fill(map, capacity + 1);
+
+  BOOST_CHECK(map.getRepresentation() == Representation::Hashed);
+  BOOST_CHECK_EQUAL(map.getSize(), capacity + 1);
+  for (int i = 0; i <= capacity; ++i)
+    BOOST_CHECK_EQUAL(map.valueOf(i), std::to_string(i));
+}
+
+BOOST_AUTO_TEST_CASE(GivenHashedMap_WhenRemovingDownToHalfCapacity_ThenMapIsInlineAgain)
+{
+  const int capacity = Map::INLINE_CAPACITY;
+  Map map;
+  fill(map, 2 * capacity);
+
+  for (int i = 0; i < 2 * capacity - capacity / 2; ++i)
+    map.remove(i);
+
+  BOOST_CHECK(map.getRepresentation() == Representation::Inline);
+  BOOST_CHECK_EQUAL(map.getSize(), capacity / 2);
+  BOOST_CHECK(!map.contains(0));
+  BOOST_CHECK_EQUAL(map.valueOf(2 * capacity - 1), std::to_string(2 * capacity - 1));
+  BOOST_CHECK_THROW(map.remove(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRepeatedRangeQueries_WhenEnoughOperationsPass_ThenIndexIsBuilt)
+{
+  const int queriesToIndex = Map::RANGE_QUERIES_TO_INDEX;
+  Map map;
+  fill(map, 1000);
+
+  for (int i = 0; i < queriesToIndex; ++i)
+    map.forEachInRange(0, 10, [](int, const std::string&) {});
+  BOOST_CHECK(map.getIndexState() == IndexState::Building);
+
+  for (int i = 0; i < 100 && map.getIndexState() != IndexState::Ready; ++i)
+    map.valueOf(i);
+  map.forEachInRange(0, 10, [](int, const std::string&) {});
+  BOOST_CHECK(map.getIndexState() == IndexState::Ready);
+
+  const auto range = collectRange(map, 995, 2000);
+  BOOST_REQUIRE_EQUAL(range.size(), 5);
+  BOOST_CHECK_EQUAL(range.front().first, 995);
+  BOOST_CHECK_EQUAL(range.back().second, "999");
+}
+
+BOOST_AUTO_TEST_CASE(GivenIndexedMap_WhenWindowPassesWithoutRangeQueries_ThenIndexIsDropped)
+{
+  const int window = Map::STATISTICS_WINDOW;
+  Map map;
+  fill(map, 1000);
+  for (int i = 0; i < window && map.getIndexState() != IndexState::Ready; ++i)
+    collectRange(map, i, i + 10);
+  BOOST_REQUIRE(map.getIndexState() == IndexState::Ready);
+
+  for (int i = 0; i < 2 * window; ++i)
+    map[i % 1000] = "updated";
+
+  BOOST_CHECK(map.getIndexState() == IndexState::Absent);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRandomOperations_WhenComparedWithStdMap_ThenResultsAreEqual)
+{
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> keys(0, 500);
+  std::uniform_int_distribution<int> operations(0, 9);
+  Map map;
+  std::map<int, std::string> expected;
+
+  for (int i = 0; i < 50000; ++i)
+  {
+    const int key = keys(generator);
+    const int operation = operations(generator);
+    if (operation < 4)
+    {
+      map[key] = std::to_string(i);
+      expected[key] = std::to_string(i);
+    }
+    else if (operation < 6)
+    {
+      if (expected.erase(key) > 0)
+        map.remove(key);
+    }
+    else
+    {
+      BOOST_REQUIRE(collectRange(map, key, key + 40) == collectRange(expected, key, key + 40));
+    }
+    BOOST_REQUIRE_EQUAL(map.getSize(), expected.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenIndexedMap_WhenCopying_ThenCopyHasSameEntries)
+{
+  Map map;
+  fill(map, 100);
+  for (int i = 0; i < 100; ++i)
+    collectRange(map, i, i + 10);
+
+  Map copy(map);
+  Map assigned;
+  assigned = map;
+
+  BOOST_CHECK_EQUAL(copy.getSize(), 100);
+  BOOST_CHECK(collectRange(copy, 0, 100) == collectRange(map, 0, 100));
+  BOOST_CHECK(collectRange(assigned, 0, 100) == collectRange(map, 0, 100));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+#include <AnyMap.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::AnyMap<int, std::string>;
+
+static_assert(aisdi::IsMap<aisdi::TreeMap<int, std::string>>::value, "TreeMap must be a map");
+static_assert(aisdi::IsMap<aisdi::HashMap<int, std::string>>::value, "HashMap must be a map");
+static_assert(aisdi::IsMap<aisdi::FlatTreeMap<int, std::string>>::value, "FlatTreeMap must be a map");
+static_assert(aisdi::IsMap<aisdi::BeTreeMap<int, std::string>>::value, "BeTreeMap must be a map");
+static_assert(!aisdi::IsMap<std::map<int, std::string>>::value, "std::map lacks valueOf and getSize");
+
+namespace
+{
+
+const std::vector<std::string> engines = { "tree", "hash", "flat", "betree" };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AnyMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenUnknownEngineName_WhenCreatingMap_ThenExceptionIsThrown)
+{
+  BOOST_CHECK_THROW(Map::create("skiplist"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(GivenAnyEngine_WhenUsingSingleOperations_ThenMapBehavesLikeOthers)
+{
+  for (const auto& engine : engines)
+  {
+    BOOST_TEST_CONTEXT("engine " << engine)
+    {
+      auto map = Map::create(engine);
+      BOOST_CHECK_EQUAL(map.getEngineName(), engine);
+      BOOST_CHECK(map.isEmpty());
+
+      map.assign(42, "Alice");
+      map.assign(27, "Bob");
+      map.assign(42, "Chuck");
+
+      BOOST_CHECK_EQUAL(map.getSize(), 2u);
+      BOOST_CHECK_EQUAL(map.valueOf(42), "Chuck");
+      map.remove(27);
+      BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+      BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenAnyEngine_WhenUsingBatchOperations_ThenResultsMatchStdMap)
+{
+  std::vector<int> keys;
+  std::vector<std::string> values;
+  for (int i = 0; i < 1000; ++i)
+  {
+    keys.push_back(i * 7 % 1000);
+    values.push_back(std::to_string(i));
+  }
+
+  for (const auto& engine : engines)
+  {
+    BOOST_TEST_CONTEXT("engine " << engine)
+    {
+      auto map = Map::create(engine);
+      map.assign(keys, values);
+      BOOST_CHECK_EQUAL(map.getSize(), 1000u);
+
+      BOOST_CHECK_EQUAL(map.remove(std::vector<int>{ 1, 2, 3, 5000 }), 3u);
+
+      std::vector<const std::string*> found;
+      BOOST_CHECK_EQUAL(map.lookup(std::vector<int>{ 0, 1, 7, 5000 }, found), 2u);
+      BOOST_REQUIRE_EQUAL(found.size(), 4u);
+      BOOST_CHECK_EQUAL(*found[0], "0");
+      BOOST_CHECK(found[1] == nullptr);
+      BOOST_CHECK_EQUAL(*found[2], "1");
+      BOOST_CHECK(found[3] == nullptr);
+
+      std::map<int, std::string> visited;
+      map.forEach([&visited](const int& key, const std::string& value) { visited[key] = value; });
+      BOOST_CHECK_EQUAL(visited.size(), 997u);
+      BOOST_CHECK_EQUAL(visited[7], "1");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
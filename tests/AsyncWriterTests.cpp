@@ -0,0 +1,254 @@
+#include <AsyncWriter.h>
+#include <HashMap.h>
+#include <MutationLog.h>
+#include <TreeMap.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+struct TemporaryFile
+{
+  std::string path;
+  int fd;
+
+  TemporaryFile() : path("/tmp/aisdiMapsTestXXXXXX")
+  {
+    fd = mkstemp(&path[0]);
+    BOOST_REQUIRE(fd >= 0);
+  }
+
+  ~TemporaryFile()
+  {
+    close(fd);
+    unlink(path.c_str());
+  }
+
+  std::string read() const
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+  }
+};
+
+std::vector<std::unique_ptr<aisdi::AsyncWriter>> allWriters()
+{
+  std::vector<std::unique_ptr<aisdi::AsyncWriter>> writers;
+  writers.push_back(aisdi::AsyncWriter::create(aisdi::AsyncBackend::Threads));
+  auto automatic = aisdi::AsyncWriter::create();
+  if (std::string(automatic->getBackendName()) != "threads")
+    writers.push_back(std::move(automatic));
+  return writers;
+}
+
+aisdi::AlignedBuffer bufferWith(const std::string& contents)
+{
+  aisdi::AlignedBuffer buffer(contents.size());
+  buffer.append(contents.data(), contents.size());
+  return buffer;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(AsyncWriterTests)
+
+BOOST_AUTO_TEST_CASE(GivenBuffer_WhenCreated_ThenItIsAlignedAndRoundedUp)
+{
+  const auto alignment = aisdi::AlignedBuffer::ALIGNMENT + 0;
+  aisdi::AlignedBuffer buffer(100);
+
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(buffer.getData()) % alignment, 0);
+  BOOST_CHECK_EQUAL(buffer.getCapacity(), alignment);
+  BOOST_CHECK_EQUAL(buffer.getSize(), 0);
+  BOOST_CHECK_THROW(buffer.append(std::string(alignment + 1, 'x').data(), alignment + 1), std::length_error);
+}
+
+BOOST_AUTO_TEST_CASE(GivenWritesAtOffsets_WhenDrained_ThenFileHoldsThemAndCallbacksRan)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      TemporaryFile file;
+      std::vector<int> errors;
+      writer->write(file.fd, bufferWith("world"), 6, [&](int error) { errors.push_back(error); });
+      writer->write(file.fd, bufferWith("hello "), 0, [&](int error) { errors.push_back(error); });
+      writer->fsync(file.fd, [&](int error) { errors.push_back(error); });
+      BOOST_CHECK_EQUAL(writer->getPendingCount(), 3);
+      writer->drain();
+
+      BOOST_CHECK_EQUAL(writer->getPendingCount(), 0);
+      BOOST_CHECK(errors == std::vector<int>(3, 0));
+      BOOST_CHECK_EQUAL(file.read(), "hello world");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenMoreWritesThanQueueDepth_WhenDrained_ThenAllComplete)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      TemporaryFile file;
+      int completed = 0;
+      for (int i = 0; i < 500; ++i)
+        writer->write(file.fd, bufferWith(std::string(1, static_cast<char>('a' + i % 26))), i,
+                      [&completed](int) { ++completed; });
+      writer->drain();
+
+      BOOST_CHECK_EQUAL(completed, 500);
+      const auto contents = file.read();
+      BOOST_REQUIRE_EQUAL(contents.size(), 500);
+      BOOST_CHECK_EQUAL(contents[27], 'b');
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenWritesAroundFsyncs_WhenDrained_ThenEachFsyncCompletesBetweenThem)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      TemporaryFile file;
+      // writes before the first fsync are 'a', between the fsyncs 'b', after both 'c'
+      std::string order;
+      int offset = 0;
+      for (const char group : std::string("abc"))
+      {
+        for (int i = 0; i < 20; ++i, ++offset)
+          writer->write(file.fd, bufferWith(std::string(1, group)), offset, [&order, group](int) { order += group; });
+        if (group != 'c')
+          writer->fsync(file.fd, [&order](int) { order += '|'; });
+        writer->submit();
+      }
+      writer->drain();
+
+      BOOST_CHECK_EQUAL(order, std::string(20, 'a') + '|' + std::string(20, 'b') + '|' + std::string(20, 'c'));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenClosedDescriptor_WhenWriting_ThenCallbackGetsError)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      int error = 0;
+      writer->write(-1, bufferWith("lost"), 0, [&error](int result) { error = result; });
+      writer->drain();
+      BOOST_CHECK_EQUAL(error, EBADF);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenCallbackQueueingWrite_WhenDraining_ThenQueuedWriteCompletesToo)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      TemporaryFile file;
+      bool secondDone = false;
+      auto& target = *writer;
+      writer->write(file.fd, bufferWith("first "), 0, [&](int) {
+        target.write(file.fd, bufferWith("second"), 6, [&secondDone](int) { secondDone = true; });
+      });
+      writer->drain();
+
+      BOOST_CHECK(secondDone);
+      BOOST_CHECK_EQUAL(file.read(), "first second");
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenWritingSnapshotAsync_ThenFileLoadsBack)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      aisdi::TreeMap<int, std::string> map;
+      for (int i = 0; i < 50000; ++i)
+        map[(i * 7919) % 50021] = std::to_string(i);
+      TemporaryFile file;
+      int result = -1;
+      const auto size = aisdi::writeSnapshotAsync(map, *writer, file.fd, [&result](int error) { result = error; });
+      writer->drain();
+
+      BOOST_CHECK_EQUAL(result, 0);
+      const auto contents = file.read();
+      BOOST_CHECK_EQUAL(contents.size(), size);
+      std::istringstream in(contents);
+      aisdi::TreeMap<int, std::string> loaded;
+      loaded.readSnapshot(in);
+      BOOST_CHECK(loaded == map);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenCommittedLog_WhenReplaying_ThenMapHasAllMutations)
+{
+  for (auto& writer : allWriters())
+  {
+    BOOST_TEST_CONTEXT("backend " << writer->getBackendName())
+    {
+      TemporaryFile file;
+      aisdi::MutationLog<int, std::string> log(*writer, file.fd);
+      int commits = 0;
+      for (int i = 0; i < 3000; ++i)
+      {
+        log.recordAssign(i, std::to_string(i));
+        if (i % 3 == 0)
+          log.recordRemove(i);
+        if (i % 1000 == 999)
+          log.commit([&commits](int error) { commits += error == 0 ? 1 : 0; });
+      }
+      writer->drain();
+      BOOST_CHECK_EQUAL(commits, 3);
+
+      std::istringstream in(file.read());
+      aisdi::HashMap<int, std::string> map;
+      BOOST_CHECK_EQUAL((aisdi::MutationLog<int, std::string>::replay(map, in)), 4000);
+      BOOST_CHECK_EQUAL(map.getSize(), 2000);
+      BOOST_CHECK_EQUAL(map.valueOf(2999), "2999");
+      BOOST_CHECK(map.find(2997) == map.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenLogCutInsideRecord_WhenReplaying_ThenCompleteRecordsAreApplied)
+{
+  auto writer = aisdi::AsyncWriter::create();
+  TemporaryFile file;
+  aisdi::MutationLog<int, std::string> log(*writer, file.fd);
+  log.recordAssign(1, "one");
+  log.recordAssign(2, "two");
+  log.commit(nullptr);
+  writer->drain();
+
+  const auto contents = file.read();
+  std::istringstream in(contents.substr(0, contents.size() - 2) + std::string(16, '\0'));
+  aisdi::TreeMap<int, std::string> map;
+  BOOST_CHECK_EQUAL((aisdi::MutationLog<int, std::string>::replay(map, in)), 1);
+  BOOST_CHECK_EQUAL(map.getSize(), 1);
+
+  std::istringstream notLog("not a log at all");
+  BOOST_CHECK_THROW((aisdi::MutationLog<int, std::string>::replay(map, notLog)), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+#include <BeTreeMap.h>
+
+#include <cstdint>
+#include <string>
+#include <map>
+#include <random>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+template <typename K>
+using Map = aisdi::BeTreeMap<K, std::string>;
+
+using TestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t>;
+using std::begin;
+using std::end;
+
+BOOST_AUTO_TEST_SUITE(BeTreeMapTests)
+
+template <typename K>
+void thenMapContainsItems(const Map<K>& map,
+                          const std::map<K, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  for (const auto& item : expected)
+  {
+    const auto it = map.find(item.first);
+    BOOST_REQUIRE_MESSAGE(it != end(map), "Missing required item with key: " << item.first);
+    BOOST_CHECK_MESSAGE(it->second == item.second,
+                        "Wrong value in map for key: " << item.first
+                        << " (expected: \"" << item.second
+                        << "\" got: \"" << it->second << "\")");
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(begin(map) == end(map));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenInitializingFromListOfPairs_ThenAllItemsAreInMap,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 753, "Rome" }, { 1789, "Paris" } };
+
+  thenMapContainsItems(map, { { 753, "Rome" }, { 1789, "Paris" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNonEmptyMap_WhenChangingItem_ThenNewValueIsInMap,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 27, "Bob" } };
+
+  map[27] = "Chuck";
+  map.insert(42, "Alice");
+
+  thenMapContainsItems(map, { { 27, "Chuck" }, { 42, "Alice" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNotEmptyMap_WhenRemovingMissingKey_ThenExceptionIsThrown,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  BOOST_CHECK_THROW(map.remove(1), std::out_of_range);
+  BOOST_CHECK_THROW(map.valueOf(1), std::out_of_range);
+  BOOST_CHECK_THROW(map.remove(end(map)), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEndIterator_WhenDecrementing_ThenIteratorPointsToLastItem,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  auto it = end(map);
+  --it;
+
+  BOOST_CHECK_EQUAL(it->first, K{42});
+  BOOST_CHECK_THROW(--begin(map), std::out_of_range);
+  BOOST_CHECK_THROW(++end(map), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyLeaves_WhenDecrementingEndAfterBufferedChanges_ThenLastItemIsCurrent)
+{
+  Map<int> map;
+  for (int i = 0; i < 1000; ++i)
+    map.insert(i, std::to_string(i));
+  BOOST_REQUIRE_EQUAL((--end(map))->first, 999);
+
+  map.insert(5000, "inserted");
+  BOOST_CHECK_EQUAL((--end(map))->first, 5000);
+
+  map.remove(5000);
+  map.remove(999);
+  BOOST_CHECK_EQUAL((--end(map))->first, 998);
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyRandomOperations_WhenComparedWithStdMap_ThenContentsMatch)
+{
+  Map<int> map;
+  std::map<int, std::string> expected;
+  std::mt19937 generator(5);
+
+  for (int i = 0; i < 60000; ++i)
+  {
+    const int key = static_cast<int>(generator() % 20000);
+    const auto operation = generator() % 8;
+    if (operation == 0 && expected.count(key) != 0)
+    {
+      map.remove(key);
+      expected.erase(key);
+    }
+    else if (operation == 1)
+    {
+      const auto found = expected.find(key);
+      if (found == expected.end())
+        BOOST_REQUIRE_THROW(map.valueOf(key), std::out_of_range);
+      else
+        BOOST_REQUIRE_EQUAL(map.valueOf(key), found->second);
+    }
+    else
+    {
+      map.insert(key, std::to_string(i));
+      expected[key] = std::to_string(i);
+    }
+  }
+
+  thenMapContainsItems(map, expected);
+  BOOST_CHECK(std::equal(expected.begin(), expected.end(), begin(map),
+                         [](const std::pair<const int, std::string>& a,
+                            const std::pair<const int&, const std::string&>& b) {
+                           return a.first == b.first && a.second == b.second;
+                         }));
+
+  std::size_t backwards = 0;
+  for (auto it = end(map); it != begin(map); ++backwards)
+    --it;
+  BOOST_CHECK_EQUAL(backwards, expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(GivenLargeMap_WhenCopying_ThenCopyIsEqual)
+{
+  Map<int> map;
+  for (int i = 0; i < 10000; ++i)
+    map.insert(i * 3, std::to_string(i));
+
+  const Map<int> copy{map};
+  Map<int> assigned;
+  assigned = copy;
+
+  BOOST_CHECK(copy == map);
+  BOOST_CHECK(assigned == map);
+  map[0] = "changed";
+  BOOST_CHECK(copy != map);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
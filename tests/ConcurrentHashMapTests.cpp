@@ -0,0 +1,104 @@
+#include <ConcurrentHashMap.h>
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::ConcurrentHashMap<int, std::string>;
+
+BOOST_AUTO_TEST_SUITE(ConcurrentHashMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty)
+{
+  const Map map;
+
+  BOOST_CHECK(map.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenAddingItem_ThenItemIsInMap)
+{
+  Map map;
+
+  BOOST_CHECK(map.insertOrAssign(27, "Bob"));
+
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK_EQUAL(map.valueOf(27), "Bob");
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenChangingItem_ThenNewValueIsInMap)
+{
+  Map map = { { 27, "Bob" } };
+
+  BOOST_CHECK(!map.insertOrAssign(27, "Chuck"));
+
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK_EQUAL(map.valueOf(27), "Chuck");
+}
+
+BOOST_AUTO_TEST_CASE(GivenNotEmptyMap_WhenReadingValueOfMissingKey_ThenExceptionIsThrown)
+{
+  const Map map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  BOOST_CHECK_THROW(map.valueOf(1), std::out_of_range);
+  BOOST_CHECK(!map.contains(1));
+}
+
+BOOST_AUTO_TEST_CASE(GivenNotEmptyMap_WhenRemovingValueByKey_ThenItemIsRemoved)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  map.remove(27);
+
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK(!map.contains(27));
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenGrowingMap_WhenResizing_ThenAllItemsRemainReachable)
+{
+  Map map;
+  const auto initialBuckets = map.getBucketCount();
+
+  for (int i = 0; i < 10000; ++i)
+  {
+    map.insertOrAssign(i, std::to_string(i));
+    BOOST_REQUIRE(map.contains(i / 2));
+  }
+
+  BOOST_CHECK_GT(map.getBucketCount(), initialBuckets);
+  BOOST_CHECK_EQUAL(map.getSize(), 10000u);
+  for (int i = 0; i < 10000; ++i)
+    BOOST_REQUIRE_EQUAL(map.valueOf(i), std::to_string(i));
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyThreads_WhenInsertingAndRemovingConcurrently_ThenEveryThreadSeesItsItems)
+{
+  Map map;
+  const int threadCount = 4;
+  const int itemsPerThread = 5000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&map, t]() {
+      for (int i = t; i < threadCount * itemsPerThread; i += threadCount)
+        map.insertOrAssign(i, std::to_string(i));
+      for (int i = t; i < threadCount * itemsPerThread; i += 2 * threadCount)
+        map.remove(i);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  BOOST_CHECK_EQUAL(map.getSize(), static_cast<std::size_t>(threadCount * itemsPerThread / 2));
+  for (int i = 0; i < threadCount * itemsPerThread; ++i)
+  {
+    const bool removed = (i % (2 * threadCount)) < threadCount;
+    BOOST_REQUIRE_EQUAL(map.contains(i), !removed);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
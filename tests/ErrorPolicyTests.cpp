@@ -0,0 +1,152 @@
+#include <ErrorPolicy.h>
+
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+using ReportingMaps = boost::mpl::list<aisdi::TreeMap<int, std::string, aisdi::ReportError>,
+                                       aisdi::HashMap<int, std::string, aisdi::ReportError>>;
+
+using ThrowingMaps = boost::mpl::list<aisdi::TreeMap<int, std::string>, aisdi::HashMap<int, std::string>>;
+
+// default construction throws while fail is set
+struct FailingDefault
+{
+  static bool fail;
+  std::string text;
+
+  FailingDefault() : text("default text, long enough to be allocated")
+  {
+    if (fail)
+      throw std::runtime_error("construction failed");
+  }
+};
+
+bool FailingDefault::fail = false;
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ErrorPolicyTests)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenThrowingMap_WhenMissingKey_ThenOutOfRangeIsThrown, Map, ThrowingMaps)
+{
+  Map map = { { 1, "one" } };
+  const auto& constMap = map;
+
+  BOOST_CHECK_THROW(map.valueOf(2), std::out_of_range);
+  BOOST_CHECK_THROW(constMap.valueOf(2), std::out_of_range);
+  BOOST_CHECK_THROW(map.remove(2), std::out_of_range);
+  BOOST_CHECK_THROW(*map.end(), std::out_of_range);
+  BOOST_CHECK_THROW(++map.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReportingMap_WhenReadingMissingKey_ThenDefaultIsReturnedAndErrorSet, Map,
+                              ReportingMaps)
+{
+  Map map = { { 1, "one" } };
+  aisdi::lastMapError() = aisdi::MapError::None;
+
+  BOOST_CHECK_EQUAL(map.valueOf(1), "one");
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::None);
+
+  map.valueOf(2) = "written to the error value";
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::MissingKey);
+  BOOST_CHECK_EQUAL(map.valueOf(2), "");
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReportingMap_WhenRemovingMissingKey_ThenNothingChanges, Map, ReportingMaps)
+{
+  Map map = { { 1, "one" }, { 2, "two" } };
+  aisdi::lastMapError() = aisdi::MapError::None;
+
+  map.remove(3);
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::MissingKey);
+
+  aisdi::lastMapError() = aisdi::MapError::None;
+  map.remove(map.end());
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::IteratorOutOfRange);
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+
+  map.remove(1);
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReportingMap_WhenIteratingOutOfRange_ThenIteratorStaysAndErrorIsSet, Map,
+                              ReportingMaps)
+{
+  Map map = { { 1, "one" } };
+  aisdi::lastMapError() = aisdi::MapError::None;
+
+  auto it = map.end();
+  ++it;
+  BOOST_CHECK(it == map.end());
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::IteratorOutOfRange);
+  BOOST_CHECK_EQUAL((*it).second, "");
+
+  aisdi::lastMapError() = aisdi::MapError::None;
+  auto first = map.begin();
+  --first;
+  BOOST_CHECK(first == map.begin());
+  BOOST_CHECK(aisdi::lastMapError() == aisdi::MapError::IteratorOutOfRange);
+  BOOST_CHECK_EQUAL(first->second, "one");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReportingMap_WhenDereferencingEndAgain_ThenEntryIsResetToDefault, Map,
+                              ReportingMaps)
+{
+  Map map = { { 1, "one" } };
+
+  (*map.end()).second = "written to the error value";
+  BOOST_CHECK_EQUAL((*map.end()).first, 0);
+  BOOST_CHECK_EQUAL((*map.end()).second, "");
+}
+
+BOOST_AUTO_TEST_CASE(GivenValueFailingToConstruct_WhenResettingErrorValue_ThenItStaysUsable)
+{
+  bool threw = false;
+  std::string kept;
+  // on its own thread, so the value is destroyed at the end of the test
+  std::thread thread([&threw, &kept]()
+  {
+    aisdi::errorValue<FailingDefault>().text = "written text, long enough to be allocated";
+    FailingDefault::fail = true;
+    try
+    {
+      aisdi::errorValue<FailingDefault>();
+    }
+    catch (const std::runtime_error&)
+    {
+      threw = true;
+    }
+    FailingDefault::fail = false;
+    kept = aisdi::errorValue<FailingDefault>().text;
+  });
+  thread.join();
+
+  BOOST_CHECK(threw);
+  BOOST_CHECK_EQUAL(kept, "default text, long enough to be allocated");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenAnyPolicy_WhenUsingTryOperations_ThenNoErrorIsRaised, Map, ThrowingMaps)
+{
+  Map map = { { 1, "one" } };
+
+  BOOST_REQUIRE(map.tryValueOf(1) != nullptr);
+  BOOST_CHECK_EQUAL(*map.tryValueOf(1), "one");
+  BOOST_CHECK(map.tryValueOf(2) == nullptr);
+  BOOST_CHECK(!map.tryRemove(2));
+  BOOST_CHECK(map.tryRemove(1));
+  BOOST_CHECK(map.isEmpty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
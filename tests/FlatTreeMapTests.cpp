@@ -0,0 +1,199 @@
+#include <FlatTreeMap.h>
+
+#include <cstdint>
+#include <string>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+template <typename K>
+using Map = aisdi::FlatTreeMap<K, std::string>;
+
+using TestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t>;
+using std::begin;
+using std::end;
+
+BOOST_AUTO_TEST_SUITE(FlatTreeMapTests)
+
+template <typename K>
+void thenMapContainsItems(const Map<K>& map,
+                          const std::map<K, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  for (const auto& item : expected)
+  {
+    const auto it = map.find(item.first);
+    BOOST_REQUIRE_MESSAGE(it != end(map), "Missing required item with key: " << item.first);
+    BOOST_CHECK_MESSAGE(it->second == item.second,
+                        "Wrong value in map for key: " << item.first
+                        << " (expected: \"" << item.second
+                        << "\" got: \"" << it->second << "\")");
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(begin(map) == end(map));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEmptyMap_WhenAddingItem_ThenItemIsInMap,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+
+  map[K{27}] = "Bob";
+
+  thenMapContainsItems(map, { { 27, "Bob" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenInitializingFromListOfPairs_ThenAllItemsAreInMap,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 753, "Rome" }, { 1789, "Paris" }, { 42, "Answer" } };
+
+  thenMapContainsItems(map, { { 753, "Rome" }, { 1789, "Paris" }, { 42, "Answer" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenListWithRepeatedKeys_WhenInitializing_ThenLastValueWins,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 1, "First" }, { 2, "Other" }, { 1, "Second" } };
+
+  thenMapContainsItems(map, { { 1, "Second" }, { 2, "Other" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenIterating_ThenItemsAreInKeyOrder,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 50, "E" }, { 10, "A" }, { 30, "C" }, { 20, "B" }, { 40, "D" } };
+
+  std::string concatenated;
+  K previous{};
+  for (const auto& item : map)
+  {
+    BOOST_CHECK(previous < item.first);
+    previous = item.first;
+    concatenated += item.second;
+  }
+  BOOST_CHECK_EQUAL(concatenated, "ABCDE");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEndIterator_WhenDecrementing_ThenIteratorPointsToLastItem,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  auto it = end(map);
+  --it;
+
+  BOOST_CHECK_EQUAL(it->first, K{42});
+  BOOST_CHECK_THROW(++end(map), std::out_of_range);
+  BOOST_CHECK_THROW(--begin(map), std::out_of_range);
+  BOOST_CHECK_THROW(*end(map), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenIterator_WhenDereferencing_ThenItemCanBeChanged,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" } };
+
+  auto it = begin(map);
+  it->second = "Bob";
+
+  thenMapContainsItems(map, { { 42, "Bob" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNotEmptyMap_WhenReadingValueOfMissingKey_ThenExceptionIsThrown,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  BOOST_CHECK_THROW(map.valueOf(1), std::out_of_range);
+  BOOST_CHECK_EQUAL(map.valueOf(27), "Bob");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNotEmptyMap_WhenRemovingItems_ThenTheyAreGone,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" }, { 27, "Bob" }, { 13, "Chuck" } };
+
+  map.remove(27);
+  map.remove(map.find(13));
+
+  thenMapContainsItems(map, { { 42, "Alice" } });
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_THROW(map.remove(end(map)), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenComparingThem_ThenOnlyEqualContentsAreEqual,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+  const Map<K> equivalent = { { 27, "Bob" }, { 42, "Alice" } };
+  const Map<K> different = { { 27, "Alice" }, { 42, "Bob" } };
+
+  BOOST_CHECK(map == equivalent);
+  BOOST_CHECK(map != different);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNonEmptyMap_WhenInsertingBatch_ThenBatchIsMergedAndValuesAssigned,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 10, "A" }, { 30, "C" }, { 50, "E" } };
+  const std::vector<std::pair<K, std::string>> batch = { { 40, "D" }, { 30, "c" }, { 60, "F" }, { 20, "B" } };
+
+  map.insert(batch.begin(), batch.end());
+
+  thenMapContainsItems(map, { { 10, "A" }, { 20, "B" }, { 30, "c" }, { 40, "D" }, { 50, "E" }, { 60, "F" } });
+}
+
+BOOST_AUTO_TEST_CASE(GivenRandomOperations_WhenComparedWithStdMap_ThenContentsMatch)
+{
+  Map<int> map;
+  std::map<int, std::string> expected;
+  std::mt19937 generator(11);
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    const int key = static_cast<int>(generator() % 500);
+    if (generator() % 3 == 0 && expected.count(key) != 0)
+    {
+      map.remove(key);
+      expected.erase(key);
+    }
+    else
+    {
+      map[key] = std::to_string(i);
+      expected[key] = std::to_string(i);
+    }
+  }
+
+  thenMapContainsItems(map, expected);
+  BOOST_CHECK(std::equal(expected.begin(), expected.end(), begin(map),
+                         [](const std::pair<const int, std::string>& a,
+                            const std::pair<const int&, const std::string&>& b) {
+                           return a.first == b.first && a.second == b.second;
+                         }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
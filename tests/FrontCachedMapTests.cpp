@@ -0,0 +1,129 @@
+#include <FrontCachedMap.h>
+
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+using Maps = boost::mpl::list<aisdi::FrontCachedMap<aisdi::TreeMap<int, std::string>>,
+                              aisdi::FrontCachedMap<aisdi::HashMap<int, std::string>, 16, aisdi::SharedMutex>>;
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FrontCachedMapTests)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReader_WhenLookingUpKeyAgain_ThenItIsServedFromCache, Map, Maps)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+  auto reader = map.reader();
+
+  BOOST_CHECK_EQUAL(reader.valueOf(42), "Alice");
+  BOOST_CHECK_EQUAL(reader.valueOf(42), "Alice");
+  BOOST_CHECK(reader.contains(42));
+  BOOST_CHECK(!reader.contains(1));
+
+  BOOST_CHECK_EQUAL(reader.getHits(), 2u);
+  BOOST_CHECK_EQUAL(reader.getMisses(), 2u);
+  BOOST_CHECK_EQUAL(reader.getSize(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenCachedKey_WhenItIsWritten_ThenReaderSeesNewValue, Map, Maps)
+{
+  Map map = { { 42, "Alice" } };
+  auto reader = map.reader();
+  auto writer = map.reader();
+  BOOST_CHECK_EQUAL(reader.valueOf(42), "Alice");
+
+  BOOST_CHECK(!map.insertOrAssign(42, "Bob"));
+  BOOST_CHECK_EQUAL(reader.valueOf(42), "Bob");
+  BOOST_CHECK(!writer.insertOrAssign(42, "Chuck"));
+  BOOST_CHECK_EQUAL(reader.valueOf(42), "Chuck");
+
+  BOOST_CHECK_EQUAL(reader.getHits(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenCachedKey_WhenItIsRemoved_ThenReaderDoesNotFindIt, Map, Maps)
+{
+  Map map = { { 42, "Alice" } };
+  auto reader = map.reader();
+  BOOST_CHECK(reader.contains(42));
+
+  map.remove(42);
+
+  BOOST_CHECK(!reader.contains(42));
+  BOOST_CHECK_THROW(reader.valueOf(42), std::out_of_range);
+  BOOST_CHECK_THROW(reader.remove(42), std::out_of_range);
+  BOOST_CHECK(reader.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenKeysSharingSlot_WhenLookingThemUpInTurn_ThenEachGetsItsOwnValue)
+{
+  aisdi::FrontCachedMap<aisdi::HashMap<int, std::string>, 1> map = { { 1, "one" }, { 2, "two" } };
+  auto reader = map.reader();
+
+  for (int i = 0; i < 3; ++i)
+  {
+    BOOST_CHECK_EQUAL(reader.valueOf(1), "one");
+    BOOST_CHECK_EQUAL(reader.valueOf(2), "two");
+  }
+  BOOST_CHECK_EQUAL(reader.getHits(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(GivenWriterThread_WhenReadingConcurrently_ThenValuesNeverGoBack)
+{
+  aisdi::FrontCachedMap<aisdi::TreeMap<int, int>, 64, aisdi::SharedMutex> map = { { 0, 0 } };
+  const int writes = 20000;
+
+  std::thread writer([&map, writes]() {
+    for (int value = 1; value <= writes; ++value)
+      map.insertOrAssign(0, value);
+  });
+  auto reader = map.reader();
+  int last = 0;
+  while (last < writes)
+  {
+    const auto value = reader.valueOf(0);
+    BOOST_REQUIRE_GE(value, last);
+    last = value;
+  }
+  writer.join();
+
+  BOOST_CHECK_EQUAL(reader.valueOf(0), writes);
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyReaderThreads_WhenMissingTheirCaches_ThenReadsDoNotRace)
+{
+  // one slot, so most lookups go to the map under the shared lock; run under ThreadSanitizer
+  aisdi::FrontCachedMap<aisdi::HashMap<int, int>, 1, aisdi::SharedMutex> map;
+  const int keys = 64;
+  for (int key = 0; key < keys; ++key)
+    map.insertOrAssign(key, key * 2);
+
+  std::vector<std::thread> readers;
+  std::vector<int> mismatches(4, 0);
+  for (std::size_t t = 0; t < mismatches.size(); ++t)
+    readers.emplace_back([&map, &mismatches, keys, t]() {
+      auto reader = map.reader();
+      for (int i = 0; i < 2000; ++i)
+      {
+        const int key = (i * 7 + static_cast<int>(t)) % keys;
+        mismatches[t] += reader.valueOf(key) != key * 2;
+      }
+    });
+  for (auto& reader : readers)
+    reader.join();
+
+  for (const auto count : mismatches)
+    BOOST_CHECK_EQUAL(count, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,9 +1,14 @@
 #include <HashMap.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
 #include <functional>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -123,6 +128,22 @@ struct Fixture
   }
 };
 
+// copying a negative value throws, as a failed allocation would
+struct ThrowingCopy
+{
+  int value;
+
+  ThrowingCopy(int value_ = 0) : value(value_) {}
+
+  ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+  {
+    if (value < 0)
+      throw std::runtime_error("copy failed");
+  }
+
+  ThrowingCopy& operator=(const ThrowingCopy&) = default;
+};
+
 } // namespace
 
 namespace std
@@ -375,6 +396,26 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(GivenIterator_WhenPostDecrementing_ThenOldIterator
   BOOST_CHECK_EQUAL(it->first, 1);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenManyItems_WhenDecrementingFromEnd_ThenAllItemsAreVisitedInReverse,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  for (int i = 0; i < 40; ++i)
+    map[i] = std::to_string(i);
+
+  std::vector<K> forward;
+  for (auto it = map.begin(); it != map.end(); ++it)
+    forward.push_back(it->first);
+
+  std::vector<K> backward;
+  for (auto it = map.end(); it != map.begin();)
+    backward.push_back((--it)->first);
+
+  BOOST_REQUIRE_EQUAL(backward.size(), forward.size());
+  BOOST_CHECK(std::equal(forward.rbegin(), forward.rend(), backward.begin()));
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBeginIterator_WhenDecrementing_ThenOperationThrows,
                               K,
                               TestedKeyTypes)
@@ -801,6 +842,122 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMapsWithDifferentKeys_WhenComparingThem_Th
   BOOST_CHECK(map != other);
 }
 
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenPickingRandomEntry_ThenEndIsReturned)
+{
+  const Map<int> map;
+  std::mt19937 generator(42);
+
+  BOOST_CHECK(map.randomEntry(generator) == end(map));
+  BOOST_CHECK(map.sample(3, generator).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenPickingRandomEntries_ThenEachEntryIsEquallyLikely)
+{
+  Map<int> map;
+  for (int i = 0; i < 20; ++i)
+    map[i * 7] = std::to_string(i);
+  std::mt19937 generator(42);
+  std::map<int, std::size_t> hits;
+
+  const std::size_t draws = 200000;
+  for (std::size_t i = 0; i < draws; ++i)
+    ++hits[map.randomEntry(generator)->first];
+
+  BOOST_REQUIRE_EQUAL(hits.size(), map.getSize());
+  for (const auto& hit : hits)
+  {
+    BOOST_CHECK_MESSAGE(hit.second > draws / 20 * 9 / 10 && hit.second < draws / 20 * 11 / 10,
+                        "Key " << hit.first << " drawn " << hit.second << " times");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenSampling_ThenDistinctEntriesAreEquallyLikely)
+{
+  Map<int> map;
+  for (int i = 0; i < 10; ++i)
+    map[i] = std::to_string(i);
+  std::mt19937 generator(7);
+  std::map<int, std::size_t> hits;
+
+  const std::size_t rounds = 50000;
+  for (std::size_t i = 0; i < rounds; ++i)
+  {
+    const auto picked = map.sample(3, generator);
+    BOOST_REQUIRE_EQUAL(picked.size(), 3u);
+    std::set<int> keys;
+    for (const auto& it : picked)
+      keys.insert(it->first);
+    BOOST_REQUIRE_EQUAL(keys.size(), 3u);
+    for (auto key : keys)
+      ++hits[key];
+  }
+
+  for (const auto& hit : hits)
+  {
+    BOOST_CHECK_MESSAGE(hit.second > rounds * 3 / 10 * 9 / 10 && hit.second < rounds * 3 / 10 * 11 / 10,
+                        "Key " << hit.first << " sampled " << hit.second << " times");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenSamplingMoreThanItsSize_ThenAllEntriesAreReturned)
+{
+  const Map<int> map = { { 1, "Alice" }, { 2, "Bob" }, { 3, "Chuck" } };
+  std::mt19937 generator(1);
+
+  const auto picked = map.sample(10, generator);
+
+  std::set<int> keys;
+  for (const auto& it : picked)
+    keys.insert(it->first);
+  BOOST_CHECK(keys == std::set<int>({ 1, 2, 3 }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenCloningInParallel_ThenCloneEqualsSequentialCopy)
+{
+  Map<int> map;
+  std::mt19937 generator(3);
+  for (int i = 0; i < 5000; ++i)
+    map[static_cast<int>(generator() % 100000)] = std::to_string(i);
+  aisdi::ThreadPool pool(4);
+
+  const Map<int> clone = map.clone(pool);
+  const Map<int> copy{map};
+
+  BOOST_CHECK_EQUAL(clone.getSize(), map.getSize());
+  BOOST_CHECK(std::equal(begin(clone), end(clone), begin(copy)));
+  BOOST_CHECK(clone == map);
+}
+
+BOOST_AUTO_TEST_CASE(GivenValueFailingToCopy_WhenCloningInParallel_ThenExceptionIsThrownOnceWorkersFinished)
+{
+  aisdi::HashMap<int, ThrowingCopy> map;
+  for (int i = 0; i < 5000; ++i)
+    map[i] = ThrowingCopy(i);
+  map[0] = ThrowingCopy(-1);
+  aisdi::ThreadPool pool(4);
+
+  BOOST_CHECK_THROW(map.clone(pool), std::runtime_error);
+  BOOST_CHECK_EQUAL(map.getSize(), 5000u);
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenCloningInParallel_ThenCloneIsEmpty)
+{
+  const Map<int> map;
+  aisdi::ThreadPool pool(2);
+
+  BOOST_CHECK(map.clone(pool).isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenMapWithManyBuckets_WhenSearchingForMissingKey_ThenEndIsReturned)
+{
+  Map<int> map;
+  for (int i = 0; i < 30; ++i)
+    map[i] = std::to_string(i);
+
+  for (int missing = 100; missing < 130; ++missing)
+    BOOST_CHECK(map.find(missing) == end(map));
+}
+
 // ConstIterator is tested via Iterator methods.
 // If Iterator methods are to be changed, then new ConstIterator tests are required.
 
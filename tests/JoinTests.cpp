@@ -0,0 +1,162 @@
+#include <Join.h>
+
+#include <FlatTreeMap.h>
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+const std::vector<aisdi::JoinKind> kinds = { aisdi::JoinKind::Inner, aisdi::JoinKind::Left,
+                                             aisdi::JoinKind::Semi, aisdi::JoinKind::Anti };
+
+// key, left value, right value or "-" for none
+using Row = std::tuple<int, std::string, std::string>;
+
+template <typename Rows>
+std::vector<Row> normalized(const Rows& rows, bool sort = true)
+{
+  std::vector<Row> result;
+  for (const auto& row : rows)
+    result.emplace_back(*row.key, *row.left, row.right == nullptr ? std::string("-") : *row.right);
+  if (sort)
+    std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<Row> expected(const std::map<int, std::string>& left, const std::map<int, std::string>& right,
+                          aisdi::JoinKind kind)
+{
+  std::vector<Row> rows;
+  for (const auto& entry : left)
+  {
+    const auto match = right.find(entry.first);
+    const bool matched = match != right.end();
+    if ((kind == aisdi::JoinKind::Inner || kind == aisdi::JoinKind::Semi) && matched)
+      rows.emplace_back(entry.first, entry.second, match->second);
+    else if (kind == aisdi::JoinKind::Left)
+      rows.emplace_back(entry.first, entry.second, matched ? match->second : "-");
+    else if (kind == aisdi::JoinKind::Anti && !matched)
+      rows.emplace_back(entry.first, entry.second, "-");
+  }
+  return rows;
+}
+
+template <typename Map>
+Map fill(const std::map<int, std::string>& source)
+{
+  Map map;
+  for (const auto& entry : source)
+    map[entry.first] = entry.second;
+  return map;
+}
+
+struct Relations
+{
+  std::map<int, std::string> left;
+  std::map<int, std::string> right;
+
+  explicit Relations(std::size_t size)
+  {
+    std::mt19937 generator(static_cast<unsigned>(size));
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const auto key = static_cast<int>(generator() % (size * 2));
+      left[key] = "L" + std::to_string(i);
+      right[static_cast<int>(generator() % (size * 2))] = "R" + std::to_string(i);
+    }
+  }
+};
+
+std::string kindName(aisdi::JoinKind kind)
+{
+  const char* names[] = { "inner", "left", "semi", "anti" };
+  return names[static_cast<int>(kind)];
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(JoinTests)
+
+BOOST_AUTO_TEST_CASE(GivenHashMaps_WhenHashJoining_ThenRowsMatchReference)
+{
+  const Relations relations(3000);
+  const auto left = fill<aisdi::HashMap<int, std::string>>(relations.left);
+  const auto right = fill<aisdi::HashMap<int, std::string>>(relations.right);
+  aisdi::ThreadPool pool(3);
+
+  for (auto kind : kinds)
+  {
+    BOOST_TEST_CONTEXT("kind " << kindName(kind))
+    {
+      const auto reference = expected(relations.left, relations.right, kind);
+      BOOST_CHECK(normalized(aisdi::hashJoin(left, right, kind)) == reference);
+      BOOST_CHECK(normalized(aisdi::hashJoin(left, right, kind, pool)) == reference);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenLargeRightSide_WhenHashJoining_ThenManyPartitionsGiveSameRows)
+{
+  // enough build entries to exceed any L2 cache and split into several partitions
+  const Relations relations(200000);
+  const auto left = fill<aisdi::TreeMap<int, std::string>>(relations.left);
+  const auto right = fill<aisdi::TreeMap<int, std::string>>(relations.right);
+  aisdi::ThreadPool pool(4);
+
+  const auto reference = expected(relations.left, relations.right, aisdi::JoinKind::Left);
+  BOOST_CHECK(normalized(aisdi::hashJoin(left, right, aisdi::JoinKind::Left, pool)) == reference);
+}
+
+BOOST_AUTO_TEST_CASE(GivenOrderedMaps_WhenMergeJoining_ThenRowsMatchReferenceInKeyOrder)
+{
+  const Relations relations(3000);
+  const auto left = fill<aisdi::TreeMap<int, std::string>>(relations.left);
+  const auto right = fill<aisdi::FlatTreeMap<int, std::string>>(relations.right);
+  aisdi::ThreadPool pool(3);
+
+  for (auto kind : kinds)
+  {
+    BOOST_TEST_CONTEXT("kind " << kindName(kind))
+    {
+      const auto reference = expected(relations.left, relations.right, kind);
+      BOOST_CHECK(normalized(aisdi::mergeJoin(left, right, kind), false) == reference);
+      BOOST_CHECK(normalized(aisdi::mergeJoin(left, right, kind, pool), false) == reference);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptySide_WhenJoining_ThenOnlyOuterRowsRemain)
+{
+  const aisdi::TreeMap<int, std::string> left = { { 1, "a" }, { 2, "b" } };
+  const aisdi::TreeMap<int, std::string> right;
+  aisdi::ThreadPool pool(2);
+
+  BOOST_CHECK(aisdi::hashJoin(left, right, aisdi::JoinKind::Inner).empty());
+  BOOST_CHECK_EQUAL(aisdi::hashJoin(left, right, aisdi::JoinKind::Anti, pool).size(), 2u);
+  BOOST_CHECK_EQUAL(aisdi::mergeJoin(left, right, aisdi::JoinKind::Left, pool).size(), 2u);
+  BOOST_CHECK(aisdi::mergeJoin(right, left, aisdi::JoinKind::Left, pool).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenJoinRows_WhenReadingThem_ThenTheyPointIntoTheMaps)
+{
+  const aisdi::HashMap<int, std::string> left = { { 1, "a" } };
+  const aisdi::HashMap<int, std::string> right = { { 1, "b" } };
+
+  const auto rows = aisdi::hashJoin(left, right, aisdi::JoinKind::Inner);
+
+  BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+  BOOST_CHECK_EQUAL(rows[0].left, &left.valueOf(1));
+  BOOST_CHECK_EQUAL(rows[0].right, &right.valueOf(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
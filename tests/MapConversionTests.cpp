@@ -0,0 +1,89 @@
+#include <MapConversion.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(MapConversionTests)
+
+BOOST_AUTO_TEST_CASE(GivenHashMap_WhenConvertingToTreeMap_ThenEntriesAreMovedInKeyOrder)
+{
+  aisdi::HashMap<int, std::string> hashMap;
+  for (int i = 0; i < 100; ++i)
+    hashMap[(i * 37) % 100] = std::to_string((i * 37) % 100);
+
+  auto treeMap = aisdi::toTreeMap(std::move(hashMap));
+
+  BOOST_CHECK(hashMap.isEmpty());
+  BOOST_CHECK(hashMap.begin() == hashMap.end());
+  BOOST_CHECK_EQUAL(treeMap.getSize(), 100u);
+  BOOST_CHECK_EQUAL(treeMap.getHeight(), 7u);
+  int expected = 0;
+  for (const auto& entry : treeMap)
+  {
+    BOOST_CHECK_EQUAL(entry.first, expected);
+    BOOST_CHECK_EQUAL(entry.second, std::to_string(expected));
+    ++expected;
+  }
+  BOOST_CHECK_EQUAL(expected, 100);
+
+  treeMap[100] = "100";
+  treeMap.remove(0);
+  BOOST_CHECK_EQUAL(treeMap.getSize(), 100u);
+  BOOST_CHECK_EQUAL(treeMap.valueOf(100), "100");
+}
+
+BOOST_AUTO_TEST_CASE(GivenTreeMap_WhenConvertingToHashMap_ThenEntriesAreMoved)
+{
+  aisdi::TreeMap<int, std::string> treeMap = { { 42, "Alice" }, { 27, "Bob" }, { 3, "Chuck" } };
+
+  auto hashMap = aisdi::toHashMap(std::move(treeMap));
+
+  BOOST_CHECK(treeMap.isEmpty());
+  BOOST_CHECK_EQUAL(hashMap.getSize(), 3u);
+  BOOST_CHECK_EQUAL(hashMap.valueOf(42), "Alice");
+  BOOST_CHECK_EQUAL(hashMap.valueOf(27), "Bob");
+  BOOST_CHECK_EQUAL(hashMap.valueOf(3), "Chuck");
+
+  hashMap[27] = "Dave";
+  BOOST_CHECK_EQUAL(hashMap.getSize(), 3u);
+  BOOST_CHECK(hashMap == (aisdi::HashMap<int, std::string>{ { 42, "Alice" }, { 27, "Dave" }, { 3, "Chuck" } }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenMoveOnlyValues_WhenConvertingBackAndForth_ThenValuesAreNeverCopied)
+{
+  aisdi::HashMap<int, std::unique_ptr<int>> hashMap;
+  std::vector<const int*> addresses;
+  for (int i = 0; i < 20; ++i)
+  {
+    hashMap[i] = std::unique_ptr<int>(new int(i));
+    addresses.push_back(hashMap.valueOf(i).get());
+  }
+
+  auto treeMap = aisdi::toTreeMap(std::move(hashMap));
+  auto roundTrip = aisdi::toHashMap(std::move(treeMap));
+
+  BOOST_CHECK_EQUAL(roundTrip.getSize(), 20u);
+  for (int i = 0; i < 20; ++i)
+  {
+    BOOST_REQUIRE(roundTrip.valueOf(i) != nullptr);
+    BOOST_CHECK_EQUAL(roundTrip.valueOf(i).get(), addresses[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenUnsortedEntries_WhenAssigningSorted_ThenMapIsUnchanged)
+{
+  aisdi::TreeMap<int, std::string> treeMap = { { 1, "one" } };
+  std::vector<std::pair<const int, std::string>> entries = { { 2, "two" }, { 2, "again" } };
+
+  BOOST_CHECK_THROW(treeMap.assignSorted(entries.begin(), entries.end()), std::invalid_argument);
+  BOOST_CHECK_EQUAL(treeMap.getSize(), 1u);
+  BOOST_CHECK_EQUAL(treeMap.valueOf(1), "one");
+  BOOST_CHECK_EQUAL(entries[0].second, "two");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
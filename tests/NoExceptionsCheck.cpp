@@ -0,0 +1,59 @@
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <cstdio>
+#include <string>
+
+/*
+ * Built with -fno-exceptions: the maps must compile without exception support and report errors
+ * through ReportError instead. Exits with the number of failed checks.
+ */
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+  if (!condition)
+  {
+    std::fprintf(stderr, "failed: %s\n", what);
+    ++failures;
+  }
+}
+
+template <typename Map>
+void checkMap(const char* name)
+{
+  std::fprintf(stderr, "%s\n", name);
+  Map map;
+  map[1] = "one";
+  map[2] = "two";
+
+  aisdi::lastMapError() = aisdi::MapError::None;
+  check(map.valueOf(1) == "one", "valueOf finds present key");
+  check(aisdi::lastMapError() == aisdi::MapError::None, "no error for present key");
+  check(map.valueOf(3).empty(), "valueOf of missing key gives default value");
+  check(aisdi::lastMapError() == aisdi::MapError::MissingKey, "missing key is reported");
+
+  map.remove(3);
+  check(map.getSize() == 2, "removing missing key changes nothing");
+  check(map.tryRemove(2), "tryRemove removes present key");
+  check(map.tryValueOf(2) == nullptr, "tryValueOf misses removed key");
+
+  aisdi::lastMapError() = aisdi::MapError::None;
+  auto it = map.end();
+  ++it;
+  check(it == map.end(), "incrementing end stays at end");
+  check(aisdi::lastMapError() == aisdi::MapError::IteratorOutOfRange, "iterator error is reported");
+}
+
+} // namespace
+
+int main()
+{
+  checkMap<aisdi::TreeMap<int, std::string, aisdi::ReportError>>("TreeMap");
+  checkMap<aisdi::HashMap<int, std::string, aisdi::ReportError>>("HashMap");
+  return failures;
+}
@@ -0,0 +1,184 @@
+#include <Reclamation.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+namespace
+{
+
+struct Node
+{
+  enum { ALIVE = 0x5eed };
+
+  explicit Node(int value_ = 0)
+    : value(value_), state(ALIVE)
+  {
+    ++liveNodes;
+  }
+
+  ~Node()
+  {
+    state = 0;
+    --liveNodes;
+  }
+
+  int value;
+  volatile int state;
+
+  static std::atomic<int> liveNodes;
+};
+
+std::atomic<int> Node::liveNodes(0);
+
+struct Fixture
+{
+  Fixture()
+  {
+    Node::liveNodes = 0;
+  }
+};
+
+// uniform "read a protected pointer" interface over both schemes
+struct EpochReader
+{
+  using Domain = aisdi::EpochDomain;
+
+  explicit EpochReader(Domain::Handle& handle_)
+    : handle(handle_), guard(handle_.pin())
+  {}
+
+  Node* read(const std::atomic<Node*>& source)
+  {
+    return source.load();
+  }
+
+  Domain::Handle& handle;
+  Domain::Guard guard;
+};
+
+struct HazardReader
+{
+  using Domain = aisdi::HazardPointerDomain;
+
+  explicit HazardReader(Domain::Handle& handle_)
+    : handle(handle_)
+  {}
+
+  ~HazardReader()
+  {
+    handle.clear(0);
+  }
+
+  Node* read(const std::atomic<Node*>& source)
+  {
+    return handle.protect(0, source);
+  }
+
+  Domain::Handle& handle;
+};
+
+} // namespace
+
+using Readers = boost::mpl::list<EpochReader, HazardReader>;
+
+BOOST_FIXTURE_TEST_SUITE(ReclamationTests, Fixture)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenProtectedPointer_WhenRetiring_ThenItIsNotFreed,
+                              Reader,
+                              Readers)
+{
+  typename Reader::Domain domain;
+  auto reading = domain.registerThread();
+  auto writing = domain.registerThread();
+  std::atomic<Node*> shared(new Node(1));
+
+  {
+    Reader reader(reading);
+    Node* node = reader.read(shared);
+    shared.store(new Node(2));
+    writing.retire(node);
+    for (int i = 0; i < 4; ++i)
+      writing.collect();
+
+    BOOST_CHECK_EQUAL(node->state, static_cast<int>(Node::ALIVE));
+    BOOST_CHECK_EQUAL(Node::liveNodes, 2);
+  }
+
+  for (int i = 0; i < 4; ++i)
+    writing.collect();
+  BOOST_CHECK_EQUAL(Node::liveNodes, 1);
+  BOOST_CHECK_EQUAL(writing.getRetiredCount(), 0u);
+  delete shared.load();
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenManyRetiredPointers_WhenNoReaderHoldsThem_ThenGarbageStaysBounded,
+                              Reader,
+                              Readers)
+{
+  typename Reader::Domain domain;
+  auto handle = domain.registerThread();
+  const std::size_t threshold = Reader::Domain::RETIRE_THRESHOLD;
+
+  for (int i = 0; i < 10000; ++i)
+  {
+    handle.retire(new Node(i));
+    BOOST_REQUIRE_LE(handle.getRetiredCount(), threshold);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenDomain_WhenDestroyed_ThenAllRetiredPointersAreFreed,
+                              Reader,
+                              Readers)
+{
+  {
+    typename Reader::Domain domain;
+    auto handle = domain.registerThread();
+    for (int i = 0; i < 10; ++i)
+      handle.retire(new Node(i));
+  }
+
+  BOOST_CHECK_EQUAL(Node::liveNodes, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenConcurrentReaders_WhenWriterReplacesAndRetiresNodes_ThenReadersNeverSeeFreedNode,
+                              Reader,
+                              Readers)
+{
+  typename Reader::Domain domain;
+  std::atomic<Node*> shared(new Node(0));
+  std::atomic<bool> done(false);
+  std::atomic<int> freedNodesSeen(0);
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t)
+  {
+    readers.emplace_back([&]() {
+      auto handle = domain.registerThread();
+      while (!done.load())
+      {
+        Reader reader(handle);
+        if (reader.read(shared)->state != Node::ALIVE)
+          ++freedNodesSeen;
+      }
+    });
+  }
+
+  {
+    auto handle = domain.registerThread();
+    for (int i = 1; i < 20000; ++i)
+      handle.retire(shared.exchange(new Node(i)));
+  }
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  BOOST_CHECK_EQUAL(freedNodesSeen, 0);
+  delete shared.load();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
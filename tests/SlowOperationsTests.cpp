@@ -0,0 +1,135 @@
+#include <SlowOperations.h>
+
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(SlowOperationsTests)
+
+BOOST_AUTO_TEST_CASE(GivenCycleClock_WhenTimePasses_ThenTicksGrow)
+{
+  const auto before = aisdi::CycleClock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  BOOST_CHECK_GT(aisdi::CycleClock::now(), before);
+  BOOST_CHECK_GT(aisdi::CycleClock::ticksPerNanosecond(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenLog_WhenRecordingMoreThanCapacity_ThenNewestAreKeptInOrder)
+{
+  aisdi::SlowOperationLog log(0, 3);
+
+  for (std::uint64_t i = 0; i < 10; ++i)
+    log.record(aisdi::MonitoredOperation::Find, i, i + 1, 100);
+
+  const auto records = log.dump();
+  BOOST_CHECK_EQUAL(log.getRecordCount(), 10u);
+  BOOST_CHECK_EQUAL(log.getDroppedCount(), 0u);
+  BOOST_REQUIRE_EQUAL(records.size(), 4u);
+  for (std::uint64_t i = 0; i < 4; ++i)
+  {
+    BOOST_CHECK_EQUAL(records[i].sequence, 6 + i);
+    BOOST_CHECK_EQUAL(records[i].keyHash, 6 + i);
+    BOOST_CHECK_EQUAL(records[i].probeLength, 7 + i);
+    BOOST_CHECK(records[i].operation == aisdi::MonitoredOperation::Find);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenZeroThreshold_WhenUsingMonitoredHashMap_ThenEveryOperationIsRecordedWithChainLength)
+{
+  aisdi::HashMap<int, std::string> map;
+  aisdi::SlowOperationLog log(0);
+  aisdi::MonitoredMap<aisdi::HashMap<int, std::string>> monitored(map, log);
+
+  monitored[1] = "one";
+  monitored.assign(12, "twelve");
+  BOOST_CHECK_EQUAL(monitored.valueOf(12), "twelve");
+  monitored.remove(1);
+  BOOST_CHECK_THROW(monitored.valueOf(1), std::out_of_range);
+
+  const auto records = log.dump();
+  BOOST_REQUIRE_EQUAL(records.size(), 5u);
+  BOOST_CHECK(records[0].operation == aisdi::MonitoredOperation::Access);
+  BOOST_CHECK_EQUAL(records[0].keyHash, std::hash<int>{}(1));
+  BOOST_CHECK_EQUAL(records[0].probeLength, 1u);
+  // 12 lands in the bucket of 1
+  BOOST_CHECK_EQUAL(records[1].probeLength, 2u);
+  BOOST_CHECK(records[2].operation == aisdi::MonitoredOperation::Find);
+  BOOST_CHECK(records[3].operation == aisdi::MonitoredOperation::Remove);
+  BOOST_CHECK(records[4].operation == aisdi::MonitoredOperation::Find);
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+
+  std::ostringstream out;
+  log.write(out);
+  BOOST_CHECK(out.str().find("#3 remove hash=" + std::to_string(std::hash<int>{}(1))) != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMonitoredTreeMap_WhenOperationIsSlow_ThenDepthIsRecorded)
+{
+  aisdi::TreeMap<int, int> map;
+  for (int i = 0; i < 1000; ++i)
+    map[i] = i;
+  aisdi::SlowOperationLog log(0);
+  aisdi::MonitoredMap<aisdi::TreeMap<int, int>> monitored(map, log);
+
+  BOOST_CHECK(monitored.find(999) != monitored.end());
+  monitored.remove(monitored.find(0));
+
+  const auto records = log.dump();
+  BOOST_REQUIRE_EQUAL(records.size(), 3u);
+  BOOST_CHECK_EQUAL(records[0].probeLength, map.depthOf(999));
+  BOOST_CHECK_GT(records[0].probeLength, 1u);
+  BOOST_CHECK_LE(records[0].probeLength, map.getHeight());
+  BOOST_CHECK(records[2].operation == aisdi::MonitoredOperation::Remove);
+  BOOST_CHECK_EQUAL(records[2].probeLength, map.depthOf(0));
+}
+
+BOOST_AUTO_TEST_CASE(GivenHighThreshold_WhenOperationsAreFast_ThenNothingIsRecorded)
+{
+  aisdi::TreeMap<int, int> map;
+  aisdi::SlowOperationLog log(1000000000);
+  aisdi::MonitoredMap<aisdi::TreeMap<int, int>> monitored(map, log);
+
+  monitored[1] = 1;
+  monitored.valueOf(1);
+
+  BOOST_CHECK_EQUAL(log.getRecordCount(), 0u);
+  BOOST_CHECK(log.dump().empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyWriters_WhenDumpingConcurrently_ThenEveryDumpedRecordIsConsistent)
+{
+  aisdi::SlowOperationLog log(0, 64);
+  const std::uint64_t threadCount = 4;
+  const std::uint64_t recordsPerThread = 20000;
+
+  std::vector<std::thread> writers;
+  for (std::uint64_t t = 0; t < threadCount; ++t)
+  {
+    writers.emplace_back([&log, t]() {
+      for (std::uint64_t i = 0; i < recordsPerThread; ++i)
+        log.record(aisdi::MonitoredOperation::Access, t * recordsPerThread + i, t * recordsPerThread + i, 1);
+    });
+  }
+  for (int i = 0; i < 100; ++i)
+  {
+    for (const auto& record : log.dump())
+      BOOST_REQUIRE_EQUAL(record.keyHash, record.probeLength);
+  }
+  for (auto& writer : writers)
+    writer.join();
+
+  BOOST_CHECK_EQUAL(log.getRecordCount(), threadCount * recordsPerThread);
+  BOOST_CHECK_LE(log.dump().size(), 64u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+#include <HashMap.h>
+#include <Snapshot.h>
+#include <TreeMap.h>
+
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+using TestedMaps = boost::mpl::list<aisdi::TreeMap<int, std::string>, aisdi::HashMap<int, std::string>>;
+
+namespace
+{
+
+template <typename Map>
+void checkEqual(const Map& actual, const std::map<int, std::string>& expected)
+{
+  BOOST_REQUIRE_EQUAL(actual.getSize(), expected.size());
+  for (const auto& entry : expected)
+    BOOST_REQUIRE_EQUAL(actual.valueOf(entry.first), entry.second);
+}
+
+template <typename Map>
+void fill(Map& map, std::map<int, std::string>& expected, int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    map[i * 3] = std::to_string(i);
+    expected[i * 3] = std::to_string(i);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SnapshotTests)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenReadingItsSnapshot_ThenMapsAreEqual, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 1000);
+
+  std::stringstream snapshot;
+  map.writeSnapshot(snapshot);
+  Map loaded;
+  loaded[-1] = "overwritten";
+  loaded.readSnapshot(snapshot);
+
+  checkEqual(loaded, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNoSnapshot_WhenWritingDelta_ThenExceptionIsThrown, Map, TestedMaps)
+{
+  Map map;
+  std::stringstream delta;
+  BOOST_CHECK_THROW(map.writeDelta(delta), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenChangesBetweenDeltas_WhenLoadingChain_ThenLastStateIsRestored, Map, TestedMaps)
+{
+  std::mt19937 generator(11);
+  std::uniform_int_distribution<int> keys(0, 3000);
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 500);
+
+  std::stringstream base;
+  map.writeSnapshot(base);
+  std::vector<std::stringstream> deltas(6);
+  for (std::size_t round = 0; round < deltas.size(); ++round)
+  {
+    for (int i = 0; i < 40; ++i)
+    {
+      const int key = keys(generator);
+      if (expected.count(key) > 0 && i % 3 == 0)
+      {
+        map.remove(key);
+        expected.erase(key);
+      }
+      else
+      {
+        map[key] = "round " + std::to_string(round);
+        expected[key] = "round " + std::to_string(round);
+      }
+    }
+    map.writeDelta(deltas[round]);
+  }
+
+  std::vector<std::istream*> chain;
+  for (auto& delta : deltas)
+    chain.push_back(&delta);
+  Map loaded;
+  aisdi::loadSnapshotChain(loaded, base, chain);
+
+  checkEqual(loaded, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenValuesChangedThroughIterators_WhenLoadingChain_ThenChangesAreRestored, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 300);
+  std::stringstream base;
+  map.writeSnapshot(base);
+
+  map.find(30)->second = "through find";
+  expected[30] = "through find";
+  map.valueOf(60) = "through valueOf";
+  expected[60] = "through valueOf";
+  std::stringstream delta;
+  map.writeDelta(delta);
+
+  Map loaded;
+  aisdi::loadSnapshotChain(loaded, base, {&delta});
+  checkEqual(loaded, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenAssignedMap_WhenLoadingChain_ThenOldEntriesAreGone, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 100);
+  std::stringstream base;
+  map.writeSnapshot(base);
+
+  map = Map{{1, "one"}, {2, "two"}};
+  std::stringstream delta;
+  map.writeDelta(delta);
+
+  Map loaded;
+  aisdi::loadSnapshotChain(loaded, base, {&delta});
+  checkEqual(loaded, {{1, "one"}, {2, "two"}});
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenCheckpointedSource_WhenMoveAssigning_ThenDeltaCarriesAllItsEntries, Map,
+                              TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> ignored;
+  fill(map, ignored, 10);
+  std::stringstream base;
+  map.writeSnapshot(base);
+
+  Map source;
+  std::map<int, std::string> expected;
+  fill(source, expected, 100);
+  std::stringstream sourceBase;
+  source.writeSnapshot(sourceBase);
+
+  map = std::move(source);
+  std::stringstream delta;
+  map.writeDelta(delta);
+
+  Map loaded;
+  aisdi::loadSnapshotChain(loaded, base, {&delta});
+  checkEqual(loaded, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenLoadedMap_WhenWritingFurtherDeltas_ThenChainContinues, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 100);
+  std::stringstream base;
+  map.writeSnapshot(base);
+
+  Map loaded;
+  loaded.readSnapshot(base);
+  loaded[1000] = "added after loading";
+  expected[1000] = "added after loading";
+  std::stringstream delta;
+  loaded.writeDelta(delta);
+
+  base.seekg(0);
+  Map restored;
+  aisdi::loadSnapshotChain(restored, base, {&delta});
+  checkEqual(restored, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenSkippedDelta_WhenLoadingChain_ThenExceptionIsThrown, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 10);
+  std::stringstream base;
+  map.writeSnapshot(base);
+  std::stringstream first;
+  std::stringstream second;
+  map[1] = "1";
+  map.writeDelta(first);
+  map[2] = "2";
+  map.writeDelta(second);
+
+  Map loaded;
+  BOOST_CHECK_THROW(aisdi::loadSnapshotChain(loaded, base, {&second}), std::runtime_error);
+  checkEqual(loaded, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenCorruptedInput_WhenReadingSnapshot_ThenMapIsUnchanged, Map, TestedMaps)
+{
+  Map map;
+  std::map<int, std::string> expected;
+  fill(map, expected, 10);
+  std::stringstream snapshot;
+  map.writeSnapshot(snapshot);
+
+  std::stringstream notSnapshot("definitely not a snapshot");
+  BOOST_CHECK_THROW(map.readSnapshot(notSnapshot), std::runtime_error);
+  std::stringstream truncated(snapshot.str().substr(0, snapshot.str().size() - 3));
+  BOOST_CHECK_THROW(map.readSnapshot(truncated), std::runtime_error);
+  checkEqual(map, expected);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFewChangesInLargeTree_WhenWritingDelta_ThenDeltaIsMuchSmallerThanSnapshot)
+{
+  std::mt19937 generator(5);
+  aisdi::TreeMap<int, int> map;
+  for (int i = 0; i < 20000; ++i)
+    map[static_cast<int>(generator() % 1000000)] = i;
+  std::stringstream snapshot;
+  map.writeSnapshot(snapshot);
+
+  for (int i = 0; i < 20; ++i)
+    map[static_cast<int>(generator() % 1000000)] = -i;
+  std::stringstream delta;
+  map.writeDelta(delta);
+
+  BOOST_CHECK_LT(10 * delta.str().size(), snapshot.str().size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,122 @@
+#include <SortedView.h>
+
+#include <HashMap.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+using KeyTypes = boost::mpl::list<int, std::uint64_t, std::int8_t, std::string>;
+
+template <typename K>
+K keyOf(std::mt19937& generator)
+{
+  return static_cast<K>(generator());
+}
+
+template <>
+std::string keyOf<std::string>(std::mt19937& generator)
+{
+  return std::to_string(static_cast<int>(generator()));
+}
+
+template <typename K>
+void thenViewMatchesSortedCopy(const aisdi::SortedView<std::pair<const K, int>>& view,
+                               const std::map<K, int>& expected)
+{
+  BOOST_REQUIRE_EQUAL(view.getSize(), expected.size());
+  auto it = view.begin();
+  for (const auto& entry : expected)
+  {
+    BOOST_REQUIRE(it->first == entry.first);
+    BOOST_REQUIRE_EQUAL(it->second, entry.second);
+    ++it;
+  }
+  BOOST_CHECK(it == view.end());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SortedViewTests)
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenGettingSortedView_ThenItIsEmpty)
+{
+  const aisdi::HashMap<int, int> map;
+  aisdi::ThreadPool pool(2);
+
+  BOOST_CHECK(map.sortedView().isEmpty());
+  BOOST_CHECK(map.sortedView(pool).begin() == map.sortedView(pool).end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenGettingSortedView_ThenEntriesAreInKeyOrder, K, KeyTypes)
+{
+  aisdi::HashMap<K, int> map;
+  std::map<K, int> expected;
+  std::mt19937 generator(42);
+  for (int i = 0; i < 1000; ++i)
+  {
+    const auto key = keyOf<K>(generator);
+    map[key] = i;
+    expected[key] = i;
+  }
+
+  thenViewMatchesSortedCopy(map.sortedView(), expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenSortingWithPool_ThenResultEqualsSequentialOne, K, KeyTypes)
+{
+  aisdi::HashMap<K, int> map;
+  std::mt19937 generator(7);
+  for (int i = 0; i < 1000; ++i)
+    map[keyOf<K>(generator)] = i;
+  aisdi::ThreadPool pool(3);
+
+  const auto view = map.sortedView(pool);
+  const auto sequential = map.sortedView();
+
+  BOOST_CHECK(std::equal(view.begin(), view.end(), sequential.begin()));
+}
+
+// HashMap grows slowly past its fixed buckets, so the pool's split is checked on plain entries
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenManyEntries_WhenSortingWithPool_ThenTheyAreInKeyOrder, K, KeyTypes)
+{
+  using Entry = std::pair<const K, int>;
+  std::map<K, int> expected;
+  std::mt19937 generator(7);
+  for (int i = 0; i < static_cast<int>(4 * aisdi::EntrySort<Entry>::MIN_CHUNK); ++i)
+    expected[keyOf<K>(generator)] = i;
+  const std::vector<Entry> storage(expected.begin(), expected.end());
+  std::vector<const Entry*> entries;
+  for (const auto& entry : storage)
+    entries.push_back(&entry);
+  std::shuffle(entries.begin(), entries.end(), generator);
+  aisdi::ThreadPool pool(3);
+
+  aisdi::EntrySort<Entry>::sort(entries, &pool);
+
+  thenViewMatchesSortedCopy(aisdi::SortedView<Entry>(entries), expected);
+}
+
+BOOST_AUTO_TEST_CASE(GivenSortedView_WhenReadingEntries_ThenTheyPointIntoMap)
+{
+  aisdi::HashMap<int, int> map = { { 3, 30 }, { -1, -10 }, { 2, 20 } };
+
+  const auto view = map.sortedView();
+
+  BOOST_CHECK_EQUAL(view[0].first, -1);
+  BOOST_CHECK_EQUAL(view[2].second, 30);
+  BOOST_CHECK_EQUAL(&view[1], &*map.find(2));
+  auto last = view.end();
+  BOOST_CHECK_EQUAL((--last)->first, 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
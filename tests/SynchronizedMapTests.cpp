@@ -0,0 +1,86 @@
+#include <SynchronizedMap.h>
+
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+using Maps = boost::mpl::list<aisdi::SynchronizedMap<aisdi::TreeMap<int, std::string>>,
+                              aisdi::SynchronizedMap<aisdi::HashMap<int, std::string>, aisdi::SharedMutex>,
+                              aisdi::StripedMap<aisdi::TreeMap<int, std::string>>,
+                              aisdi::StripedMap<aisdi::HashMap<int, std::string>, 4, aisdi::SharedMutex>>;
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SynchronizedMapTests)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEmptyMap_WhenAddingItems_ThenTheyAreInMap, Map, Maps)
+{
+  Map map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.insertOrAssign(27, "Bob"));
+  BOOST_CHECK(!map.insertOrAssign(27, "Chuck"));
+  BOOST_CHECK(map.insertOrAssign(42, "Alice"));
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+  BOOST_CHECK_EQUAL(map.valueOf(27), "Chuck");
+  BOOST_CHECK(map.contains(42));
+  BOOST_CHECK(!map.contains(1));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNotEmptyMap_WhenRemovingItems_ThenMissingKeysThrow, Map, Maps)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  map.remove(27);
+
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK(!map.contains(27));
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenManyThreads_WhenWritingAndReadingConcurrently_ThenEveryThreadSeesItsItems, Map,
+                              Maps)
+{
+  Map map;
+  const int threadCount = 4;
+  const int itemsPerThread = 500;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&map, t]() {
+      for (int i = t; i < threadCount * itemsPerThread; i += threadCount)
+      {
+        map.insertOrAssign(i, std::to_string(i));
+        if (!map.contains(i))
+          throw std::logic_error("Item written by this thread is missing");
+      }
+      for (int i = t; i < threadCount * itemsPerThread; i += 2 * threadCount)
+        map.remove(i);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  BOOST_CHECK_EQUAL(map.getSize(), static_cast<std::size_t>(threadCount * itemsPerThread / 2));
+  for (int i = 0; i < threadCount * itemsPerThread; ++i)
+  {
+    const bool removed = (i % (2 * threadCount)) < threadCount;
+    BOOST_REQUIRE_EQUAL(map.contains(i), !removed);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+#include <Timeline.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+std::string written()
+{
+  std::ostringstream out;
+  aisdi::Timeline::write(out);
+  return out.str();
+}
+
+std::size_t occurrences(const std::string& text, const std::string& part)
+{
+  std::size_t count = 0;
+  for (auto at = text.find(part); at != std::string::npos; at = text.find(part, at + 1))
+    ++count;
+  return count;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TimelineTests)
+
+BOOST_AUTO_TEST_CASE(GivenStoppedTimeline_WhenSpanEnds_ThenNothingIsRecorded)
+{
+  aisdi::Timeline::start();
+  aisdi::Timeline::stop();
+
+  {
+    aisdi::TimelineSpan span("test", "unrecorded");
+  }
+
+  BOOST_CHECK(!aisdi::Timeline::isRecording());
+  BOOST_CHECK_EQUAL(written().find("unrecorded"), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRecordingTimeline_WhenSpansEndOnSeveralThreads_ThenEveryOneIsWritten)
+{
+  aisdi::Timeline::start();
+  {
+    aisdi::TimelineSpan span("test", "main span");
+  }
+  std::vector<std::thread> workers;
+  for (int i = 0; i < 3; ++i)
+    workers.emplace_back([i]() {
+      aisdi::TimelineSpan span("test", "worker " + std::to_string(i));
+    });
+  for (auto& worker : workers)
+    worker.join();
+  aisdi::Timeline::stop();
+
+  const auto json = written();
+  BOOST_CHECK_EQUAL(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+  BOOST_CHECK_EQUAL(occurrences(json, "\"ph\":\"X\""), 4u);
+  BOOST_CHECK_EQUAL(occurrences(json, "\"ph\":\"M\""), 4u);
+  BOOST_CHECK_NE(json.find("\"cat\":\"test\",\"name\":\"main span\""), std::string::npos);
+  for (int i = 0; i < 3; ++i)
+    BOOST_CHECK_NE(json.find("\"name\":\"worker " + std::to_string(i) + "\""), std::string::npos);
+  BOOST_CHECK_NE(json.find("\"droppedEvents\":\"0\""), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRecordedSpans_WhenStartingAgain_ThenTheyAreDiscarded)
+{
+  aisdi::Timeline::start();
+  {
+    aisdi::TimelineSpan span("test", "old");
+  }
+  aisdi::Timeline::start();
+  {
+    aisdi::TimelineSpan span("test", "new");
+  }
+  aisdi::Timeline::stop();
+
+  const auto json = written();
+  BOOST_CHECK_EQUAL(json.find("\"name\":\"old\""), std::string::npos);
+  BOOST_CHECK_NE(json.find("\"name\":\"new\""), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(GivenNameWithQuotesAndControlCharacters_WhenWriting_ThenItIsEscaped)
+{
+  aisdi::Timeline::start();
+  {
+    aisdi::TimelineSpan span("test", std::string("a \"b\" \\c\n"));
+  }
+  aisdi::Timeline::stop();
+
+  BOOST_CHECK_NE(written().find("\"name\":\"a \\\"b\\\" \\\\c\\u000a\""), std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+#include <Trace.h>
+
+#include <HashMap.h>
+#include <TreeMap.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+template <typename K>
+std::vector<aisdi::TraceRecord<K>> readAll(const std::string& trace)
+{
+  std::istringstream in(trace);
+  aisdi::TraceReader<K> reader(in);
+  std::vector<aisdi::TraceRecord<K>> records;
+  aisdi::TraceRecord<K> record;
+  while (reader.next(record))
+    records.push_back(record);
+  return records;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TraceTests)
+
+BOOST_AUTO_TEST_CASE(GivenWrittenRecords_WhenReadingTrace_ThenSameRecordsAreReturned)
+{
+  std::ostringstream out;
+  aisdi::TraceWriter<std::string> writer(out);
+  writer.record(aisdi::TraceOperation::Assign, "alpha", 300);
+  writer.record(aisdi::TraceOperation::Find, "beta");
+  writer.record(aisdi::TraceOperation::Remove, "");
+  writer.record(aisdi::TraceOperation::Access, "alpha", 5);
+
+  const auto records = readAll<std::string>(out.str());
+
+  BOOST_REQUIRE_EQUAL(records.size(), 4u);
+  BOOST_CHECK(records[0].operation == aisdi::TraceOperation::Assign);
+  BOOST_CHECK_EQUAL(records[0].key, "alpha");
+  BOOST_CHECK_EQUAL(records[0].valueSize, 300u);
+  BOOST_CHECK(records[1].operation == aisdi::TraceOperation::Find);
+  BOOST_CHECK_EQUAL(records[1].key, "beta");
+  BOOST_CHECK_EQUAL(records[1].valueSize, 0u);
+  BOOST_CHECK(records[2].operation == aisdi::TraceOperation::Remove);
+  BOOST_CHECK_EQUAL(records[2].key, "");
+  BOOST_CHECK_EQUAL(records[3].valueSize, 5u);
+  for (std::size_t i = 1; i < records.size(); ++i)
+    BOOST_CHECK_LE(records[i - 1].timestamp, records[i].timestamp);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRecordingMap_WhenUsingIt_ThenOperationsAreForwardedAndRecorded)
+{
+  std::ostringstream out;
+  aisdi::TraceWriter<int> writer(out);
+  aisdi::TreeMap<int, std::string> map;
+  aisdi::RecordingMap<aisdi::TreeMap<int, std::string>> recording(map, writer);
+
+  recording.assign(1, "one");
+  recording[2] = "two";
+  BOOST_CHECK_EQUAL(recording.valueOf(1), "one");
+  BOOST_CHECK(recording.find(3) == recording.end());
+  recording.remove(1);
+
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK_EQUAL(map.valueOf(2), "two");
+  BOOST_CHECK_EQUAL(writer.getRecordCount(), 5u);
+
+  const auto records = readAll<int>(out.str());
+  BOOST_REQUIRE_EQUAL(records.size(), 5u);
+  BOOST_CHECK(records[0].operation == aisdi::TraceOperation::Assign);
+  BOOST_CHECK_EQUAL(records[0].valueSize, 3u);
+  BOOST_CHECK(records[1].operation == aisdi::TraceOperation::Access);
+  BOOST_CHECK_EQUAL(records[1].key, 2);
+  BOOST_CHECK(records[2].operation == aisdi::TraceOperation::Find);
+  BOOST_CHECK(records[3].operation == aisdi::TraceOperation::Find);
+  BOOST_CHECK_EQUAL(records[3].key, 3);
+  BOOST_CHECK(records[4].operation == aisdi::TraceOperation::Remove);
+  BOOST_CHECK_EQUAL(records[4].key, 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTraceOfTreeMap_WhenReplayingOnHashMap_ThenSameEntriesRemain)
+{
+  std::ostringstream out;
+  aisdi::TraceWriter<int> writer(out);
+  aisdi::TreeMap<int, std::string> map;
+  aisdi::RecordingMap<aisdi::TreeMap<int, std::string>> recording(map, writer);
+  for (int i = 0; i < 500; ++i)
+  {
+    const auto key = (i * 37) % 101;
+    if (i % 7 == 0 && recording.find(key) != recording.end())
+      recording.remove(key);
+    else
+      recording.assign(key, std::string(static_cast<std::size_t>(i % 13), 'x'));
+  }
+
+  std::istringstream in(out.str());
+  aisdi::TraceReader<int> reader(in);
+  aisdi::HashMap<int, std::string> replayed;
+  auto times = aisdi::replayTrace(replayed, reader);
+
+  BOOST_CHECK_EQUAL(replayed.getSize(), map.getSize());
+  for (const auto& entry : map)
+    BOOST_CHECK_EQUAL(replayed.valueOf(entry.first).size(), entry.second.size());
+  std::size_t replayedOperations = 0;
+  for (const auto& nanoseconds : times.nanoseconds)
+    replayedOperations += nanoseconds.size();
+  BOOST_CHECK_EQUAL(replayedOperations, writer.getRecordCount());
+  BOOST_CHECK(times.of(aisdi::TraceOperation::Access).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenTraceWithOtherKeyType_WhenOpeningReader_ThenExceptionIsThrown)
+{
+  std::ostringstream out;
+  aisdi::TraceWriter<std::string> writer(out);
+  std::istringstream in(out.str());
+
+  BOOST_CHECK_THROW(aisdi::TraceReader<int> reader(in), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTruncatedTrace_WhenReading_ThenExceptionIsThrown)
+{
+  std::ostringstream out;
+  aisdi::TraceWriter<std::string> writer(out);
+  writer.record(aisdi::TraceOperation::Assign, "some longer key", 10);
+  const auto trace = out.str();
+
+  std::istringstream in(trace.substr(0, trace.size() - 4));
+  aisdi::TraceReader<std::string> reader(in);
+  aisdi::TraceRecord<std::string> record;
+
+  BOOST_CHECK_THROW(reader.next(record), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(GivenSomethingElse_WhenReadingTraceHeader_ThenExceptionIsThrown)
+{
+  std::istringstream in("AISDISNP and more");
+
+  BOOST_CHECK_THROW(aisdi::TraceHeader::read(in), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,8 +1,15 @@
 #include <TreeMap.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <iterator>
 #include <string>
 #include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -122,6 +129,22 @@ struct Fixture
   }
 };
 
+// copying a negative value throws, as a failed allocation would
+struct ThrowingCopy
+{
+  int value;
+
+  ThrowingCopy(int value_ = 0) : value(value_) {}
+
+  ThrowingCopy(const ThrowingCopy& other) : value(other.value)
+  {
+    if (value < 0)
+      throw std::runtime_error("copy failed");
+  }
+
+  ThrowingCopy& operator=(const ThrowingCopy&) = default;
+};
+
 } // namespace
 
 template <typename K>
@@ -786,6 +809,282 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMapsWithDifferentKeys_WhenComparingThem_Th
   BOOST_CHECK(map != other);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenNodeWithTwoChildren_WhenRemovingIt_ThenOtherItemsRemain,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 50, "Root" }, { 30, "Left" }, { 70, "Right" }, { 60, "RightLeft" }, { 65, "Inner" } };
+
+  map.remove(50);
+
+  thenMapContainsItems(map, { { 30, "Left" }, { 70, "Right" }, { 60, "RightLeft" }, { 65, "Inner" } });
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenPickingRandomEntry_ThenEndIsReturned)
+{
+  const Map<int> map;
+  std::mt19937 generator(42);
+
+  BOOST_CHECK(map.randomEntry(generator) == end(map));
+  BOOST_CHECK(map.sample(3, generator).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenPickingRandomEntries_ThenEachEntryIsEquallyLikely)
+{
+  Map<int> map;
+  for (int i = 0; i < 20; ++i)
+    map[i * 7] = std::to_string(i);
+  std::mt19937 generator(42);
+  std::map<int, std::size_t> hits;
+
+  const std::size_t draws = 200000;
+  for (std::size_t i = 0; i < draws; ++i)
+    ++hits[map.randomEntry(generator)->first];
+
+  BOOST_REQUIRE_EQUAL(hits.size(), map.getSize());
+  for (const auto& hit : hits)
+  {
+    BOOST_CHECK_MESSAGE(hit.second > draws / 20 * 9 / 10 && hit.second < draws / 20 * 11 / 10,
+                        "Key " << hit.first << " drawn " << hit.second << " times");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenSampling_ThenDistinctEntriesAreEquallyLikely)
+{
+  Map<int> map;
+  for (int i = 0; i < 10; ++i)
+    map[i] = std::to_string(i);
+  std::mt19937 generator(7);
+  std::map<int, std::size_t> hits;
+
+  const std::size_t rounds = 50000;
+  for (std::size_t i = 0; i < rounds; ++i)
+  {
+    const auto picked = map.sample(3, generator);
+    BOOST_REQUIRE_EQUAL(picked.size(), 3u);
+    std::set<int> keys;
+    for (const auto& it : picked)
+      keys.insert(it->first);
+    BOOST_REQUIRE_EQUAL(keys.size(), 3u);
+    for (auto key : keys)
+      ++hits[key];
+  }
+
+  for (const auto& hit : hits)
+  {
+    BOOST_CHECK_MESSAGE(hit.second > rounds * 3 / 10 * 9 / 10 && hit.second < rounds * 3 / 10 * 11 / 10,
+                        "Key " << hit.first << " sampled " << hit.second << " times");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenSamplingMoreThanItsSize_ThenAllEntriesAreReturned)
+{
+  const Map<int> map = { { 1, "Alice" }, { 2, "Bob" }, { 3, "Chuck" } };
+  std::mt19937 generator(1);
+
+  const auto picked = map.sample(10, generator);
+
+  std::set<int> keys;
+  for (const auto& it : picked)
+    keys.insert(it->first);
+  BOOST_CHECK(keys == std::set<int>({ 1, 2, 3 }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenNonEmptyMap_WhenCloningInParallel_ThenCloneEqualsSequentialCopy)
+{
+  Map<int> map;
+  std::mt19937 generator(3);
+  for (int i = 0; i < 5000; ++i)
+    map[static_cast<int>(generator() % 100000)] = std::to_string(i);
+  aisdi::ThreadPool pool(4);
+
+  const Map<int> clone = map.clone(pool);
+  const Map<int> copy{map};
+
+  BOOST_CHECK_EQUAL(clone.getSize(), map.getSize());
+  BOOST_CHECK(std::equal(begin(clone), end(clone), begin(copy)));
+  BOOST_CHECK(clone == map);
+}
+
+BOOST_AUTO_TEST_CASE(GivenValueFailingToCopy_WhenCloningInParallel_ThenExceptionIsThrownOnceWorkersFinished)
+{
+  aisdi::TreeMap<int, ThrowingCopy> map;
+  for (int i = 0; i < 5000; ++i)
+    map[i] = ThrowingCopy(i);
+  map[0] = ThrowingCopy(-1);
+  aisdi::ThreadPool pool(4);
+
+  BOOST_CHECK_THROW(map.clone(pool), std::runtime_error);
+  BOOST_CHECK_EQUAL(map.getSize(), 5000u);
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenCloningInParallel_ThenCloneIsEmpty)
+{
+  const Map<int> map;
+  aisdi::ThreadPool pool(2);
+
+  BOOST_CHECK(map.clone(pool).isEmpty());
+}
+
+// keys[first, last) are the subtree of the one key at depth, as a subtree is a contiguous range
+// of sorted keys under its shallowest node; returns its height, found without the balance bits
+std::size_t thenSubtreeBalanceIsStored(const Map<int>& map, const std::vector<int>& keys,
+                                       const std::vector<std::size_t>& depths,
+                                       std::size_t first, std::size_t last, std::size_t depth)
+{
+  if (first == last)
+    return 0;
+
+  std::size_t root = first;
+  while (root < last && depths[root] != depth)
+    ++root;
+  BOOST_REQUIRE_MESSAGE(root < last, "No subtree root at depth " << depth);
+  const auto left = thenSubtreeBalanceIsStored(map, keys, depths, first, root, depth + 1);
+  const auto right = thenSubtreeBalanceIsStored(map, keys, depths, root + 1, last, depth + 1);
+  BOOST_CHECK_MESSAGE(map.balanceOf(keys[root]) == static_cast<int>(right) - static_cast<int>(left),
+                      "Wrong balance stored for key: " << keys[root]
+                      << " (expected: " << static_cast<int>(right) - static_cast<int>(left)
+                      << " got: " << map.balanceOf(keys[root]) << ")");
+  BOOST_CHECK_LE(std::max(left, right) - std::min(left, right), 1u);
+  return std::max(left, right) + 1;
+}
+
+// checks every node's stored balance against its subtrees' real heights and returns the tree's
+std::size_t thenEveryBalanceIsStored(const Map<int>& map)
+{
+  std::vector<int> keys;
+  std::vector<std::size_t> depths;
+  for (const auto& entry : map)
+  {
+    keys.push_back(entry.first);
+    depths.push_back(map.depthOf(entry.first));
+  }
+  const auto height = thenSubtreeBalanceIsStored(map, keys, depths, 0, keys.size(), 1);
+  BOOST_CHECK_EQUAL(map.getHeight(), height);
+  return height;
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenAddingSortedKeys_ThenHeightStaysLogarithmic)
+{
+  Map<int> map;
+  for (int i = 0; i < 100000; ++i)
+    map[i] = "";
+
+  // an AVL tree of n nodes is at most 1.44 log2(n + 2) high
+  BOOST_CHECK_LE(thenEveryBalanceIsStored(map), 24u);
+  BOOST_CHECK_EQUAL(map.getSize(), 100000u);
+  BOOST_CHECK_EQUAL(begin(map)->first, 0);
+  BOOST_CHECK_EQUAL((--end(map))->first, 99999);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenAddingAndRemovingRandomKeys_ThenItMatchesStdMap)
+{
+  Map<int> map;
+  std::map<int, std::string> expected;
+  std::mt19937 generator(5);
+  for (int i = 0; i < 20000; ++i)
+  {
+    const auto key = static_cast<int>(generator() % 2000);
+    if (generator() % 3 == 0 && expected.count(key) != 0)
+    {
+      map.remove(key);
+      expected.erase(key);
+    }
+    else
+    {
+      map[key] = std::to_string(i);
+      expected[key] = std::to_string(i);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+  BOOST_CHECK(std::equal(begin(expected), end(expected), begin(map)));
+  BOOST_CHECK_LE(thenEveryBalanceIsStored(map), static_cast<std::size_t>(1.44 * std::log2(expected.size() + 2)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenSortedMap_WhenRemovingEveryOtherKey_ThenItStaysBalanced)
+{
+  Map<int> map;
+  for (int i = 0; i < 4096; ++i)
+    map[i] = "";
+
+  for (int i = 0; i < 4096; i += 2)
+    map.remove(i);
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2048u);
+  BOOST_CHECK_LE(thenEveryBalanceIsStored(map), 16u);
+  int previous = -1;
+  for (const auto& entry : map)
+  {
+    BOOST_CHECK_EQUAL(entry.first, previous + 2);
+    previous = entry.first;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenSortedKeys_WhenFindingSorted_ThenEachKeyGetsItsEntry)
+{
+  Map<int> map;
+  for (int i = 0; i < 1000; ++i)
+    map[i * 3] = std::to_string(i);
+  std::vector<int> keys;
+  for (int i = -5; i < 3010; i += 2)
+    keys.push_back(i);
+
+  std::vector<Map<int>::const_iterator> found;
+  map.findSorted(keys.begin(), keys.end(), std::back_inserter(found));
+
+  BOOST_REQUIRE_EQUAL(found.size(), keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    BOOST_CHECK(found[i] == map.find(keys[i]));
+}
+
+BOOST_AUTO_TEST_CASE(GivenUnsortedKeys_WhenFindingSorted_ThenResultsFollowInputOrder)
+{
+  const Map<int> map = { { 1, "Alice" }, { 2, "Bob" }, { 3, "Chuck" }, { 5, "Eve" } };
+  const std::vector<int> keys = { 5, 4, 1, 5, 0, 3 };
+
+  std::vector<Map<int>::const_iterator> found;
+  map.findSorted(keys.begin(), keys.end(), std::back_inserter(found));
+
+  BOOST_REQUIRE_EQUAL(found.size(), keys.size());
+  BOOST_CHECK_EQUAL(found[0]->second, "Eve");
+  BOOST_CHECK(found[1] == map.end());
+  BOOST_CHECK_EQUAL(found[2]->second, "Alice");
+  BOOST_CHECK_EQUAL(found[3]->second, "Eve");
+  BOOST_CHECK(found[4] == map.end());
+  BOOST_CHECK_EQUAL(found[5]->second, "Chuck");
+}
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenFindingSorted_ThenAllKeysAreMissing)
+{
+  const Map<int> map;
+  const std::vector<int> keys = { 1, 2 };
+
+  std::vector<Map<int>::const_iterator> found;
+  map.findSorted(keys.begin(), keys.end(), std::back_inserter(found));
+
+  BOOST_REQUIRE_EQUAL(found.size(), 2u);
+  BOOST_CHECK(found[0] == map.end());
+  BOOST_CHECK(found[1] == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenPresizedStorage_WhenFindingSorted_ThenResultsAreAssignedInPlace)
+{
+  Map<int> map;
+  for (int i = 0; i < 1000; i += 10)
+    map[i] = std::to_string(i);
+  std::vector<int> keys;
+  for (int i = 0; i < 1000; ++i)
+    keys.push_back(i);
+
+  std::vector<Map<int>::const_iterator> found(keys.size(), map.end());
+  const auto last = map.findSorted(keys.begin(), keys.end(), found.begin());
+
+  BOOST_CHECK(last == found.end());
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    BOOST_CHECK(found[i] == map.find(keys[i]));
+}
+
 // ConstIterator is tested via Iterator methods.
 // If Iterator methods are to be changed, then new ConstIterator tests are required.
 